@@ -0,0 +1,193 @@
+
+#pragma once
+
+/**
+ * Header file
+ */
+#include <algorithm>
+#include <queue>
+#include <vector>
+#include <limits.h>
+#include <stdint.h>
+
+#include "engine.h"
+#include "random.h"
+
+#define BSLD_THRESHOLD 10		/* Shortest runtime in the bounded slowdown */
+
+/**
+ * CProfile class
+ *
+ * Availability profile of an N CPU machine, the number of free CPUs over time
+ * as a skyline: a breakpoint at each time the number changes, the value holds
+ * up to the next breakpoint, and the last one holds forever.
+ * Breakpoints are kept in a treap by time, each subtree knows its lowest and
+ * highest value, and values of a time range change with a lazy add.
+ * Finding the earliest time a job fits jumps from one blocking breakpoint
+ * to the next free enough one, each jump is O(log breakpoints).
+ */
+class CProfile
+{
+	/**
+	 * CNode structure
+	 *
+	 * One breakpoint, node 0 is the empty tree
+	 */
+	struct CNode {
+		unsigned long long nTime;	/* Time the value starts */
+		int nFree;			/* Free CPUs from this time to the next breakpoint */
+		int nMin;			/* Lowest value in the subtree */
+		int nMax;			/* Highest value in the subtree */
+		int nAdd;			/* Pending add for the children */
+		uint32_t nPriority;		/* Heap order of the treap */
+		unsigned int nLeft;		/* Earlier breakpoints */
+		unsigned int nRight;		/* Later breakpoints */
+	};
+
+public:
+	/* Constructor/Destructor */
+	CProfile(unsigned int nCpus);
+	~CProfile() {};
+
+	int Free(unsigned long long nTime);	/* Free CPUs at this time */
+	bool Fits(unsigned long long nTime, unsigned long long nLength, unsigned int nCpus);	/* Can a job start at this time? */
+	unsigned long long Fit(unsigned long long nTime, unsigned long long nLength, unsigned int nCpus);	/* Earliest start from this time */
+	void Add(unsigned long long nStart, unsigned long long nEnd, int nCpus);	/* More (or less) free CPUs over [start, end) */
+	void Trim(unsigned long long nTime);	/* Forget the profile before this time */
+
+private:
+	unsigned int Create(unsigned long long nTime, int nFree);	/* New breakpoint */
+	void Release(unsigned int nNode);	/* Free a subtree */
+	void Apply(unsigned int nNode, int nAdd);	/* Add to a whole subtree */
+	void Push(unsigned int nNode);		/* Pass the pending add to the children */
+	void Pull(unsigned int nNode);		/* Lowest and highest value from the children */
+	void Split(unsigned int nNode, unsigned long long nTime, unsigned int& nLeft, unsigned int& nRight);	/* Before this time, and from it */
+	unsigned int Merge(unsigned int nLeft, unsigned int nRight);	/* Join two trees, left is earlier */
+	void Ensure(unsigned long long nTime);	/* Breakpoint at this time */
+	unsigned int Segment(unsigned long long nTime);	/* Breakpoint whose value holds at this time */
+	unsigned int Below(unsigned int nNode, unsigned long long nFrom, int nCpus);	/* First from this time with fewer CPUs free */
+	unsigned int AtLeast(unsigned int nNode, unsigned long long nAfter, int nCpus);	/* First after this time with enough CPUs free */
+
+private:
+	std::vector<CNode> m_cNodes;		/* Breakpoints, by index */
+	std::vector<unsigned int> m_cSpare;	/* Released breakpoints */
+	unsigned int m_nRoot;			/* Root of the treap */
+	CRandom m_cRandom;			/* Treap priorities */
+};
+
+/**
+ * CWaitIndex class
+ *
+ * Queued jobs by arrival rank, in a segment tree of the CPUs they need
+ * Finds the first queued job from a rank which needs at most some CPUs,
+ * so a backfill pass only looks at jobs which could start
+ */
+class CWaitIndex
+{
+public:
+	/* Constructor/Destructor */
+	CWaitIndex(size_t nSize);
+	~CWaitIndex() {};
+
+	void Set(size_t nRank, unsigned int nCpus);	/* Job of this rank is queued, needing these CPUs */
+	void Clear(size_t nRank);		/* Job of this rank left the queue */
+	size_t First(size_t nFrom, unsigned int nCpus) const;	/* First queued rank from here needing at most nCpus */
+	/**
+	 * Queued:
+	 * nRank: Arrival rank of a job
+	 * Is this job waiting?
+	 */
+	inline bool Queued(size_t nRank) const
+	{
+		return m_cTree[m_nLeaves + nRank] != UINT_MAX;
+	}
+
+private:
+	size_t Find(size_t nNode, size_t nLow, size_t nHigh, size_t nFrom, unsigned int nCpus) const;	/* First in this range */
+
+private:
+	std::vector<unsigned int> m_cTree;	/* Fewest CPUs needed in each range, UINT_MAX if none queued */
+	size_t m_nLeaves;			/* Leaves of the tree, a power of 2 */
+};
+
+/**
+ * CBackfill class
+ *
+ * Batch scheduler of gang jobs on an N CPU machine: each job needs its CPUs
+ * at once and holds them until it terminates, without preemption.
+ * Jobs start in arrival order (FCFS), and later jobs backfill idle CPUs:
+ * EASY reserves CPUs for the first queued job only, a later job may start
+ * if it doesn't delay it. Conservative gives every job a reservation when it
+ * arrives, and a later job may only use CPUs no earlier reservation needs.
+ * Plans use the user estimate, a job running past it is killed at the estimate.
+ * When a job terminates early, conservative moves each reservation as early as
+ * it can go, in arrival order.
+ */
+class CBackfill
+{
+	typedef std::pair<unsigned long long, size_t> CEvent;	/* Time, job index */
+	typedef std::priority_queue<CEvent, std::vector<CEvent>, std::greater<CEvent> > CEventHeap;
+
+public:
+	/* Constructor/Destructor */
+	CBackfill(std::vector<CJob>& cJobs, unsigned int nCpus, bool bConservative, CEventLog& cLog);
+	~CBackfill() {};
+
+	/**
+	 * GetTime:
+	 * Returns current simulated time
+	 */
+	inline unsigned long long GetTime() const
+	{
+		return m_nTime;
+	}
+	/**
+	 * GetDone:
+	 * Returns has each job terminated? All of them, unless a signal stopped the run
+	 */
+	inline const std::vector<bool>& GetDone() const
+	{
+		return m_cDone;
+	}
+
+	void Run();				/* Run until all jobs are terminated, or a signal stops it */
+	void Report() const;			/* Utilization, wait and bounded slowdown */
+
+private:
+	/**
+	 * Runtime:
+	 * nIndex: Job index
+	 * Returns time the job holds its CPUs, killed at the estimate
+	 */
+	inline unsigned long long Runtime(size_t nIndex) const
+	{
+		return std::min(m_cJobs[nIndex].GetBurst(), m_cJobs[nIndex].GetEstimate());
+	}
+	unsigned long long NextEvent();		/* Time of the next arrival, termination or reservation */
+	void Arrive(size_t nIndex);		/* Job is queued */
+	void Start(size_t nIndex);		/* Job takes its CPUs */
+	void Finish(size_t nIndex);		/* Job gives its CPUs back */
+	void Reserve(size_t nIndex);		/* Earliest reservation of a queued job (conservative) */
+	void Compress();			/* Move every reservation as early as it can go (conservative) */
+	void Backfill();			/* Start the head job if it fits, then the jobs which don't delay it (EASY) */
+
+private:
+	std::vector<CJob>& m_cJobs;		/* List of all jobs */
+	unsigned int m_nCpus;			/* CPUs of the machine */
+	bool m_bConservative;			/* Reservation for every job, instead of the first one */
+	CEventLog& m_cLog;			/* Job state transitions */
+	CProfile m_cProfile;			/* Free CPUs over time, running jobs and reservations */
+	CWaitIndex m_cWaiting;			/* Queued jobs by arrival rank */
+	std::vector<size_t> m_cOrder;		/* Job indexes by arrival */
+	std::vector<size_t> m_cRank;		/* Arrival rank of each job */
+	std::vector<unsigned long long> m_cStart;	/* Start time, or reservation while queued */
+	std::vector<std::vector<unsigned int> > m_cHeld;	/* CPUs of each running job */
+	std::vector<unsigned int> m_cIdle;	/* Idle CPUs, as a stack */
+	CEventHeap m_cRunning;			/* Running jobs by termination */
+	CEventHeap m_cReserved;			/* Queued jobs by reservation, stale entries are skipped (conservative) */
+	std::vector<bool> m_cDone;		/* Has the job terminated? */
+	size_t m_nDone;				/* Terminated jobs */
+	size_t m_nNext;				/* Next job to arrive, by rank */
+	unsigned long long m_nTime;		/* Current simulated time */
+	bool m_bEarly;				/* Did a job terminate before its estimate? */
+};
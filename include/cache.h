@@ -0,0 +1,54 @@
+
+#pragma once
+
+/**
+ * Header file
+ */
+#include <stdint.h>
+#include <string>
+
+#define CACHE_VERSION 3			/* Bump whenever a policy gives other results */
+#define CACHE_LIMIT (64ULL << 20)	/* Default size of the cache directory */
+
+/**
+ * CResultCache class
+ *
+ * Output of previous runs, one file per key in a cache directory
+ * Key: content hash and name of the job file (or the number of random jobs),
+ *      policy, time quantum, seed, aging, fleet and its threads, CPUs, CPU speeds,
+ *      switch cost and CACHE_VERSION, everything the output depends on
+ * A hit writes the stored completion table and utilization, without reading the jobs
+ * Least recently used entries (by modification time) are removed above the size limit
+ * Parallel processes share the directory: entries are renamed into place,
+ * lookups hold a shared flock on the "lock" file, stores and eviction an exclusive one,
+ * and a run holds a flock on its temporary entry, so the ones of killed runs are removed
+ */
+class CResultCache
+{
+public:
+	/* Constructor/Destructor */
+	CResultCache(const char* pDirectory, unsigned long long nLimit);
+	~CResultCache();
+
+	int Key(const char* pFileName, unsigned int nJobs, unsigned int nType, unsigned long long nQuantum, unsigned int nSeed, unsigned int nAging,
+		unsigned int nNodes, unsigned int nBalance, unsigned int nWorkers, unsigned int nCpus,
+		const char* pSpeeds, const char* pLevels, const char* pSwitch);	/* Key of this run */
+	bool Fetch();				/* Write the stored output of this key, if any */
+	int Begin();				/* Capture the standard output */
+	int Commit(bool bStore);		/* Stop capturing, write the output, keep it if asked */
+
+private:
+	int Lock(int nOperation);		/* flock the cache directory, -1 if it can't be used */
+	void Unlock(int nLock);			/* Release the lock */
+	void Evict();				/* Remove oldest entries above the limit */
+	std::string Entry() const;		/* File of the key */
+
+private:
+	std::string m_csDirectory;		/* Cache directory */
+	unsigned long long m_nLimit;		/* Size limit of the entries, in bytes */
+	uint64_t m_nKey;			/* Key of the run */
+	bool m_bKey;				/* Is m_nKey valid? */
+	int m_nOutput;				/* Standard output while capturing, -1 otherwise */
+	int m_nCapture;				/* Temporary entry while capturing, -1 otherwise */
+	std::string m_csCapture;		/* Name of the temporary entry */
+};
@@ -0,0 +1,188 @@
+
+#pragma once
+
+/**
+ * Header file
+ */
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <queue>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include "engine.h"
+#include "random.h"
+
+/**
+ * Load balancing policies of the dispatcher
+ */
+enum _balance_types {
+	BALANCE_RR = 0,		/* nodes in turn */
+	BALANCE_RANDOM,		/* uniform random node */
+	BALANCE_JSQ,		/* join the shortest queue, fewest jobs in the node */
+	BALANCE_P2C,		/* power of two choices, shorter of two random nodes */
+	BALANCE_LWL,		/* least work left, smallest remaining CPU time at the node's speed */
+	BALANCE_FAST,		/* shorter jobs to faster nodes, least work left within a speed */
+	BALANCE_MAX
+};
+
+/**
+ * CCluster class
+ *
+ * Front end dispatcher of a fleet of simulated nodes
+ * Each arriving job is routed to one node, which runs it with the local policy
+ * on its own event driven engine. Routing costs O(1) (rr, random, p2c) or
+ * O(log nodes) (jsq, lwl, fast), and only jsq needs every node simulated up to the arrival:
+ * nodes wait in a heap on their next event, and are advanced when it is due.
+ * p2c advances just the two nodes it compares, the others are simulated at the end.
+ *
+ * Nodes can be split in parts, one per host thread, each part with its own heap.
+ * Routing is instantaneous, so a job can only depend on the nodes' state at its
+ * arrival: the conservative window of the threads ends at an arrival time.
+ * The threads simulate their due nodes up to it, then the dispatcher routes the jobs
+ * of that time. jsq only sees lengths, so a window is only needed once a node may
+ * terminate a job, and it covers the arrival times since the last one. p2c brings
+ * the two nodes it compares up to date itself, a window once as many jobs as nodes
+ * are routed spreads the rest of the work. Small windows are done by the dispatcher alone.
+ * Without feedback (rr, random, lwl) all jobs are routed first, and there is
+ * a single window. Nodes are simulated on their own, and every draw of
+ * a node comes from the node's generator, so results don't depend on the threads.
+ *
+ * Nodes may have different speeds. fast splits the nodes in tiers of equal speed,
+ * and the jobs in size ranges: the shortest jobs go to the fastest tier, and each
+ * tier gets a share of the total work in proportion to its capacity.
+ */
+class CCluster
+{
+	typedef std::pair<unsigned long long, size_t> CDue;		/* Next event (or drain time), node */
+	typedef std::pair<size_t, size_t> CLength;		/* Jobs in the node, node */
+	typedef std::priority_queue<CDue, std::vector<CDue>, std::greater<CDue> > CDueHeap;	/* Min heap of nodes */
+
+	/**
+	 * Work of the parts, in each window
+	 */
+	enum _part_commands {
+		PART_ADVANCE = 0,	/* simulate due nodes up to the window end */
+		PART_FINISH,		/* run the nodes to the end, or a stop, and write back the jobs */
+	};
+
+	/**
+	 * CNode structure
+	 *
+	 * One simulated machine, its jobs are copies of the routed ones
+	 * Nodes are never moved, the engine and the queue refer to cJobs
+	 */
+	struct CNode {
+		std::vector<CJob> cJobs;	/* Jobs routed to this node */
+		std::vector<size_t> cIndex;	/* Index of each of them in the fleet list */
+		CReadyQueue* pQueue;		/* Local policy */
+		CEngine* pEngine;		/* Local simulation */
+		CRandom cRandom;		/* Draws of the local policy */
+		unsigned long long nQueued;	/* Time of the node's entry in the heap, ULLONG_MAX if none */
+		unsigned long long nHorizon;	/* Time of the node's entry by termination, ULLONG_MAX if none (jsq with threads) */
+		unsigned int nSpeed;		/* Base speed, in work units per time unit */
+	};
+
+	/**
+	 * CPart structure
+	 *
+	 * Nodes simulated by one host thread, only this thread touches them during a window
+	 */
+	struct CPart {
+		CDueHeap cDue;			/* Nodes of the part by next event */
+		CDueHeap cHorizon;		/* Nodes of the part by earliest termination (jsq with threads) */
+		std::vector<CLength> cChanged;	/* Nodes which changed length in the window, old length (jsq) */
+	};
+
+public:
+	/* Constructor/Destructor */
+	CCluster(std::vector<CJob>& cJobs, unsigned int nNodes, int nBalance, unsigned int nSeed, unsigned int nThreads);
+	~CCluster();
+
+	/**
+	 * GetJobs:
+	 * nNode: Node number
+	 * Returns the jobs of the node, for its ready queue
+	 */
+	inline const std::vector<CJob>& GetJobs(size_t nNode) const
+	{
+		return m_cNodes[nNode].cJobs;
+	}
+	/**
+	 * GetRandom:
+	 * nNode: Node number
+	 * Returns the generator of the node, for its ready queue
+	 */
+	inline CRandom& GetRandom(size_t nNode)
+	{
+		return m_cNodes[nNode].cRandom;
+	}
+	/**
+	 * GetNodes:
+	 * Returns number of nodes
+	 */
+	inline size_t GetNodes() const
+	{
+		return m_cNodes.size();
+	}
+
+	static int Balance(const char* pName);		/* Balance policy by name, -1 if unknown */
+	static const char* BalanceName(int nBalance);	/* Name of a balance policy */
+	void Attach(size_t nNode, CReadyQueue* pQueue, unsigned long long nQuantum, const CSpeed* pSpeed, const CSwitchCost* pCost);	/* Give the node its local policy, speed and switch cost */
+	void Run();				/* Route every job, then run the nodes to the end, or a signal stops it */
+	unsigned long long GetTime() const;	/* Last termination of the fleet */
+	void Report() const;			/* Utilization and turnaround percentiles, per node and fleet */
+	void Switches(unsigned long long& nSwitches, unsigned long long& nOverhead) const;	/* Context switches of the fleet */
+
+private:
+	size_t Route(size_t nIndex);		/* Pick the node of this job */
+	void Advance(unsigned long long nTime);	/* Simulate the due nodes up to this time */
+	size_t Simulate(size_t nPart, unsigned long long nTime, size_t nLimit);	/* Simulate some due nodes of one part up to this time */
+	void Sync(size_t nNode, unsigned long long nTime);	/* Simulate one node up to this time */
+	void Schedule(size_t nNode);		/* Put the node's next event in its part's heap */
+	bool Changes(unsigned long long nTime);	/* May a node terminate a job before this time? (jsq with threads) */
+	void Parallel(int nCommand, unsigned long long nTime);	/* Every part does this command */
+	void Work(size_t nPart);		/* Current command on one part */
+	void Worker(size_t nPart);		/* Host thread of a part */
+	/**
+	 * Owner:
+	 * nNode: Node number
+	 * Returns part of the node, parts are contiguous ranges of nodes
+	 */
+	inline size_t Owner(size_t nNode) const
+	{
+		return nNode * m_cParts.size() / m_cNodes.size();
+	}
+	size_t Length(size_t nNode) const;	/* Jobs in the node, READY, RUNNING or BLOCKED */
+	unsigned long long Terminated() const;	/* Jobs terminated in the fleet */
+	void Percentiles(std::vector<unsigned long long>& cTurnaround, double* pValue) const;	/* Tail of these turnarounds */
+	void Tiers();				/* Nodes by speed and the job sizes of each (lwl, fast) */
+
+private:
+	std::vector<CJob>& m_cJobs;		/* Fleet list, finish times are written back */
+	std::vector<CNode> m_cNodes;		/* Simulated machines */
+	int m_nBalance;				/* Load balancing policy */
+	CRandom m_cRandom;			/* Random node choices */
+	size_t m_nNext;				/* Next node for round robin */
+	CEventLog m_cLog;			/* Transitions of the nodes, nobody listens */
+	std::vector<CPart> m_cParts;		/* Nodes of each host thread */
+	bool m_bTrack;				/* Are the nodes simulated up to the arrivals? */
+	bool m_bHorizon;			/* Do windows wait for a node which may terminate a job? (jsq with threads) */
+	size_t m_nBatch;			/* Arrivals per window, jsq every one, p2c syncs the two nodes it compares */
+	std::vector<CDueHeap> m_cDrain;		/* Nodes of each tier by drain time, fastest tier first (lwl, fast) */
+	std::vector<unsigned long long> m_cCutoff;	/* Longest job of each tier (fast) */
+	std::set<CLength> m_cLength;		/* Nodes by number of jobs (jsq) */
+	std::mutex m_cLock;			/* Protects the window below */
+	std::condition_variable m_cStart;	/* New window for the threads */
+	std::condition_variable m_cDone;	/* Every thread is done with the window */
+	unsigned long long m_nRound;		/* Window number */
+	size_t m_nBusy;				/* Threads still working on the window */
+	int m_nCommand;				/* Work of the window */
+	unsigned long long m_nTarget;		/* End of the window */
+	bool m_bExit;				/* Threads should exit */
+	std::atomic<unsigned long long> m_nDone;	/* Jobs terminated, counted while the nodes finish */
+	std::exception_ptr m_pFailure;		/* First error of a part, the run stops with it */
+};
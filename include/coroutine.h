@@ -0,0 +1,146 @@
+
+#pragma once
+
+#ifdef HAVE_COROUTINE
+
+/**
+ * Header file
+ */
+#include <coroutine>
+#include <queue>
+#include <vector>
+
+#include "engine.h"
+
+class CCoroutineScheduler;
+
+/**
+ * CJobRoutine class
+ *
+ * Coroutine of one job, it runs its CPU bursts one quantum at a time
+ * and waits for its I/O bursts, suspending whenever it gives up the CPU
+ * The frame is created at first dispatch, and destroyed at termination
+ */
+class CJobRoutine
+{
+public:
+	struct promise_type {
+		inline CJobRoutine get_return_object()
+		{
+			return CJobRoutine(std::coroutine_handle<promise_type>::from_promise(*this));
+		}
+		inline std::suspend_always initial_suspend() noexcept { return std::suspend_always(); }
+		inline std::suspend_always final_suspend() noexcept { return std::suspend_always(); }
+		inline void return_void() {}
+		inline void unhandled_exception() { throw; }
+	};
+
+	/* Constructor/Destructor */
+	explicit CJobRoutine(std::coroutine_handle<promise_type> cHandle) : m_cHandle(cHandle) {};
+	~CJobRoutine() {};
+
+	/**
+	 * Handle:
+	 * Returns the coroutine, the scheduler owns it from now on
+	 */
+	inline std::coroutine_handle<> Handle() const
+	{
+		return m_cHandle;
+	}
+
+private:
+	std::coroutine_handle<promise_type> m_cHandle;	/* Suspended at start */
+};
+
+/**
+ * CQuantum class
+ *
+ * Awaited by the running job for more CPU time
+ * The job only suspends when it loses the CPU (quantum expiry or preemption),
+ * otherwise it goes on without a context switch
+ */
+class CQuantum
+{
+	CCoroutineScheduler& m_cScheduler;
+
+public:
+	CQuantum(CCoroutineScheduler& cScheduler) : m_cScheduler(cScheduler) {};
+	bool await_ready();
+	inline void await_suspend(std::coroutine_handle<> cHandle __attribute__((unused))) {}
+	inline void await_resume() {}
+};
+
+/**
+ * CWaitIO class
+ *
+ * Awaited by the running job at the end of a CPU burst, it is BLOCKED for the I/O time
+ */
+class CWaitIO
+{
+	CCoroutineScheduler& m_cScheduler;
+	unsigned long long m_nIO;
+
+public:
+	CWaitIO(CCoroutineScheduler& cScheduler, unsigned long long nIO) : m_cScheduler(cScheduler), m_nIO(nIO) {};
+	inline bool await_ready() { return false; }
+	void await_suspend(std::coroutine_handle<> cHandle);
+	inline void await_resume() {}
+};
+
+/**
+ * CCoroutineScheduler class
+ *
+ * Single CPU scheduler resuming job coroutines, in the order of the policy's ready queue
+ * FCFS runs each job to completion, round robin suspends it at quantum expiry,
+ * SRJF suspends it when a shorter job arrives, there is no OS thread per job.
+ * Transitions are the same as on the event driven engine.
+ */
+class CCoroutineScheduler
+{
+	typedef std::pair<unsigned long long, size_t> CWakeup;	/* I/O completion time, job index */
+
+	friend class CQuantum;
+	friend class CWaitIO;
+
+public:
+	/* Constructor/Destructor */
+	CCoroutineScheduler(std::vector<CJob>& cJobs, CReadyQueue& cQueue, unsigned long long nQuantum, CEventLog& cLog);
+	~CCoroutineScheduler();
+
+	/**
+	 * GetTime:
+	 * Returns current simulated time
+	 */
+	inline unsigned long long GetTime() const
+	{
+		return m_nTime;
+	}
+
+	void Run();				/* Run until all jobs are terminated, or a signal stops it */
+
+private:
+	CJobRoutine Routine(size_t nIndex);	/* Coroutine of a job */
+	bool Grant();				/* Run the job up to the next event, false if it loses the CPU */
+	bool Release();				/* Queue arrivals and I/O completions up to now */
+	unsigned long long NextEvent() const;	/* Time of next arrival or I/O completion */
+	void Dispatch(size_t nIndex);		/* Resume this job until it suspends */
+
+private:
+	std::vector<CJob>& m_cJobs;		/* List of all jobs */
+	CReadyQueue& m_cQueue;			/* Policy specific ready queue */
+	std::vector<std::coroutine_handle<> > m_cRoutines;	/* Coroutine of each job in the system */
+	std::vector<size_t> m_cPending;		/* Jobs not yet arrived, sorted by arrival time */
+	size_t m_nNext;				/* Next pending job */
+	std::priority_queue<CWakeup, std::vector<CWakeup>, std::greater<CWakeup> > m_cBlocked;	/* BLOCKED jobs, min heap on I/O completion */
+	unsigned long long m_nQuantum;	/* Time quantum, 0 means run to completion */
+	unsigned long long m_nTime;		/* Current simulated time */
+	size_t m_nRunning;			/* Running job */
+	size_t m_nHandoff;			/* Job picked at quantum expiry, NO_JOB if none */
+	unsigned long long m_nSliceStart;	/* Time current quantum started */
+	unsigned long long m_nIO;		/* I/O time of a job which suspended to block, 0 if none */
+	bool m_bBlocked;			/* Running job suspended to block */
+	size_t m_nDone;				/* Terminated jobs */
+	CEventLog& m_cLog;			/* Job state transitions */
+};
+
+#endif // HAVE_COROUTINE
@@ -0,0 +1,252 @@
+
+#pragma once
+
+/**
+ * Header file
+ */
+#include <queue>
+#include <stdexcept>
+#include <vector>
+#include <limits.h>
+
+#include "schedular.h"
+#include "events.h"
+#include "speed.h"
+
+#define NO_JOB ((size_t) -1)		/* No job is selected/running */
+
+/**
+ * TimeAfter:
+ * nTime: Simulated time
+ * nDelta: Time from then
+ *
+ * Returns the later time, throws instead of wrapping around past TIME_MAX
+ */
+inline unsigned long long TimeAfter(unsigned long long nTime, unsigned long long nDelta)
+{
+	if (nTime > TIME_MAX || nDelta > TIME_MAX - nTime) {
+		errno = ERANGE;
+		throw std::overflow_error("Simulated time overflows, use a coarser time unit");
+	}
+	return nTime + nDelta;
+}
+
+/**
+ * CArrivalOrder class
+ *
+ * Sort job indexes by arrival time
+ */
+class CArrivalOrder
+{
+	const std::vector<CJob>& m_cJobs;	/* List of all jobs */
+
+public:
+	CArrivalOrder(const std::vector<CJob>& cJobs) : m_cJobs(cJobs) {};
+	inline bool operator () (size_t nLeft, size_t nRight) const
+	{
+		return m_cJobs[nLeft].GetArrival() < m_cJobs[nRight].GetArrival();
+	}
+};
+
+/**
+ * CReadyQueue class
+ *
+ * Ready queue used by the event driven engine
+ * Each policy provides its own ordering, jobs are referred by index in the job list
+ */
+class CReadyQueue
+{
+protected:
+	unsigned long long m_nTime;	/* Current simulated time, set by the engine */
+
+public:
+	/* Constructor/Destructor */
+	CReadyQueue() : m_nTime(0) {};
+	virtual ~CReadyQueue() {};
+
+	/**
+	 * SetTime:
+	 * nTime: Current simulated time, for policies which depend on waiting time
+	 */
+	inline void SetTime(unsigned long long nTime)
+	{
+		m_nTime = nTime;
+	}
+
+	/**
+	 * Push:
+	 * nIndex: Job becomes READY
+	 */
+	virtual void Push(size_t nIndex) = 0;
+	/**
+	 * Pop:
+	 * Select next job to run, and remove it from the queue
+	 */
+	virtual size_t Pop() = 0;
+	/**
+	 * Empty:
+	 * Is there any READY job?
+	 */
+	virtual bool Empty() const = 0;
+	/**
+	 * Size:
+	 * Returns number of READY jobs
+	 */
+	virtual size_t Size() const = 0;
+	/**
+	 * Charge:
+	 * nIndex: Job which was RUNNING
+	 * nTime: Time the job spent on CPU since it was last charged
+	 */
+	virtual void Charge(size_t nIndex __attribute__((unused)), unsigned long long nTime __attribute__((unused))) {};
+	/**
+	 * Preempts:
+	 * nIndex: Job which is RUNNING
+	 * Should a READY job take the CPU from this job right away?
+	 */
+	virtual bool Preempts(size_t nIndex __attribute__((unused))) const { return false; };
+	/**
+	 * Crossing:
+	 * nIndex: Job which is RUNNING
+	 * Returns the time a READY job, by waiting only, starts to preempt this job,
+	 * ULLONG_MAX if none does
+	 */
+	virtual unsigned long long Crossing(size_t nIndex __attribute__((unused))) const { return ULLONG_MAX; };
+};
+
+/**
+ * CEngine class
+ *
+ * Event driven single CPU simulation
+ * Time jumps from event to event (arrival, quantum expiry, I/O completion, termination)
+ * instead of stepping one time unit at a time
+ * BLOCKED jobs wait in a heap on their I/O completion time, while other jobs use the CPU
+ * A CPU with a speed does work units instead of burst units, a job's slice ends
+ * when its work is done at that speed, which may change over time (DVFS)
+ * With a switch cost, a job put on the CPU after another one first does the work
+ * of the switch, then its own. The cost of an unfinished switch is lost if the job
+ * is preempted, and the policy is charged the whole time on the CPU.
+ */
+class CEngine
+{
+	typedef std::pair<unsigned long long, size_t> CWakeup;	/* I/O completion time, job index */
+
+public:
+	/* Constructor/Destructor */
+	CEngine(std::vector<CJob>& cJobs, CReadyQueue& cQueue, unsigned long long nQuantum, CEventLog& cLog);
+	~CEngine() {};
+
+	/**
+	 * GetTime:
+	 * Returns current simulated time
+	 */
+	inline unsigned long long GetTime() const
+	{
+		return m_nTime;
+	}
+	/**
+	 * IsIdle:
+	 * Nothing running, ready or waiting to arrive?
+	 */
+	inline bool IsIdle() const
+	{
+		return m_nRunning == NO_JOB && m_cQueue.Empty() && m_nNext == m_cPending.size() && m_cBlocked.empty();
+	}
+	/**
+	 * GetBusy:
+	 * Returns the time CPU was busy
+	 */
+	inline unsigned long long GetBusy() const
+	{
+		return m_nBusy;
+	}
+	/**
+	 * GetTerminated:
+	 * Returns number of jobs terminated so far
+	 */
+	inline size_t GetTerminated() const
+	{
+		return m_nTerminated;
+	}
+	/**
+	 * SetSpeed:
+	 * pSpeed: Speed of the CPU, NULL for one burst unit per time unit
+	 */
+	inline void SetSpeed(const CSpeed* pSpeed)
+	{
+		m_pSpeed = pSpeed;
+	}
+	/**
+	 * SetCost:
+	 * pCost: Cost of a context switch, NULL for free switches
+	 */
+	inline void SetCost(const CSwitchCost* pCost)
+	{
+		m_pCost = pCost;
+	}
+	/**
+	 * GetSwitches:
+	 * Returns number of context switches
+	 */
+	inline unsigned long long GetSwitches() const
+	{
+		return m_nSwitches;
+	}
+	/**
+	 * GetOverhead:
+	 * Returns work units spent on context switches
+	 */
+	inline unsigned long long GetOverhead() const
+	{
+		return m_nOverhead;
+	}
+
+	void Admit(size_t nIndex);		/* Job will arrive at its arrival time */
+	void AdmitAll();			/* Admit every job of the list, in arrival order */
+	bool Step();				/* Process the next event */
+	void AdvanceTo(unsigned long long nTime);	/* Process the events before this time */
+	void Run();				/* Run until all jobs are terminated */
+	unsigned long long NextEvent() const;	/* Time of the next event */
+	unsigned long long NextTermination() const;	/* Earliest time a job may terminate */
+
+private:
+	void Account();				/* Charge the running job up to current time */
+	void Dispatch();			/* Put next READY job on CPU */
+	void Start(size_t nIndex);		/* Put this job on CPU */
+	void Slice();				/* Start a new slice for running job */
+	void Terminate();			/* Running job is done */
+	void Block();				/* Running job waits for I/O */
+	/**
+	 * Speed:
+	 * Returns speed of the CPU, nominal without one
+	 */
+	inline const CSpeed& Speed() const
+	{
+		return m_pSpeed ? *m_pSpeed : m_cNominal;
+	}
+
+private:
+	std::vector<CJob>& m_cJobs;		/* List of all jobs */
+	CReadyQueue& m_cQueue;			/* Policy specific ready queue */
+	std::vector<size_t> m_cPending;		/* Jobs not yet arrived, sorted by arrival time */
+	size_t m_nNext;				/* Next pending job */
+	std::priority_queue<CWakeup, std::vector<CWakeup>, std::greater<CWakeup> > m_cBlocked;	/* BLOCKED jobs, min heap on I/O completion */
+	unsigned long long m_nQuantum;		/* Time quantum, 0 means run to completion */
+	unsigned long long m_nTime;		/* Current simulated time */
+	size_t m_nRunning;			/* Running job, NO_JOB if CPU is idle */
+	unsigned long long m_nSliceStart;	/* Time running job was last charged */
+	unsigned long long m_nSliceEnd;		/* Time running job's slice ends */
+	unsigned long long m_nFinish;		/* Time running job's burst is done, if it keeps the CPU */
+	unsigned long long m_nCrossing;		/* Time a READY job ages past the running job, ULLONG_MAX if never */
+	unsigned long long m_nBusy;		/* Time CPU was busy */
+	size_t m_nTerminated;			/* Jobs terminated */
+	const CSpeed* m_pSpeed;			/* Speed of the CPU, NULL if nominal */
+	CSpeed m_cNominal;			/* Nominal speed, for the work of switches */
+	const CSwitchCost* m_pCost;		/* Cost of a context switch, NULL if free */
+	size_t m_nLast;				/* Last job on the CPU, NO_JOB if none */
+	std::vector<unsigned long long> m_cOff;	/* Time each job left the CPU, ULLONG_MAX if it never ran */
+	unsigned long long m_nDebt;		/* Work units of the switch left for the running job */
+	unsigned long long m_nSwitches;		/* Context switches */
+	unsigned long long m_nOverhead;		/* Work units spent on context switches */
+	CEventLog& m_cLog;			/* Job state transitions */
+};
@@ -0,0 +1,349 @@
+
+#pragma once
+
+/**
+ * Header file
+ */
+#include <stdio.h>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * Job state transitions reported by the scheduling algorithms
+ */
+enum _event_types {
+	EV_READY = 0,		/* arrived, READY */
+	EV_RUNNING,		/* READY->RUNNING */
+	EV_PREEMPT,		/* RUNNING->READY */
+	EV_BLOCKED,		/* RUNNING->BLOCKED */
+	EV_WAKEUP,		/* BLOCKED->READY */
+	EV_TERMINATED,		/* RUNNING->TERMINATED */
+	EV_MAX
+};
+
+/**
+ * CTransition:
+ * Transition of a job in the list, sorted by time, job, then transition
+ */
+struct CTransition {
+	unsigned long long nTime;	/* Time of the transition */
+	size_t nIndex;		/* Job index in the list */
+	int nEvent;		/* Transition (see _event_types) */
+
+	inline bool operator < (const CTransition& cOther) const
+	{
+		if (nTime != cOther.nTime)
+			return nTime < cOther.nTime;
+		if (nIndex != cOther.nIndex)
+			return nIndex < cOther.nIndex;
+		return nEvent < cOther.nEvent;
+	}
+};
+
+/**
+ * CEventSink class
+ *
+ * Receives the job state transitions, in time order
+ */
+class CEventSink
+{
+public:
+	/* Constructor/Destructor */
+	CEventSink() {};
+	virtual ~CEventSink() {};
+
+	/**
+	 * Event:
+	 * nTime: Time of the transition
+	 * nJob: Job number
+	 * nCpu: CPU the job is/was running on
+	 * nEvent: Transition (see _event_types)
+	 */
+	virtual void Event(unsigned long long nTime, unsigned int nJob, unsigned int nCpu, int nEvent) = 0;
+	/**
+	 * Flush:
+	 * nTime: End of the run, states still open end there (a signal stopped the run)
+	 * No more events for this run
+	 */
+	virtual void Flush(unsigned long long nTime __attribute__((unused))) {};
+};
+
+/**
+ * CEventFilter class
+ *
+ * Selects the transitions a filtered sink receives, before any formatting
+ * Expression: terms separated by ",", lists inside a term separated by ":"
+ *     job=1:4:10-20         job numbers or ranges
+ *     time=100-200          time window, either end may be left out ("100-", "-200")
+ *     event=preempt:blocked event types (ready, running, preempt, blocked, wakeup, terminated)
+ *     sample=N              one in N of the transitions passing the other terms
+ */
+class CEventFilter
+{
+	typedef std::pair<unsigned int, unsigned int> CRange;	/* first, last job number */
+
+public:
+	/* Constructor/Destructor */
+	CEventFilter();
+	~CEventFilter() {};
+
+	/**
+	 * Pass:
+	 * Does the transition pass the filter?
+	 * Cheapest tests first, the job set is only searched if the rest passes
+	 */
+	inline bool Pass(unsigned long long nTime, unsigned int nJob, int nEvent)
+	{
+		if (!(m_nEvents & (1u << nEvent)) || nTime < m_nFrom || nTime > m_nTo)
+			return false;
+		if (!m_cJobs.empty() && !Match(nJob))
+			return false;
+		if (m_nSample > 1 && ++ m_nSeen < m_nSample)
+			return false;
+		m_nSeen = 0;
+		return true;
+	}
+
+	int Parse(const char* pExpression);	/* Parse a filter expression, -1 on error */
+
+private:
+	bool Match(unsigned int nJob) const;	/* Is the job in the job set? */
+
+private:
+	std::vector<CRange> m_cJobs;		/* Sorted, disjoint job ranges, empty for all jobs */
+	unsigned long long m_nFrom;		/* Time window start */
+	unsigned long long m_nTo;		/* Time window end */
+	unsigned int m_nEvents;			/* Bit for each event type passing */
+	unsigned int m_nSample;			/* Pass one in m_nSample */
+	unsigned int m_nSeen;			/* Transitions since the last one passed */
+};
+
+/**
+ * CEventLog class
+ *
+ * Dispatch the transitions to all the sinks
+ * Algorithms check Enabled() before reporting, so an empty log costs one branch
+ * Filtered sinks only receive the transitions passing the filter
+ */
+class CEventLog
+{
+public:
+	/* Constructor/Destructor */
+	CEventLog() {};
+	~CEventLog();
+
+	/**
+	 * Enabled:
+	 * Is anybody listening?
+	 */
+	inline bool Enabled() const
+	{
+		return !m_cSinks.empty();
+	}
+	/**
+	 * Event:
+	 * Report a transition to all the sinks
+	 */
+	inline void Event(unsigned long long nTime, unsigned int nJob, unsigned int nCpu, int nEvent)
+	{
+		int nPass = -1;		/* filter is evaluated once, and only if needed */
+		for (size_t nSink = 0; nSink < m_cSinks.size(); ++ nSink) {
+			if (m_cFiltered[nSink]) {
+				if (nPass < 0)
+					nPass = m_cFilter.Pass(nTime, nJob, nEvent);
+				if (nPass == 0)
+					continue;
+			}
+			m_cSinks[nSink]->Event(nTime, nJob, nCpu, nEvent);
+		}
+	}
+	/**
+	 * SetFilter:
+	 * cFilter: Filter for the filtered sinks
+	 */
+	inline void SetFilter(const CEventFilter& cFilter)
+	{
+		m_cFilter = cFilter;
+	}
+
+	void Add(CEventSink* pSink, bool bFiltered = false);	/* Add a sink, the log owns it */
+	void Flush(unsigned long long nTime);	/* Flush all the sinks, at the end of the run */
+	void Clear();			/* Remove all the sinks */
+
+private:
+	std::vector<CEventSink*> m_cSinks;	/* Sinks receiving the transitions */
+	std::vector<bool> m_cFiltered;		/* Does the sink only get transitions passing the filter? */
+	CEventFilter m_cFilter;			/* Filter for the filtered sinks */
+};
+
+/**
+ * CVerboseSink class
+ *
+ * One line for each transition, "At time 5, job 2 READY->RUNNING"
+ */
+class CVerboseSink : public CEventSink
+{
+public:
+	void Event(unsigned long long nTime, unsigned int nJob, unsigned int nCpu, int nEvent);
+};
+
+/**
+ * CTerminationSink class
+ *
+ * "job time" line as soon as a job terminates
+ */
+class CTerminationSink : public CEventSink
+{
+public:
+	void Event(unsigned long long nTime, unsigned int nJob, unsigned int nCpu, int nEvent);
+};
+
+/**
+ * CGanttSink class
+ *
+ * One record for each contiguous run of a job on a CPU
+ *     text:   "job cpu start end" per line
+ *     binary: GANTT_MAGIC, then 2 x uint32_t (job, cpu) and 2 x uint64_t (start, end) per record, host byte order
+ * Output volume follows the number of context switches, not time or transitions
+ */
+class CGanttSink : public CEventSink
+{
+	/**
+	 * CSlice:
+	 * Job running on a CPU
+	 */
+	struct CSlice {
+		unsigned int nJob;	/* Job number */
+		unsigned int nCpu;	/* CPU number */
+		unsigned long long nStart;	/* Start time */
+		unsigned long long nEnd;	/* End time */
+	};
+
+public:
+	/* Constructor/Destructor */
+	CGanttSink(const char* pFileName, bool bBinary);
+	~CGanttSink();
+
+	void Event(unsigned long long nTime, unsigned int nJob, unsigned int nCpu, int nEvent);
+	void Flush(unsigned long long nTime);
+
+private:
+	void Close(unsigned int nCpu, unsigned long long nTime);	/* Slice on this CPU ends */
+	void Write(const CSlice& cSlice);			/* Merge or write a slice */
+	void Emit(const CSlice& cSlice);			/* Write one record */
+
+private:
+	FILE* m_pFile;				/* Output file */
+	bool m_bBinary;				/* Binary records instead of text */
+	std::vector<CSlice> m_cOpen;		/* Open slice on each CPU */
+	std::vector<bool> m_cBusy;		/* Does the CPU have an open slice? */
+	CSlice m_cLast;				/* Last closed slice, not written yet */
+	bool m_bLast;				/* Is m_cLast valid? */
+};
+
+#define GANTT_MAGIC "GNT2"		/* Binary Gantt file header */
+
+/**
+ * CTraceSink class
+ *
+ * Chrome trace event JSON (chrome://tracing, ui.perfetto.dev), one time unit is one microsecond
+ *     process "CPUs": one track per CPU, a slice for each run of a job
+ *     process "Jobs": one track per job, a slice for each READY, RUNNING and BLOCKED period
+ * Slices are written as soon as they close, through a fixed size file buffer,
+ * only the open state of jobs in the system is kept in memory
+ */
+class CTraceSink : public CEventSink
+{
+	/**
+	 * COpen:
+	 * Open slice of a job or of a CPU
+	 */
+	struct COpen {
+		unsigned long long nStart;	/* Start time */
+		unsigned int nValue;	/* State for a job, job number for a CPU */
+		bool bOpen;		/* Is there an open slice? */
+	};
+
+public:
+	/* Constructor/Destructor */
+	CTraceSink(const char* pFileName);
+	~CTraceSink();
+
+	void Event(unsigned long long nTime, unsigned int nJob, unsigned int nCpu, int nEvent);
+	void Flush(unsigned long long nTime);
+
+private:
+	void Slice(unsigned int nPid, unsigned int nTid, const char* pName, unsigned long long nStart, unsigned long long nEnd);	/* Write a complete slice */
+	void Name(unsigned int nPid, unsigned int nTid, const char* pKind, unsigned int nNumber);	/* Write a track name */
+	void CloseJob(COpen& cJob, unsigned int nJob, unsigned long long nTime);	/* Job leaves its state */
+	void CloseCpu(unsigned int nCpu, unsigned long long nTime);	/* Run on this CPU ends */
+
+private:
+	FILE* m_pFile;				/* Output file */
+	char* m_pBuffer;			/* File buffer, TRACE_BUFFER bytes */
+	bool m_bFirst;				/* No record written yet */
+	std::unordered_map<unsigned int, COpen> m_cJobs;	/* Open state of jobs in the system */
+	std::vector<COpen> m_cCpus;		/* Open run on each CPU */
+};
+
+#define TRACE_BUFFER (1 << 16)		/* Trace file buffer */
+
+/**
+ * CMetricsSink class
+ *
+ * Time series of the schedule, one record per window of simulated time
+ *     start, end, completions, mean and max READY queue depth,
+ *     CPU utilization, mean waiting time of the jobs dispatched in the window
+ * Windows are kept in a ring of METRICS_WINDOWS entries
+ *     fixed width: the oldest window is written when its slot is needed
+ *     width 0:     the width starts at 1, and doubles by merging pairs of windows
+ *                  whenever the horizon no longer fits in the ring
+ * Memory is constant over the horizon, only the READY time of jobs in the system is kept
+ * Output is CSV, or a JSON array if the file name ends with ".json"
+ */
+class CMetricsSink : public CEventSink
+{
+	/**
+	 * CWindow:
+	 * Totals of one window
+	 */
+	struct CWindow {
+		unsigned long long nDepth;	/* READY queue depth integrated over time */
+		unsigned long long nBusy;	/* CPU busy time, all CPUs */
+		unsigned long long nWait;	/* Waiting time of the jobs dispatched */
+		unsigned int nMaxDepth;		/* Longest READY queue */
+		unsigned int nCompleted;	/* Jobs terminated */
+		unsigned int nDispatched;	/* READY->RUNNING transitions */
+	};
+
+public:
+	/* Constructor/Destructor */
+	CMetricsSink(const char* pFileName, unsigned long long nWidth);
+	~CMetricsSink();
+
+	void Event(unsigned long long nTime, unsigned int nJob, unsigned int nCpu, int nEvent);
+	void Flush(unsigned long long nTime);
+
+private:
+	void Advance(unsigned long long nTime);		/* Integrate queue depth and busy time up to nTime */
+	CWindow& Window(unsigned long long nTime);		/* Window of this time, written or merged as needed */
+	void Downsample();				/* Double the width, merging pairs of windows */
+	void Emit(unsigned long long nWindow);		/* Write a window, and free its slot */
+
+private:
+	FILE* m_pFile;				/* Output file */
+	bool m_bJson;				/* JSON array instead of CSV */
+	bool m_bAuto;				/* Width grows with the horizon */
+	unsigned long long m_nWidth;		/* Window width */
+	std::vector<CWindow> m_cWindows;	/* Ring of windows, window n is in slot n % METRICS_WINDOWS */
+	unsigned long long m_nFirst;		/* Oldest window not written */
+	unsigned long long m_nEnd;		/* One past the newest window used */
+	unsigned long long m_nLast;		/* Time integrated up to */
+	unsigned int m_nDepth;			/* READY jobs now */
+	unsigned int m_nRunning;		/* RUNNING jobs now */
+	unsigned int m_nCpus;			/* CPUs seen */
+	bool m_bFirst;				/* No record written yet */
+	std::unordered_map<unsigned int, unsigned long long> m_cReady;	/* Time each READY job became READY */
+};
+
+#define METRICS_WINDOWS 1024		/* Windows in the ring */
@@ -0,0 +1,74 @@
+
+#pragma once
+
+/**
+ * Header file
+ */
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+#include "engine.h"
+
+/**
+ * CTask:
+ * One step of real work, returns true while there is more work to do
+ * Each return is a yield point, where the job can be preempted
+ */
+typedef std::function<bool ()> CTask;
+
+/**
+ * CExecutor class
+ *
+ * Runs the jobs as real tasks on a pool of worker threads,
+ * in the order given by the policy's ready queue.
+ * One time unit of the burst is one step of the task, so the quantum
+ * and the SRJF preemption are checked between steps (cooperative).
+ * Jobs without a registered task spin for a calibrated time per unit.
+ * Arrival times are released in real time, one unit is nUnit microseconds.
+ * Programs link libsched.a and register their own work (see tasks.cpp).
+ */
+class CExecutor
+{
+	typedef std::chrono::steady_clock CClock;
+
+public:
+	/* Constructor/Destructor */
+	CExecutor(std::vector<CJob>& cJobs, CReadyQueue& cQueue, unsigned long long nQuantum, unsigned int nWorkers, unsigned int nUnit);
+	~CExecutor() {};
+
+	void Register(size_t nIndex, const CTask& cTask);	/* Real work for this job, instead of spinning */
+	void Run();				/* Release the jobs and wait for all of them */
+
+	/**
+	 * GetFinish:
+	 * nIndex: Job index
+	 * Returns measured termination time of the job, in time units
+	 */
+	inline double GetFinish(size_t nIndex) const
+	{
+		return m_cFinish[nIndex];
+	}
+
+private:
+	void Calibrate();			/* Spin rounds for one time unit */
+	void Spin() const;			/* Burn one time unit of CPU */
+	void Worker();				/* Run READY jobs until all are done */
+	double Now() const;			/* Time since start, in time units */
+
+private:
+	std::vector<CJob>& m_cJobs;		/* List of all jobs */
+	CReadyQueue& m_cQueue;			/* Policy specific ready queue */
+	std::vector<CTask> m_cTasks;		/* Work of each job, empty for spinning */
+	std::vector<double> m_cFinish;		/* Measured termination of each job */
+	unsigned long long m_nQuantum;	/* Time quantum, 0 means run to completion */
+	unsigned int m_nWorkers;		/* Number of worker threads */
+	unsigned int m_nUnit;			/* Microseconds per time unit */
+	unsigned long long m_nRounds;		/* Spin rounds per time unit */
+	size_t m_nDone;				/* Number of terminated jobs */
+	CClock::time_point m_cStart;		/* Wall clock start */
+	std::mutex m_cLock;			/* Protects the queue and the jobs */
+	std::condition_variable m_cCond;	/* Signals a READY job, or the last termination */
+};
@@ -0,0 +1,101 @@
+
+#pragma once
+
+/**
+ * Header file
+ */
+#include <queue>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <stdint.h>
+
+#include "engine.h"
+#include "lottery.h"
+
+#define NO_GROUP ((unsigned int) -1)	/* Job not placed in the group tree yet */
+
+/**
+ * CFairShareQueue class
+ *
+ * Ready queue for hierarchical fair share, like cgroup cpu.weight
+ * Jobs carry a group path, "group=/a:2/b" puts the job in group b of group a,
+ * and gives group a the weight 2 (default 1, last weight read wins).
+ * Jobs without a group belong to the root.
+ * CPU time is split between the siblings of each group by their weight,
+ * then between the jobs of a group (by tickets) and its subgroups.
+ *
+ * Each group works as a stride queue of its children (jobs and subgroups with
+ * READY jobs): a child's pass advances by (STRIDE1 / weight) for every time unit
+ * it runs, and the child with the smallest pass goes next.
+ * Pop walks down the smallest passes from the root, O(depth log fanout).
+ * Charge moves the pass of every group on the job's path; a group still in its
+ * parent's heap gets a new entry, and the old one is dropped when it comes on top.
+ */
+class CFairShareQueue : public CReadyQueue
+{
+	/**
+	 * CEntry:
+	 * Child of a group in the group's heap
+	 */
+	struct CEntry {
+		uint64_t nPass;			/* Pass value when pushed */
+		size_t nChild;			/* Job index or group index */
+		unsigned int nGeneration;	/* Generation of the group when pushed, 0 for a job */
+		bool bJob;			/* Is the child a job? */
+
+		inline bool operator > (const CEntry& cOther) const
+		{
+			if (nPass != cOther.nPass)
+				return nPass > cOther.nPass;
+			if (bJob != cOther.bJob)
+				return bJob > cOther.bJob;	/* jobs of the group before its subgroups */
+			return nChild > cOther.nChild;
+		}
+	};
+	typedef std::priority_queue<CEntry, std::vector<CEntry>, std::greater<CEntry> > CHeap;
+
+	/**
+	 * CGroup:
+	 * Node of the group tree
+	 */
+	struct CGroup {
+		unsigned int nParent;		/* Parent group, NO_GROUP for the root */
+		unsigned int nWeight;		/* Share among siblings */
+		uint64_t nPass;			/* Pass value in the parent's heap */
+		uint64_t nGlobalPass;		/* Pass value of the last child selected */
+		size_t nReady;			/* READY jobs in the subtree */
+		unsigned int nGeneration;	/* Bumped whenever the group gets a new entry in its parent's heap */
+		CHeap cHeap;			/* Jobs and subgroups with READY jobs */
+	};
+
+public:
+	/* Constructor/Destructor */
+	CFairShareQueue(const std::vector<CJob>& cJobs);
+	~CFairShareQueue() {};
+
+	void Push(size_t nIndex);
+	size_t Pop();
+	void Charge(size_t nIndex, unsigned long long nTime);
+	inline bool Empty() const
+	{
+		return m_cGroups[0].nReady == 0;
+	}
+	inline size_t Size() const
+	{
+		return m_cGroups[0].nReady;
+	}
+
+private:
+	unsigned int Place(size_t nIndex);	/* Group of a job, creating the path as needed */
+	void Enter(unsigned int nGroup);	/* Give the group a new entry in its parent's heap */
+
+private:
+	const std::vector<CJob>& m_cJobs;		/* List of all jobs */
+	std::vector<CGroup> m_cGroups;			/* Group tree, the root is group 0 */
+	std::unordered_map<std::string, unsigned int> m_cPaths;	/* Group of each path, e.g. "/a/b" */
+	std::vector<unsigned int> m_cGroupOf;		/* Group of each job, NO_GROUP if not placed yet */
+	std::vector<uint64_t> m_cPass;			/* Pass value of each job in its group */
+	std::string m_csLast;				/* Path of the last job placed */
+	unsigned int m_nLast;				/* Group of the last job placed, NO_GROUP if none */
+};
@@ -0,0 +1,119 @@
+
+#pragma once
+
+/**
+ * Header file
+ */
+#include <vector>
+
+/**
+ * CFenwickTree class
+ *
+ * Binary indexed tree over non-negative weights
+ * Update, prefix sum and weighted search are all O(log n)
+ */
+template <typename T>
+class CFenwickTree
+{
+	std::vector<T> m_cTree;		/* 1-based tree, m_cTree[0] unused */
+	std::vector<T> m_cValue;	/* Current weight for each slot */
+	T m_nTotal;			/* Sum of all weights */
+
+public:
+	/* Constructor/Destructor */
+	CFenwickTree(size_t nSize = 0) : m_cTree(nSize + 1, 0), m_cValue(nSize, 0), m_nTotal(0) {};
+	~CFenwickTree() {};
+
+	/**
+	 * Size:
+	 * Returns number of slots
+	 */
+	inline size_t Size() const
+	{
+		return m_cValue.size();
+	}
+	/**
+	 * Total:
+	 * Returns sum of all weights
+	 */
+	inline T Total() const
+	{
+		return m_nTotal;
+	}
+	/**
+	 * Get:
+	 * nIndex: Slot number
+	 * Returns the weight stored at this slot
+	 */
+	inline T Get(size_t nIndex) const
+	{
+		return m_cValue[nIndex];
+	}
+
+	/**
+	 * Resize:
+	 * nSize: New number of slots (only grows)
+	 * Tree is rebuilt in O(n), callers double the size so it is amortized
+	 */
+	void Resize(size_t nSize)
+	{
+		if (nSize <= Size())
+			return;
+		m_cValue.resize(nSize, 0);
+		m_cTree.assign(nSize + 1, 0);
+		for (size_t nIndex = 1; nIndex <= nSize; ++ nIndex) {
+			m_cTree[nIndex] += m_cValue[nIndex - 1];
+			size_t nParent = nIndex + (nIndex & (0 - nIndex));
+			if (nParent <= nSize)
+				m_cTree[nParent] += m_cTree[nIndex];
+		}
+	}
+
+	/**
+	 * Set:
+	 * nIndex: Slot number
+	 * nValue: New weight for this slot
+	 */
+	void Set(size_t nIndex, T nValue)
+	{
+		T nDelta = nValue - m_cValue[nIndex];	/* unsigned wrap-around cancels out in the sums */
+		m_cValue[nIndex] = nValue;
+		m_nTotal += nDelta;
+		for (size_t nPos = nIndex + 1; nPos < m_cTree.size(); nPos += nPos & (0 - nPos))
+			m_cTree[nPos] += nDelta;
+	}
+
+	/**
+	 * Prefix:
+	 * nCount: Number of leading slots
+	 * Returns sum of weights of slots [0, nCount)
+	 */
+	T Prefix(size_t nCount) const
+	{
+		T nSum = 0;
+		for (size_t nPos = nCount; nPos > 0; nPos -= nPos & (0 - nPos))
+			nSum += m_cTree[nPos];
+		return nSum;
+	}
+
+	/**
+	 * Find:
+	 * nValue: Weight offset, must be less than Total()
+	 * Returns the slot whose weight range covers nValue
+	 * i.e. smallest slot where Prefix(slot + 1) > nValue
+	 */
+	size_t Find(T nValue) const
+	{
+		size_t nPos = 0;
+		size_t nStep = 1;
+		while ((nStep << 1) < m_cTree.size())
+			nStep <<= 1;
+		for (; nStep > 0; nStep >>= 1) {
+			if (nPos + nStep < m_cTree.size() && m_cTree[nPos + nStep] <= nValue) {
+				nPos += nStep;
+				nValue -= m_cTree[nPos];
+			}
+		}
+		return nPos;	/* 1-based position nPos + 1, which is slot nPos */
+	}
+};
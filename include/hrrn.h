@@ -0,0 +1,41 @@
+
+#pragma once
+
+/**
+ * Header file
+ */
+#include <vector>
+
+#include "engine.h"
+#include "kinetic.h"
+
+/**
+ * CHrrnQueue class
+ *
+ * Ready queue for highest response ratio next (non-preemptive)
+ *     ratio = (wait + burst) / burst
+ * Ratios change with time, they are kept in a kinetic tournament
+ * which only reorders jobs when two ratios cross
+ */
+class CHrrnQueue : public CReadyQueue
+{
+public:
+	/* Constructor/Destructor */
+	CHrrnQueue(const std::vector<CJob>& cJobs) : m_cJobs(cJobs), m_cTournament(cJobs.size()) {};
+	~CHrrnQueue() {};
+
+	void Push(size_t nIndex);
+	size_t Pop();
+	inline bool Empty() const
+	{
+		return m_cTournament.Empty();
+	}
+	inline size_t Size() const
+	{
+		return m_cTournament.Size();
+	}
+
+private:
+	const std::vector<CJob>& m_cJobs;	/* List of all jobs */
+	CKineticTournament m_cTournament;	/* READY jobs by response ratio */
+};
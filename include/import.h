@@ -0,0 +1,74 @@
+
+#pragma once
+
+/**
+ * Header file
+ */
+#include <istream>
+#include <unordered_map>
+#include <vector>
+
+#include "schedular.h"
+
+enum _task_states {
+	TASK_RUNNABLE = 0,	/* waiting for a CPU, or preempted */
+	TASK_RUNNING,		/* on a CPU */
+	TASK_SLEEPING,		/* blocked, its next wakeup ends an I/O burst */
+};
+
+/**
+ * CTraceImport class
+ *
+ * Jobs from a Linux scheduler trace, the text of "perf sched script" or of the
+ * ftrace sched_switch, sched_wakeup and sched_process_exit events (trace file
+ * or trace-cmd report), in either the key=value or the compact payload format.
+ * Each task becomes a job: its arrival is the first time it is runnable, its
+ * CPU bursts are the time on a CPU until it sleeps, being preempted doesn't end
+ * a burst, and the time asleep up to its next wakeup is an I/O burst.
+ * The trace is read in one pass, only the tasks alive are kept, a task becomes
+ * a job when it exits, or at the end of the trace.
+ */
+class CTraceImport
+{
+	/**
+	 * CTask structure
+	 *
+	 * Task being reconstructed
+	 */
+	struct CTask {
+		unsigned long long nArrival;	/* Time the task was first runnable, in ns */
+		int nState;			/* State of the task (see _task_states) */
+		unsigned long long nSince;	/* Time of the last state change, in ns */
+		unsigned long long nCpu;	/* CPU time of the current burst so far, in ns */
+		std::vector<unsigned long long> cBursts;	/* CPU and I/O bursts done, in ns */
+	};
+
+public:
+	/* Constructor/Destructor */
+	CTraceImport(std::vector<CJob>& cJobs, unsigned int nType, unsigned int nTick);
+	~CTraceImport() {};
+
+	int Read(std::istream& cInput);		/* Every job of the trace, by arrival */
+
+private:
+	int Parse(const char* pLine);		/* One line of the trace */
+	static bool Stamp(const char* pLine, const char* pEvent, unsigned long long& nTime);	/* Time of the event */
+	static bool Field(const char* pPayload, const char* pName, const char*& pValue);	/* Value of "name=value" */
+	static bool Compact(const char* pBegin, const char* pEnd, unsigned int& nPid, char* pState);	/* Pid and state of "comm:pid [prio] state" */
+	CTask& Find(unsigned int nPid, unsigned long long nTime);	/* Task of this pid, runnable from now if new */
+	void Wakeup(unsigned int nPid, unsigned long long nTime);	/* Task is runnable */
+	void Switch(unsigned int nPrev, char cState, unsigned int nNext, unsigned long long nTime);	/* CPU goes from a task to another */
+	void Exit(unsigned int nPid, unsigned long long nTime);	/* Task is done */
+	int Finish(unsigned int nPid, CTask& cTask);	/* Add the job of the task */
+	unsigned long long Units(unsigned long long nTime) const;	/* ns to time units, rounded */
+
+private:
+	std::vector<CJob>& m_cJobs;		/* Jobs of the finished tasks */
+	unsigned int m_nType;			/* Type of scheduling of the jobs */
+	unsigned long long m_nTick;		/* ns per time unit */
+	std::unordered_map<unsigned int, CTask> m_cTasks;	/* Tasks alive, by pid */
+	unsigned long long m_nStart;		/* Time of the first event, in ns */
+	unsigned long long m_nLast;		/* Time of the last event, in ns */
+	bool m_bStarted;			/* Was there an event? */
+	bool m_bOverflow;			/* Did a job go past TIME_MAX? */
+};
@@ -0,0 +1,73 @@
+
+#pragma once
+
+/**
+ * Header file
+ */
+#include <vector>
+#include <stdint.h>
+
+/**
+ * CKineticTournament class
+ *
+ * Kinetic tournament tree, keeps the maximum of response ratios
+ *     (t - ready + burst) / burst
+ * which are lines in time t. Each internal node stores the winner of its
+ * two children, and a certificate: the first time its loser overtakes the winner.
+ * The tree is only touched when a certificate fails, or on insert/remove,
+ * each costs O(log n), so selection doesn't rebuild anything.
+ */
+class CKineticTournament
+{
+	/**
+	 * CNode:
+	 * Internal node of the tournament
+	 */
+	struct CNode {
+		size_t nWinner;		/* Leaf winning this subtree, NO_LEAF if empty */
+		uint64_t nFail;		/* Time certificate of this node fails */
+		uint64_t nMinFail;	/* Earliest certificate failure in this subtree */
+	};
+
+public:
+	/* Constructor/Destructor */
+	CKineticTournament(size_t nSize = 0);
+	~CKineticTournament() {};
+
+	/**
+	 * Empty:
+	 * Is there any leaf in the tournament?
+	 */
+	inline bool Empty() const
+	{
+		return m_nCount == 0;
+	}
+	/**
+	 * Size:
+	 * Returns number of leaves in the tournament
+	 */
+	inline size_t Size() const
+	{
+		return m_nCount;
+	}
+
+	void Insert(size_t nIndex, uint64_t nReady, uint64_t nBurst, uint64_t nTime);	/* Add a leaf */
+	void Remove(size_t nIndex, uint64_t nTime);	/* Remove a leaf */
+	size_t Top(uint64_t nTime);			/* Leaf with highest ratio at this time */
+	bool Better(size_t nLeft, size_t nRight, uint64_t nTime) const;	/* Does left beat right at this time? */
+
+private:
+	void Grow(size_t nIndex);			/* Make room for this leaf */
+	void Advance(uint64_t nTime);			/* Process certificate failures up to this time */
+	void Update(size_t nNode, uint64_t nTime);	/* Recompute a node and its ancestors */
+	void Compute(size_t nNode, uint64_t nTime);	/* Recompute a node from its children */
+	uint64_t FailTime(size_t nWinner, size_t nLoser, uint64_t nTime) const;	/* When loser overtakes winner */
+
+private:
+	std::vector<CNode> m_cNode;			/* 1-based heap layout, leaves at [m_nLeaves, 2 * m_nLeaves) */
+	std::vector<int64_t> m_cOffset;			/* burst - ready for each leaf */
+	std::vector<uint64_t> m_cBurst;			/* burst for each leaf */
+	size_t m_nLeaves;				/* Number of leaf slots, power of two */
+	size_t m_nCount;				/* Number of leaves in use */
+	uint64_t m_nNow;				/* Time of the last processed certificate */
+};
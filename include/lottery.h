@@ -0,0 +1,82 @@
+
+#pragma once
+
+/**
+ * Header file
+ */
+#include <queue>
+#include <vector>
+#include <stdint.h>
+
+#include "engine.h"
+#include "fenwick.h"
+#include "random.h"
+
+#define STRIDE1 TICKETS_MAX	/* Stride of a job holding one ticket */
+
+/**
+ * CLotteryQueue class
+ *
+ * Ready queue for lottery scheduling
+ * Tickets of READY jobs are kept in a Fenwick tree indexed by job,
+ * so drawing the winner and updating tickets are O(log n)
+ */
+class CLotteryQueue : public CReadyQueue
+{
+public:
+	/* Constructor/Destructor */
+	CLotteryQueue(const std::vector<CJob>& cJobs, CRandom& cRandom);
+	~CLotteryQueue() {};
+
+	void Push(size_t nIndex);
+	size_t Pop();
+	inline bool Empty() const
+	{
+		return m_nSize == 0;
+	}
+	inline size_t Size() const
+	{
+		return m_nSize;
+	}
+
+private:
+	const std::vector<CJob>& m_cJobs;		/* List of all jobs */
+	CRandom& m_cRandom;				/* Draws the winning ticket */
+	CFenwickTree<uint64_t> m_cTickets;		/* Tickets held by each READY job */
+	size_t m_nSize;					/* Number of READY jobs */
+};
+
+/**
+ * CStrideQueue class
+ *
+ * Ready queue for stride scheduling
+ * Deterministic counterpart of lottery, job with the smallest pass value runs next
+ * pass advances by (STRIDE1 / tickets) for every time unit a job runs
+ */
+class CStrideQueue : public CReadyQueue
+{
+	typedef std::pair<uint64_t, size_t> CPass;	/* pass value, job index */
+
+public:
+	/* Constructor/Destructor */
+	CStrideQueue(const std::vector<CJob>& cJobs);
+	~CStrideQueue() {};
+
+	void Push(size_t nIndex);
+	size_t Pop();
+	void Charge(size_t nIndex, unsigned long long nTime);
+	inline bool Empty() const
+	{
+		return m_cHeap.empty();
+	}
+	inline size_t Size() const
+	{
+		return m_cHeap.size();
+	}
+
+private:
+	const std::vector<CJob>& m_cJobs;		/* List of all jobs */
+	std::priority_queue<CPass, std::vector<CPass>, std::greater<CPass> > m_cHeap;	/* min heap on pass value */
+	std::vector<uint64_t> m_cPass;			/* pass value for each job */
+	uint64_t m_nGlobalPass;				/* pass value of the last selected job */
+};
@@ -0,0 +1,61 @@
+
+#pragma once
+
+/**
+ * Header file
+ */
+#include <deque>
+#include <vector>
+#include <stdint.h>
+
+#include "engine.h"
+
+/**
+ * CPriorityQueue class
+ *
+ * Ready queue for static priority scheduling with aging
+ *
+ * A job waiting since time t with priority p is lifted by one level every
+ * nAging time units, so at time T its effective priority is
+ *     p - (T - t) / nAging  =  ceil((p * nAging + t - T) / nAging)
+ * which only depends on the key p * nAging + t, and not on T.
+ * Jobs are kept in one FIFO bucket per priority level, stamped with the key;
+ * within a bucket keys are increasing because jobs enter in time order.
+ * Selection compares the head of each non-empty bucket, which is O(PRIO_LEVELS)
+ * no matter how many jobs are waiting, and nobody walks the waiting jobs to age them.
+ */
+class CPriorityQueue : public CReadyQueue
+{
+	typedef std::pair<uint64_t, size_t> CStamp;	/* key, job index */
+
+public:
+	/* Constructor/Destructor */
+	CPriorityQueue(const std::vector<CJob>& cJobs, unsigned int nAging, bool bPreemptive);
+	~CPriorityQueue() {};
+
+	void Push(size_t nIndex);
+	size_t Pop();
+	bool Preempts(size_t nIndex) const;
+	unsigned long long Crossing(size_t nIndex) const;
+	inline bool Empty() const
+	{
+		return m_nSize == 0;
+	}
+	inline size_t Size() const
+	{
+		return m_nSize;
+	}
+
+private:
+	int Best() const;				/* Bucket holding the best job */
+	unsigned int Effective(uint64_t nKey) const;	/* Effective priority at current time */
+	static bool Before(uint64_t nKey, const CStamp& cStamp);	/* Is the key below the stamp's? */
+
+private:
+	const std::vector<CJob>& m_cJobs;		/* List of all jobs */
+	std::deque<CStamp> m_cBucket[PRIO_LEVELS];	/* READY jobs for each priority level */
+	uint64_t m_nMask;				/* Non-empty buckets */
+	uint64_t m_nAging;				/* Time to lift one level (TIME_MAX + 1 without aging) */
+	size_t m_nSize;					/* Number of READY jobs */
+	bool m_bPreemptive;				/* Preempt on a better job becoming READY */
+};
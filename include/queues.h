@@ -0,0 +1,78 @@
+
+#pragma once
+
+/**
+ * Header file
+ */
+#include <queue>
+#include <vector>
+
+#include "engine.h"
+
+/**
+ * CFifoQueue class
+ *
+ * Ready queue in the order jobs became READY
+ * FCFS without time quantum, round robin with time quantum
+ */
+class CFifoQueue : public CReadyQueue
+{
+public:
+	/* Constructor/Destructor */
+	CFifoQueue() {};
+	~CFifoQueue() {};
+
+	inline void Push(size_t nIndex)
+	{
+		m_cQueue.push(nIndex);
+	}
+	inline size_t Pop()
+	{
+		size_t nIndex = m_cQueue.front();
+		m_cQueue.pop();
+		return nIndex;
+	}
+	inline bool Empty() const
+	{
+		return m_cQueue.empty();
+	}
+	inline size_t Size() const
+	{
+		return m_cQueue.size();
+	}
+
+private:
+	std::queue<size_t> m_cQueue;		/* READY jobs */
+};
+
+/**
+ * CShortestQueue class
+ *
+ * Ready queue for SRJF, shortest remaining CPU burst first
+ * A READY job with shorter remaining burst preempts the running job
+ */
+class CShortestQueue : public CReadyQueue
+{
+	typedef std::pair<unsigned long long, size_t> CRemaining;	/* remaining burst, job index */
+
+public:
+	/* Constructor/Destructor */
+	CShortestQueue(const std::vector<CJob>& cJobs) : m_cJobs(cJobs) {};
+	~CShortestQueue() {};
+
+	void Push(size_t nIndex);
+	size_t Pop();
+	bool Preempts(size_t nIndex) const;
+	inline bool Empty() const
+	{
+		return m_cHeap.empty();
+	}
+	inline size_t Size() const
+	{
+		return m_cHeap.size();
+	}
+
+private:
+	const std::vector<CJob>& m_cJobs;	/* List of all jobs */
+	std::priority_queue<CRemaining, std::vector<CRemaining>, std::greater<CRemaining> > m_cHeap;	/* min heap on remaining burst */
+};
@@ -0,0 +1,57 @@
+
+#pragma once
+
+/**
+ * Header file
+ */
+#include <stdint.h>
+
+/**
+ * CRandom class
+ *
+ * Small seeded pseudo random number generator (xorshift64*)
+ * Same seed always gives the same sequence, so runs are reproducible
+ */
+class CRandom
+{
+	uint64_t m_nState;		/* Generator state, never zero */
+
+public:
+	/* Constructor/Destructor */
+	CRandom(uint64_t nSeed = 1) { Seed(nSeed); };
+	~CRandom() {};
+
+	/**
+	 * Seed:
+	 * nSeed: Seed for the generator, mixed with splitmix64 so small seeds are fine
+	 */
+	inline void Seed(uint64_t nSeed)
+	{
+		nSeed += 0x9E3779B97F4A7C15ULL;
+		nSeed = (nSeed ^ (nSeed >> 30)) * 0xBF58476D1CE4E5B9ULL;
+		nSeed = (nSeed ^ (nSeed >> 27)) * 0x94D049BB133111EBULL;
+		m_nState = nSeed ^ (nSeed >> 31);
+		if (m_nState == 0)
+			m_nState = 0x9E3779B97F4A7C15ULL;
+	}
+	/**
+	 * Next:
+	 * Returns next 64 bit random number
+	 */
+	inline uint64_t Next()
+	{
+		m_nState ^= m_nState >> 12;
+		m_nState ^= m_nState << 25;
+		m_nState ^= m_nState >> 27;
+		return m_nState * 0x2545F4914F6CDD1DULL;
+	}
+	/**
+	 * Range:
+	 * nRange: Upper bound (exclusive)
+	 * Returns random number in [0, nRange)
+	 */
+	inline uint64_t Range(uint64_t nRange)
+	{
+		return nRange ? Next() % nRange : 0;
+	}
+};
@@ -4,7 +4,17 @@
 /**
  * Header file
  */
+#include <algorithm>
+#include <istream>
 #include <queue>
+#include <string>
+#include <vector>
+
+#include "random.h"
+#include "events.h"
+#include "speed.h"
+
+class CReadyQueue;
 
 /**
  * CJob class
@@ -14,18 +24,25 @@
 class CJob
 {
 	unsigned int m_nJob;		/* Job number */
-	unsigned int m_nBurst;		/* Burst time */
-	unsigned int m_nArrival;	/* Arrival time */
+	unsigned long long m_nBurst;	/* Burst time */
+	unsigned long long m_nArrival;	/* Arrival time */
 	unsigned int m_nType;		/* Type of CPU scheduling */
-	unsigned int m_nTime;		/* Total time spent unless terminated */
-	unsigned int m_nRunning;	/* Total running time */
+	unsigned long long m_nTime;	/* Total time spent unless terminated */
+	unsigned long long m_nRunning;	/* Total running time, in burst units at nominal speed */
+	unsigned int m_nTickets;	/* Tickets for lottery/stride scheduling */
+	unsigned int m_nPriority;	/* Static priority, 0 is the highest */
+	std::string m_csGroup;		/* Group path for fair share, e.g. "/a:2/b", empty for the root */
+	unsigned int m_nCpus;		/* CPUs the job needs at once, for backfilling */
+	unsigned long long m_nEstimate;	/* User runtime estimate, 0 if the burst is known */
+	std::vector<unsigned long long> m_cBursts;	/* CPU and I/O bursts, alternating, empty for a single CPU burst */
+	unsigned int m_nPhase;		/* Current CPU burst in m_cBursts */
+	unsigned long long m_nBurstEnd;	/* Running time at which the current CPU burst ends */
+	unsigned int m_nWork;		/* Work units done towards the next burst unit, below SPEED_ONE */
 
 public:
-	/* Constructor/Destructor */
+	/* Constructor, copies and moves are member by member */
 	CJob() {};
-	CJob(unsigned int nType, unsigned int nJob, unsigned int nArrival, unsigned int nBurst);
-	CJob(const CJob& cJob);		/* Copy constructor */
-	~CJob() {};
+	CJob(unsigned int nType, unsigned int nJob, unsigned long long nArrival, unsigned long long nBurst);
 
 	/**
 	 * SetType:
@@ -64,7 +81,7 @@ public:
 	 * SetBurst:
 	 * nBurst: Burst time for a job
 	 */
-	inline void SetBurst(const unsigned int nBurst)
+	inline void SetBurst(const unsigned long long nBurst)
 	{
 		m_nBurst = nBurst;
 	}
@@ -72,7 +89,7 @@ public:
 	 * GetBurst:
 	 * Returns the burst time for this job
 	 */
-	inline unsigned int GetBurst() const
+	inline unsigned long long GetBurst() const
 	{
 		return m_nBurst;
 	}
@@ -80,7 +97,7 @@ public:
 	 * SetArrival:
 	 * nArrival: Sets the arrival time for this job
 	 */
-	inline void SetArrival(const unsigned int nArrival)
+	inline void SetArrival(const unsigned long long nArrival)
 	{
 		m_nArrival = nArrival;
 	}
@@ -88,7 +105,7 @@ public:
 	 * GetArrival:
 	 * Returns the arrival time for job
 	 */
-	inline unsigned int GetArrival() const
+	inline unsigned long long GetArrival() const
 	{
 		return m_nArrival;
 	}
@@ -96,7 +113,7 @@ public:
 	 * SetTime:
 	 * nTime: Sets the total time for this job
 	 */
-	inline void SetTime(const unsigned int nTime)
+	inline void SetTime(const unsigned long long nTime)
 	{
 		m_nTime = nTime;
 	}
@@ -104,7 +121,7 @@ public:
 	 * GetTime:
 	 * Returns the total time for this job
 	 */
-	inline unsigned int GetTime() const
+	inline unsigned long long GetTime() const
 	{
 		return m_nTime;
 	}
@@ -112,7 +129,7 @@ public:
 	 * SetRunning:
 	 * nRunning: Sets the running time for this job
 	 */
-	inline void SetRunning(const unsigned int nRunning)
+	inline void SetRunning(const unsigned long long nRunning)
 	{
 		m_nRunning = nRunning;
 	}
@@ -120,11 +137,129 @@ public:
 	 * GetRunning:
 	 * Returns the current running time
 	 */
-	inline unsigned int GetRunning() const
+	inline unsigned long long GetRunning() const
 	{
 		return m_nRunning;
 	}
 
+	/**
+	 * SetTickets:
+	 * nTickets: Sets the lottery/stride tickets for this job
+	 */
+	inline void SetTickets(const unsigned int nTickets)
+	{
+		m_nTickets = nTickets;
+	}
+	/**
+	 * GetTickets:
+	 * Returns the lottery/stride tickets for this job
+	 */
+	inline unsigned int GetTickets() const
+	{
+		return m_nTickets;
+	}
+
+	/**
+	 * SetPriority:
+	 * nPriority: Sets the static priority for this job, 0 is the highest
+	 */
+	inline void SetPriority(const unsigned int nPriority)
+	{
+		m_nPriority = nPriority;
+	}
+	/**
+	 * GetPriority:
+	 * Returns the static priority for this job
+	 */
+	inline unsigned int GetPriority() const
+	{
+		return m_nPriority;
+	}
+	/**
+	 * SetGroup:
+	 * csGroup: Sets the fair share group path for this job
+	 */
+	inline void SetGroup(const std::string& csGroup)
+	{
+		m_csGroup = csGroup;
+	}
+	/**
+	 * GetGroup:
+	 * Returns the fair share group path for this job
+	 */
+	inline const std::string& GetGroup() const
+	{
+		return m_csGroup;
+	}
+	/**
+	 * SetCpus:
+	 * nCpus: Sets the number of CPUs the job needs at once
+	 */
+	inline void SetCpus(const unsigned int nCpus)
+	{
+		m_nCpus = nCpus;
+	}
+	/**
+	 * GetCpus:
+	 * Returns the number of CPUs the job needs at once
+	 */
+	inline unsigned int GetCpus() const
+	{
+		return m_nCpus;
+	}
+	/**
+	 * SetEstimate:
+	 * nEstimate: Sets the user runtime estimate for this job, 0 for the burst time
+	 */
+	inline void SetEstimate(const unsigned long long nEstimate)
+	{
+		m_nEstimate = nEstimate;
+	}
+	/**
+	 * GetEstimate:
+	 * Returns the runtime the scheduler plans for, the estimate or else the burst time
+	 */
+	inline unsigned long long GetEstimate() const
+	{
+		return m_nEstimate ? m_nEstimate : m_nBurst;
+	}
+	/**
+	 * GetRemaining:
+	 * Returns the time left in current CPU burst
+	 */
+	inline unsigned long long GetRemaining() const
+	{
+		return m_nBurstEnd - m_nRunning;
+	}
+	/**
+	 * GetWorkLeft:
+	 * Returns the work units left in current CPU burst
+	 */
+	inline unsigned long long GetWorkLeft() const
+	{
+		return (unsigned long long) GetRemaining() * SPEED_ONE - m_nWork;
+	}
+	/**
+	 * IsLastBurst:
+	 * Is current CPU burst the last one?
+	 */
+	inline bool IsLastBurst() const
+	{
+		return m_nPhase + 1 >= m_cBursts.size();
+	}
+	/**
+	 * HasIO:
+	 * Does this job have I/O bursts?
+	 */
+	inline bool HasIO() const
+	{
+		return m_cBursts.size() > 1;
+	}
+	void SetBursts(const std::vector<unsigned long long>& cBursts);	/* Set CPU/I/O burst sequence */
+	unsigned long long NextBurst();	/* Move to next CPU burst, returns the I/O time before it */
+	unsigned long long GetSpan() const;	/* CPU and I/O time of all the bursts */
+	void Progress(unsigned long long nWork);	/* Do work units of current CPU burst */
+
 	/**
 	 * Comparitors for priority_queue
 	 */
@@ -141,14 +276,14 @@ class CSchedular
 {
 public:
 	/* Constructor/Desctuctor */
-	CSchedular(unsigned int nType, unsigned int nTimeQuantum, char* pFileName, unsigned int nJobs, bool bVerbose);
+	CSchedular(unsigned int nType, unsigned long long nTimeQuantum, char* pFileName, unsigned int nJobs, bool bVerbose);
 	~CSchedular() {};
 
 	/**
 	 * SetTime:
 	 * nTime: Set total time for all jobs
 	 */
-	inline void SetTime(unsigned int nTime)
+	inline void SetTime(unsigned long long nTime)
 	{
 		m_nTime = nTime;
 	}
@@ -156,7 +291,7 @@ public:
 	 * GetTime:
 	 * Returns the current time for all the jobs
 	 */
-	inline unsigned int GetTime() const
+	inline unsigned long long GetTime() const
 	{
 		return m_nTime;
 	}
@@ -192,11 +327,241 @@ public:
 	{
 		return m_nType & RAND;
 	}
+	/**
+	 * IsOnline:
+	 * Are we reading jobs from standard input, while simulating?
+	 */
+	inline bool IsOnline() const
+	{
+		return m_nType & ONLINE;
+	}
+	/**
+	 * IsExecute:
+	 * Are we running the jobs as real tasks?
+	 */
+	inline bool IsExecute() const
+	{
+		return m_nType & EXECUTE;
+	}
+	/**
+	 * IsCoroutine:
+	 * Are we running one coroutine per job?
+	 */
+	inline bool IsCoroutine() const
+	{
+		return m_nType & COROUTINE;
+	}
+	/**
+	 * IsCluster:
+	 * Are we routing the jobs to a fleet of nodes?
+	 */
+	inline bool IsCluster() const
+	{
+		return m_nType & CLUSTER;
+	}
+	/**
+	 * IsLottery:
+	 * Is scheduling lottery?
+	 */
+	inline bool IsLottery() const
+	{
+		return m_nType & LOTTERY;
+	}
+	/**
+	 * IsStride:
+	 * Is scheduling stride?
+	 */
+	inline bool IsStride() const
+	{
+		return m_nType & STRIDE;
+	}
+	/**
+	 * IsFairShare:
+	 * Is scheduling hierarchical fair share?
+	 */
+	inline bool IsFairShare() const
+	{
+		return m_nType & FAIRSHARE;
+	}
+	/**
+	 * IsBackfill:
+	 * Is scheduling FCFS with backfilling of gang jobs (EASY or conservative)?
+	 */
+	inline bool IsBackfill() const
+	{
+		return m_nType & (EASY | CONSERVATIVE);
+	}
+	/**
+	 * IsConservative:
+	 * Does every queued job get a reservation, instead of the first one only?
+	 */
+	inline bool IsConservative() const
+	{
+		return m_nType & CONSERVATIVE;
+	}
+	/**
+	 * IsPriority:
+	 * Is scheduling priority (preemptive or not)?
+	 */
+	inline bool IsPriority() const
+	{
+		return m_nType & (PRIORITY | NPRIORITY);
+	}
+	/**
+	 * IsHRRN:
+	 * Is scheduling highest response ratio next?
+	 */
+	inline bool IsHRRN() const
+	{
+		return m_nType & HRRN;
+	}
+	/**
+	 * SetAging:
+	 * nAging: Waiting time to lift a job by one priority level, 0 for no aging
+	 */
+	inline void SetAging(unsigned int nAging)
+	{
+		m_nAging = nAging;
+	}
+	/**
+	 * GetAging:
+	 * Returns waiting time to lift a job by one priority level
+	 */
+	inline unsigned int GetAging() const
+	{
+		return m_nAging;
+	}
+	/**
+	 * SetSeed:
+	 * nSeed: Seed for random jobs and lottery draws
+	 */
+	inline void SetSeed(unsigned int nSeed)
+	{
+		m_nSeed = nSeed;
+	}
+	/**
+	 * GetSeed:
+	 * Returns the seed for random jobs and lottery draws
+	 */
+	inline unsigned int GetSeed() const
+	{
+		return m_nSeed;
+	}
+	/**
+	 * SetGantt:
+	 * pFileName: File for the run slices, "-" for standard output
+	 * bBinary: Binary records instead of text
+	 */
+	inline void SetGantt(char* pFileName, bool bBinary)
+	{
+		m_pGantt = pFileName;
+		m_bBinary = bBinary;
+	}
+	/**
+	 * SetFilter:
+	 * pExpression: Filter for the verbose output (see CEventFilter), NULL for all transitions
+	 */
+	inline void SetFilter(char* pExpression)
+	{
+		m_pFilter = pExpression;
+	}
+	/**
+	 * SetMetrics:
+	 * pFileName: File for the windowed metrics, "-" for standard output
+	 * nWindow: Window width, 0 to pick it from the horizon
+	 */
+	inline void SetMetrics(char* pFileName, unsigned long long nWindow)
+	{
+		m_pMetrics = pFileName;
+		m_nWindow = nWindow;
+	}
+	/**
+	 * SetCache:
+	 * pDirectory: Directory for the results of previous runs, NULL for no cache
+	 * nLimit: Size limit of the cache in bytes, 0 for the default
+	 */
+	inline void SetCache(char* pDirectory, unsigned long long nLimit)
+	{
+		m_pCache = pDirectory;
+		m_nCacheLimit = nLimit;
+	}
+	/**
+	 * SetTrace:
+	 * pFileName: File for the Chrome trace, "-" for standard output
+	 */
+	inline void SetTrace(char* pFileName)
+	{
+		m_pTrace = pFileName;
+	}
+	/**
+	 * SetExecute:
+	 * nUnit: Microseconds of real work per time unit
+	 * nWorkers: Number of worker threads running the tasks
+	 */
+	inline void SetExecute(unsigned int nUnit, unsigned int nWorkers)
+	{
+		m_nUnit = nUnit;
+		m_nWorkers = nWorkers;
+	}
+	/**
+	 * SetCluster:
+	 * nNodes: Number of nodes in the fleet
+	 * nBalance: Load balancing policy of the dispatcher (see _balance_types)
+	 */
+	inline void SetCluster(unsigned int nNodes, int nBalance)
+	{
+		m_nNodes = nNodes;
+		m_nBalance = nBalance;
+	}
+	/**
+	 * SetCpus:
+	 * nCpus: Number of CPUs of the machine, for backfilling
+	 */
+	inline void SetCpus(unsigned int nCpus)
+	{
+		m_nCpus = nCpus;
+	}
+	/**
+	 * SetSpeed:
+	 * pSpeeds: Speed of each CPU or node, "factor[*count],...", NULL for nominal
+	 * pLevels: Frequency levels of every CPU, "time:scale,...[@period]", NULL for none
+	 */
+	inline void SetSpeed(char* pSpeeds, char* pLevels)
+	{
+		m_pSpeeds = pSpeeds;
+		m_pLevels = pLevels;
+	}
+	/**
+	 * SetSwitch:
+	 * pSwitch: Cost of a context switch, "switch[,refill[,decay]]", NULL for free switches
+	 */
+	inline void SetSwitch(char* pSwitch)
+	{
+		m_pSwitch = pSwitch;
+	}
+	/**
+	 * SetTune:
+	 * pTune: Objective of the quantum search, "objective[:max]", NULL for the given quantum
+	 */
+	inline void SetTune(char* pTune)
+	{
+		m_pTune = pTune;
+	}
+	/**
+	 * SetImport:
+	 * bImport: Is the file a Linux scheduler trace?
+	 * nTick: Microseconds of the trace per time unit, 0 for the default
+	 */
+	inline void SetImport(bool bImport, unsigned int nTick)
+	{
+		m_bImport = bImport;
+		m_nTick = nTick ? nTick : 1;
+	}
 	/**
 	 * SetTimeQuantum:
 	 * nTimeQuantum: Set the time quantum for round robin scheduling
 	 */
-	inline void SetTimeQuantum(unsigned int nTimeQuantum)
+	inline void SetTimeQuantum(unsigned long long nTimeQuantum)
 	{
 		m_nTimeQuantum = nTimeQuantum;
 	}
@@ -204,7 +569,7 @@ public:
 	 * GetTimeQuantum:
 	 * Returns the time quantum for round robin scheduling
 	 */
-	inline unsigned int GetTimeQuantum() const
+	inline unsigned long long GetTimeQuantum() const
 	{
 		return m_nTimeQuantum;
 	}
@@ -214,25 +579,102 @@ public:
 	 * Main entry point in class
 	 */
 	int Start();
+	int Load(std::istream& cInput);			/* Read jobs from a stream */
+	int Replay(const std::vector<CJob>& cJobs);	/* Run copies of these jobs, without output */
+
+	/**
+	 * GetJobs:
+	 * Returns the list of jobs
+	 */
+	inline const std::vector<CJob>& GetJobs() const
+	{
+		return m_cList;
+	}
+
+	static int ParseValue(const char* pName, const char* pItem, unsigned long long nMax, unsigned long long& nValue, const char* pStop = "");	/* Parse a number which must fit */
+	static int ParseValue(const char* pName, const char* pItem, unsigned int nMax, unsigned int& nValue, const char* pStop = "");
 
 private:
 	int ReadFile();		/* Read jobs from file */
 	int Random();		/* Create random jobs */
+	int Import();		/* Read jobs from a scheduler trace */
 	int Execute();		/* Execute the scheduling algorithm */
 	void Clear();		/* Clear the data structures */
 	int DisplayJobs();	/* Display the jobs (debugging purpose) */
-	int ExecuteFCFS();	/* Execute the FCFS algorithm */
-	int ExecuteSRJF();	/* Execute the SRJF algorithm */
-	int ExecuteRR();	/* Execute the round robin algorithm */
+	int ExecuteLottery();	/* Execute the lottery algorithm */
+	int ExecuteStride();	/* Execute the stride algorithm */
+	int ExecuteFairShare();	/* Execute the hierarchical fair share algorithm */
+	int ExecutePriority();	/* Execute the priority algorithm */
+	int ExecuteHRRN();	/* Execute the highest response ratio next algorithm */
+	int ExecuteEvents();	/* Execute FCFS, SRJF or round robin on the event driven engine */
+	int Simulate(CReadyQueue& cQueue);	/* Run the event driven engine with this ready queue */
+	int ExecuteTune();	/* Search the round robin time quantum, then run with it */
+	bool IsPlain() const;	/* No I/O bursts, CPU speeds or switch costs? */
+	int DisplayUtilization(unsigned long long nBusy);	/* Display the CPU utilization */
+	int DisplaySwitches(unsigned long long nSwitches, unsigned long long nOverhead, unsigned long long nBusy);	/* Display the context switch overhead */
+	int DisplayResult(const std::vector<bool>* pDone = NULL);	/* Display the termination time of each job */
+	int ParseLine(const std::string& csLine, CJob& cJob);	/* Parse one line of input */
+	int ParseColumn(CJob& cJob, const std::string& csItem);	/* Parse an optional "name=value" column */
+	int ExecuteOnline();	/* Read jobs from standard input and simulate as they arrive */
+	CReadyQueue* CreateQueue(const std::vector<CJob>& cJobs, CRandom& cRandom);	/* Ready queue for the scheduling type */
+	int ExecuteTasks();	/* Run the jobs as real tasks, next to the simulated prediction */
+	int ExecuteCoroutine();	/* Execute the scheduling algorithm with one coroutine per job */
+	int ExecuteCluster();	/* Route the jobs to a fleet of nodes running the scheduling algorithm */
+	int ExecuteBackfill();	/* Execute FCFS with backfilling of gang jobs */
+	/**
+	 * GetSpeed:
+	 * nCpu: CPU or node number
+	 * Returns speed of the CPU, NULL if every CPU is nominal
+	 */
+	inline const CSpeed* GetSpeed(size_t nCpu) const
+	{
+		return m_cSpeeds.empty() ? NULL : &m_cSpeeds[std::min(nCpu, m_cSpeeds.size() - 1)];
+	}
+	/**
+	 * GetSwitch:
+	 * Returns cost of a context switch, NULL if switches are free
+	 */
+	inline const CSwitchCost* GetSwitch() const
+	{
+		return m_pSwitch ? &m_cSwitch : NULL;
+	}
 
 private:
 	unsigned int m_nType;		/* Type of scheduling */
-	unsigned int m_nTime;		/* Total time for jobs */
+	unsigned long long m_nTime;	/* Total time for jobs */
 	char* m_pFileName;		/* File name of file to read data from */
-	std::priority_queue<CJob> m_cQueue;	/* Priority Q, for FCFS, and SRJF */
-	std::queue<CJob> m_cRRQueue;	/* Q for round robin, can't use Priority Q (because Q.top() is constant) */
 	std::vector<CJob> m_cList;	/* List of all jobs */
 	bool m_bVerbose;		/* verbose mode output */
-	unsigned int m_nTimeQuantum;	/* Time quantum for round robin scheduling */
+	unsigned long long m_nTimeQuantum;	/* Time quantum for round robin scheduling */
 	unsigned int m_nJobs;		/* Number of jobs in case of random jobs */
+	unsigned int m_nSeed;		/* Seed for random jobs and lottery draws */
+	unsigned int m_nAging;		/* Waiting time to lift a job by one priority level */
+	CRandom m_cRandom;		/* Random numbers for random jobs and lottery draws */
+	CEventLog m_cLog;		/* Job state transitions, verbose output and Gantt */
+	char* m_pGantt;			/* File for the run slices */
+	bool m_bBinary;			/* Binary Gantt records */
+	char* m_pTrace;			/* File for the Chrome trace */
+	char* m_pFilter;		/* Filter for the verbose output */
+	char* m_pMetrics;		/* File for the windowed metrics */
+	unsigned long long m_nWindow;	/* Width of the metrics windows, 0 for automatic */
+	char* m_pCache;			/* Directory for the results of previous runs */
+	unsigned long long m_nCacheLimit;	/* Size limit of the cache in bytes */
+	unsigned int m_nUnit;		/* Microseconds of real work per time unit */
+	unsigned int m_nWorkers;	/* Number of worker threads for real tasks */
+	unsigned int m_nNodes;		/* Number of nodes in the fleet */
+	int m_nBalance;			/* Load balancing policy of the dispatcher */
+	unsigned int m_nCpus;		/* CPUs of the machine, for backfilling */
+	char* m_pSpeeds;		/* Speed of each CPU or node */
+	char* m_pLevels;		/* Frequency levels of every CPU */
+	std::vector<CSpeed> m_cSpeeds;	/* Speed of each CPU, empty if every CPU is nominal */
+	unsigned long long m_nBusy;	/* Time the CPU was busy, when it has a speed or switches cost */
+	char* m_pSwitch;		/* Cost of a context switch */
+	CSwitchCost m_cSwitch;		/* Cost of a context switch, when it isn't free */
+	unsigned long long m_nSwitches;	/* Context switches of the last run */
+	unsigned long long m_nOverhead;	/* Work units spent on context switches in the last run */
+	bool m_bImport;			/* Is the file a Linux scheduler trace? */
+	unsigned int m_nTick;		/* Microseconds of the trace per time unit */
+	char* m_pTune;			/* Objective of the quantum search */
+	int m_nTuneObjective;		/* Objective of the quantum search (see _tune_objectives) */
+	unsigned long long m_nTuneMax;	/* Largest quantum to try, 0 to find it from the jobs */
 };
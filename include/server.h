@@ -0,0 +1,66 @@
+
+#pragma once
+
+/**
+ * Header file
+ */
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "schedular.h"
+
+#define FRAME_MAX (16 << 20)		/* Largest request/response frame */
+
+/**
+ * CServer class
+ *
+ * Simulation daemon on a UNIX domain socket
+ * Named workloads stay loaded, so each request only pays for the simulation
+ *
+ * Frame: 4 byte length (network byte order), then the payload
+ * Requests, one per frame:
+ *     LOAD name path          read a workload from a file
+ *     PUT name\n<lines>       workload sent in the request, one job per line
+ *     RUN name options        simulate, options as on the command line (-R 4, -S, -L 2 -s 7, -G 4 ...)
+ *     DROP name               forget a workload
+ *     LIST                    loaded workloads and their number of jobs
+ * Response: "OK\n" followed by the result, or "ERR message"
+ */
+class CServer
+{
+	typedef std::shared_ptr<const std::vector<CJob> > CWorkload;	/* jobs, never changed once loaded */
+
+public:
+	/* Constructor/Destructor */
+	CServer(const char* pSocket, unsigned int nWorkers);
+	~CServer();
+
+	int Run();		/* Accept and serve connections, doesn't return unless there is an error */
+
+private:
+	void Worker();						/* Serve connections from the pool */
+	void Serve(int nSocket);				/* Serve all requests of one connection */
+	int Request(const std::string& csRequest, std::string& csResponse);	/* Handle one request */
+	int Simulate(const std::string& csName, const std::string& csOptions, std::string& csResponse);
+	int Store(const std::string& csName, std::istream& cInput, std::string& csResponse);
+	static int Number(std::istream& cOptions, const std::string& csOption, unsigned int nMin, unsigned int& nValue, std::string& csResponse);	/* Value of an option */
+	bool ReadFrame(int nSocket, std::string& csFrame);	/* Read one frame */
+	bool WriteFrame(int nSocket, const std::string& csFrame);	/* Write one frame */
+
+private:
+	std::string m_csSocket;				/* Socket path */
+	unsigned int m_nWorkers;			/* Number of worker threads */
+	int m_nListen;					/* Listening socket */
+	std::map<std::string, CWorkload> m_cWorkloads;	/* Loaded workloads by name */
+	std::mutex m_cLock;				/* Protects m_cWorkloads */
+	std::deque<int> m_cPending;			/* Accepted connections waiting for a worker */
+	std::mutex m_cPendingLock;			/* Protects m_cPending */
+	std::condition_variable m_cPendingCond;		/* Signals a new connection */
+	std::vector<std::thread> m_cThreads;		/* Worker pool */
+};
@@ -0,0 +1,96 @@
+
+#pragma once
+
+/**
+ * Header file
+ */
+#include <vector>
+
+/**
+ * CSpeed class
+ *
+ * Speed of one CPU over time, in work units per time unit (SPEED_ONE is nominal)
+ * A base speed, e.g. a big or a little core, scaled by frequency levels (DVFS):
+ * each level holds from its time up to the next one, the last one holds forever,
+ * or the levels repeat every period. Speed only changes at whole time units,
+ * so the work done over a time range, and the time a job needs to finish
+ * its work, are exact.
+ */
+class CSpeed
+{
+	/**
+	 * CLevel structure
+	 *
+	 * One frequency level
+	 */
+	struct CLevel {
+		unsigned long long nTime;	/* Time the level starts, within the period */
+		unsigned int nScale;		/* Frequency scale, SPEED_ONE is nominal */
+		unsigned int nRate;		/* Work units per time unit, base speed times scale */
+		unsigned long long nWork;	/* Work units from the period start to this level */
+	};
+
+public:
+	/* Constructor/Destructor */
+	CSpeed();
+	~CSpeed() {};
+
+	/**
+	 * GetBase:
+	 * Returns the speed without frequency scaling
+	 */
+	inline unsigned int GetBase() const
+	{
+		return m_nBase;
+	}
+
+	static int Factor(const char* pText, unsigned int& nSpeed);	/* "1.5" is 1.5 * SPEED_ONE */
+	static int Build(const char* pSpeeds, const char* pLevels, std::vector<CSpeed>& cSpeeds);	/* One speed per CPU */
+	void SetBase(unsigned int nBase);	/* Speed of the core */
+	int SetLevels(const char* pLevels);	/* Frequency levels, "time:scale,...[@period]" */
+	unsigned long long Work(unsigned long long nFrom, unsigned long long nTo) const;	/* Work units done in [from, to) */
+	unsigned long long Reach(unsigned long long nFrom, unsigned long long nWork) const;	/* Time this work is done, ULLONG_MAX if never */
+
+private:
+	void Prepare();				/* Rate and work of each level */
+	unsigned long long Done(unsigned long long nTime) const;	/* Work units done in [0, time) */
+	unsigned long long Need(unsigned long long nWork) const;	/* First time this work is done since 0 */
+
+private:
+	unsigned int m_nBase;			/* Speed of the core */
+	std::vector<CLevel> m_cLevels;		/* Frequency levels by time, the first one at 0 */
+	unsigned long long m_nPeriod;		/* The levels repeat every period, 0 if they don't */
+	unsigned long long m_nPeriodWork;	/* Work units done in one period */
+};
+
+/**
+ * CSwitchCost class
+ *
+ * Cost of putting a job on a CPU which last ran another job, in work units:
+ * a fixed context switch overhead, plus refilling the job's cache, which
+ * cools down while the job is off the CPU: refill * (1 - exp(-off / decay))
+ * A job which never ran has a cold cache, a decay of 0 makes every cache cold
+ */
+class CSwitchCost
+{
+public:
+	/* Constructor/Destructor */
+	CSwitchCost();
+	~CSwitchCost() {};
+
+	int Parse(const char* pCost);		/* "switch[,refill[,decay]]", in time units */
+	unsigned long long Cost(unsigned long long nOff) const;	/* Work units to switch to a job off the CPU for this time */
+	/**
+	 * IsFree:
+	 * Returns true if no switch costs anything
+	 */
+	inline bool IsFree() const
+	{
+		return m_nSwitch == 0 && m_nRefill == 0;
+	}
+
+private:
+	unsigned long long m_nSwitch;		/* Context switch overhead, in work units */
+	unsigned long long m_nRefill;		/* Refill of a cold cache, in work units */
+	double m_dDecay;			/* Time for the cache to cool down by 1/e, 0 if always cold */
+};
@@ -0,0 +1,214 @@
+
+#pragma once
+
+/**
+ * Header file
+ */
+#include <atomic>
+#include <stdio.h>
+#include <stdint.h>
+
+/**
+ * Phases of a run, time is given to one phase at a time
+ */
+enum _stat_phases {
+	PHASE_READ = 0,		/* reading or creating the jobs */
+	PHASE_EXECUTE,		/* scheduling algorithm, verbose output included */
+	PHASE_OUTPUT,		/* results, utilization and sinks flush */
+	PHASE_MAX
+};
+
+/**
+ * Counters of the scheduling loops
+ */
+enum _stat_counters {
+	STAT_PUSH = 0,		/* ready queue pushes */
+	STAT_POP,		/* ready queue pops */
+	STAT_ROTATION,		/* quantum expired, job went back to the ready queue */
+	STAT_PREEMPTION,	/* running job preempted by a better READY job */
+	STAT_TICK,		/* simulated time units stepped */
+	STAT_EVENT,		/* events processed by the event driven engine */
+	STAT_WINDOW,		/* windows of the fleet's threads, each one a barrier */
+	STAT_MAX
+};
+
+/**
+ * Hardware counters, read with perf_event_open if the kernel permits
+ */
+enum _perf_counters {
+	PERF_CYCLES = 0,
+	PERF_CACHE_MISSES,
+	PERF_MAX
+};
+
+/**
+ * CStats class
+ *
+ * Always compiled instrumentation, one instance per thread (g_cStats)
+ * Counters are plain increments, timers read the monotonic clock
+ * only when the phase changes, so the scheduling loops pay one add per count
+ * Constant initialized and trivially destructible, so the thread local
+ * instance needs no initialization guard on each access
+ */
+class CStats
+{
+public:
+	/* Constructor */
+	constexpr CStats() : m_nCounter(), m_nPhaseTime(), m_nPhasePerf(), m_nSample(), m_nPerf(), m_nPhase(-1) {};
+
+	/**
+	 * Count:
+	 * nCounter: Counter to increment (see _stat_counters)
+	 * nValue: Increment
+	 */
+	inline void Count(int nCounter, uint64_t nValue = 1)
+	{
+		m_nCounter[nCounter] += nValue;
+	}
+	/**
+	 * Get:
+	 * nCounter: Counter to read (see _stat_counters)
+	 */
+	inline uint64_t Get(int nCounter) const
+	{
+		return m_nCounter[nCounter];
+	}
+	/**
+	 * GetPhase:
+	 * Returns phase time is given to
+	 */
+	inline int GetPhase() const
+	{
+		return m_nPhase;
+	}
+
+	void EnablePerf();			/* Open the hardware counters, if permitted */
+	void Switch(int nPhase);		/* Give time to another phase, -1 for none */
+	void Dump(FILE* pFile, bool bJson);	/* Write the timers and counters */
+
+private:
+	void Sample(uint64_t* pSample) const;	/* Read the clock and the hardware counters */
+
+private:
+	uint64_t m_nCounter[STAT_MAX];		/* Loop counters */
+	uint64_t m_nPhaseTime[PHASE_MAX];	/* Nanoseconds in each phase */
+	uint64_t m_nPhasePerf[PHASE_MAX][PERF_MAX];	/* Hardware counters in each phase */
+	uint64_t m_nSample[1 + PERF_MAX];	/* Clock and hardware counters at last switch */
+	int m_nPerf[PERF_MAX];			/* perf_event_open descriptors + 1, 0 if not available */
+	int m_nPhase;				/* Current phase, -1 if none */
+};
+
+extern thread_local CStats g_cStats;	/* Statistics of the running thread */
+
+/**
+ * CPhase class
+ *
+ * Give time to a phase for the life of the object, then back to the previous phase
+ */
+class CPhase
+{
+	int m_nPrevious;
+
+public:
+	CPhase(int nPhase) : m_nPrevious(g_cStats.GetPhase())
+	{
+		g_cStats.Switch(nPhase);
+	}
+	~CPhase()
+	{
+		g_cStats.Switch(m_nPrevious);
+	}
+};
+
+/**
+ * Requests of the signals to the running simulation
+ */
+enum _progress_flags {
+	PROGRESS_REPORT = 0x1,	/* SIGUSR1, write the progress */
+	PROGRESS_STOP = 0x2,	/* SIGINT or SIGTERM, stop at the next event */
+};
+
+/**
+ * CProgress class
+ *
+ * Progress of the simulation loop, and stop requests, driven by signals
+ * The signal handler only sets a flag. The loop which is watched (see
+ * CProgressWatch) loads the flag once per event, and only when it is set
+ * does it count its jobs done and events, write the progress, or stop
+ * and let the run flush the results so far. A stop signal while no loop
+ * is watched, or a second one, has its default action.
+ */
+class CProgress
+{
+public:
+	/* Constructor */
+	constexpr CProgress() : m_nFlags(0), m_nSignal(0), m_bWatched(false), m_nJobs(0), m_nEvents(0), m_nStart(0) {};
+
+	/**
+	 * Pending:
+	 * Did a signal ask for something?
+	 */
+	inline bool Pending() const
+	{
+		return m_nFlags.load(std::memory_order_relaxed) != 0;
+	}
+	/**
+	 * Stopped:
+	 * Was the simulation stopped by a signal?
+	 */
+	inline bool Stopped() const
+	{
+		return (m_nFlags.load() & PROGRESS_STOP) != 0;
+	}
+	/**
+	 * GetSignal:
+	 * Returns the signal which stopped the simulation
+	 */
+	inline int GetSignal() const
+	{
+		return m_nSignal.load();
+	}
+
+	/**
+	 * TakeReport:
+	 * Returns true if the progress was asked, the caller writes it
+	 * For the loops whose progress isn't jobs and events
+	 */
+	inline bool TakeReport()
+	{
+		return (m_nFlags.fetch_and(~PROGRESS_REPORT) & PROGRESS_REPORT) != 0;
+	}
+
+	static void Signal(int nSignal);	/* Signal handler */
+	void Begin(unsigned long long nJobs, unsigned long long nEvents);	/* A loop is watched from now */
+	void End();				/* No loop is watched */
+	bool Poll(unsigned long long nTime, unsigned long long nDone, unsigned long long nEvents);	/* Serve the requests, true to stop */
+
+private:
+	std::atomic<int> m_nFlags;		/* Requests (see _progress_flags) */
+	std::atomic<int> m_nSignal;		/* Signal which asked to stop */
+	std::atomic<bool> m_bWatched;		/* Is a loop polling the requests? */
+	unsigned long long m_nJobs;		/* Jobs of the watched loop */
+	unsigned long long m_nEvents;		/* Events of the thread when the loop started */
+	uint64_t m_nStart;			/* Monotonic time the loop started, in ns */
+};
+
+extern CProgress g_cProgress;		/* Progress of the simulation */
+
+/**
+ * CProgressWatch class
+ *
+ * Watch a simulation loop for the life of the object
+ */
+class CProgressWatch
+{
+public:
+	CProgressWatch(unsigned long long nJobs, unsigned long long nEvents)
+	{
+		g_cProgress.Begin(nJobs, nEvents);
+	}
+	~CProgressWatch()
+	{
+		g_cProgress.End();
+	}
+};
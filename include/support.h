@@ -33,6 +33,9 @@
 #ifdef HAVE_SYS_WAIT_H
 #include <sys/wait.h>
 #endif
+#ifdef HAVE_TIME_H
+#include <time.h>
+#endif
 
 enum _err_codes {
 	ERR_SUCCESS = 0,
@@ -43,7 +46,25 @@ enum _sched_types {
 	SRJF = 0x02,
 	FIFO = 0x04,
 	RAND = 0x08,
+	LOTTERY = 0x10,
+	STRIDE = 0x20,
+	PRIORITY = 0x40,	/* preemptive */
+	NPRIORITY = 0x80,	/* non-preemptive */
+	HRRN = 0x100,
+	ONLINE = 0x200,
+	EXECUTE = 0x400,	/* real tasks on worker threads */
+	COROUTINE = 0x800,	/* one coroutine per job */
+	FAIRSHARE = 0x1000,	/* hierarchical fair share */
+	CLUSTER = 0x2000,	/* fleet of nodes behind a dispatcher */
+	EASY = 0x4000,		/* FCFS with EASY backfilling of gang jobs */
+	CONSERVATIVE = 0x8000,	/* FCFS with conservative backfilling of gang jobs */
 };
 
+#define PRIO_LEVELS 64		/* Priority levels, 0 is the highest */
+#define SPEED_ONE 1000		/* Work units a nominal CPU does per time unit */
+#define TIME_MAX 0x7ffffffffffULL	/* Latest simulated time, 2^43 - 1, times are unsigned long long */
+#define JOB_MAX 0x7fffffffU	/* Largest job number, job numbers are printed as int */
+#define TICKETS_MAX (1U << 20)	/* Most tickets of a job or weight of a group, a stride of 1 */
+
 #define test_and_out(a) if (a) goto out;
 #define test_and_exit(a) if (a < 0) goto err_exit;
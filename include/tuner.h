@@ -0,0 +1,143 @@
+
+#pragma once
+
+/**
+ * Header file
+ */
+#include <exception>
+#include <map>
+#include <mutex>
+#include <vector>
+
+#include "engine.h"
+#include "queues.h"
+
+/**
+ * Objectives of the quantum search
+ */
+enum _tune_objectives {
+	TUNE_MEAN = 0,		/* mean turnaround */
+	TUNE_P99,		/* 99th percentile turnaround, nearest rank */
+	TUNE_RESPONSE,		/* mean response, arrival to first dispatch */
+	TUNE_MAX
+};
+
+#define TUNE_POINTS 8		/* Candidates per round of the search */
+#define TUNE_CHECK 1024		/* Fewest engine events between two bound checks */
+
+/**
+ * CFirstQueue class
+ *
+ * Round robin ready queue which notes the time each job is first dispatched
+ */
+class CFirstQueue : public CFifoQueue
+{
+public:
+	/* Constructor/Destructor */
+	CFirstQueue(size_t nJobs) : m_cFirst(nJobs, ULLONG_MAX) {};
+	~CFirstQueue() {};
+
+	inline size_t Pop()
+	{
+		size_t nIndex = CFifoQueue::Pop();
+		if (m_cFirst[nIndex] == ULLONG_MAX)
+			m_cFirst[nIndex] = m_nTime;
+		return nIndex;
+	}
+	/**
+	 * GetFirst:
+	 * nIndex: Job index in the list
+	 * Returns the time the job was first dispatched, ULLONG_MAX if it wasn't
+	 */
+	inline unsigned long long GetFirst(size_t nIndex) const
+	{
+		return m_cFirst[nIndex];
+	}
+
+private:
+	std::vector<unsigned long long> m_cFirst;	/* First dispatch of each job */
+};
+
+/**
+ * CQuantumTuner class
+ *
+ * Search of the round robin time quantum which minimizes an objective
+ * Coarse to fine: a geometric grid over [1, max] first, then evenly spaced
+ * quanta between the neighbours of the best one, until they are adjacent.
+ * The candidates of a round run in parallel, each on its own copy of the jobs.
+ * A candidate is abandoned as soon as a lower bound of its objective, from
+ * the jobs done and the time the others have already waited, can't beat
+ * the best one so far, so most candidates cost a fraction of a run.
+ * Ties go to the smaller quantum, which makes the result independent of
+ * the threads: a candidate is only abandoned if it can't win.
+ */
+class CQuantumTuner
+{
+public:
+	/* Constructor/Destructor */
+	CQuantumTuner(const std::vector<CJob>& cJobs, int nObjective, unsigned int nWorkers);
+	~CQuantumTuner() {};
+
+	/**
+	 * SetSpeed:
+	 * pSpeed: Speed of the CPU, NULL for one burst unit per time unit
+	 */
+	inline void SetSpeed(const CSpeed* pSpeed)
+	{
+		m_pSpeed = pSpeed;
+	}
+	/**
+	 * SetCost:
+	 * pCost: Cost of a context switch, NULL for free switches
+	 */
+	inline void SetCost(const CSwitchCost* pCost)
+	{
+		m_pCost = pCost;
+	}
+	/**
+	 * GetRuns:
+	 * Returns number of candidates run to the end
+	 */
+	inline size_t GetRuns() const
+	{
+		return m_cResults.size() - m_nAbandoned;
+	}
+	/**
+	 * GetAbandoned:
+	 * Returns number of candidates abandoned
+	 */
+	inline size_t GetAbandoned() const
+	{
+		return m_nAbandoned;
+	}
+
+	static int Parse(const char* pTune, int& nObjective, unsigned long long& nMax);	/* "objective[:max]" */
+	static const char* ObjectiveName(int nObjective);	/* Name of the objective */
+	unsigned long long Limit() const;	/* Smallest quantum no burst ever uses up */
+	unsigned long long Tune(unsigned long long nMax);	/* Best quantum in [1, max], ULLONG_MAX if stopped before any */
+	double Value(unsigned long long nValue) const;	/* Objective from its total */
+
+private:
+	void Round(const std::vector<unsigned long long>& cCandidates);	/* Run the candidates in parallel */
+	void Worker();				/* Run candidates until none is left */
+	unsigned long long Evaluate(unsigned long long nQuantum, unsigned long long& nAbandon);	/* Objective of a quantum */
+	unsigned long long Bound(const std::vector<CJob>& cJobs, const CFirstQueue& cQueue, unsigned long long nTime, std::vector<unsigned long long>& cValues) const;	/* Lower bound of the objective */
+	bool Beats(unsigned long long nValue, unsigned long long nQuantum);	/* Could this still be the best? */
+	void Progress(unsigned long long nQuantum, unsigned long long nTime, size_t nDone);	/* Write the progress of the search */
+
+private:
+	const std::vector<CJob>& m_cJobs;	/* Jobs, never changed */
+	int m_nObjective;			/* Objective (see _tune_objectives) */
+	unsigned int m_nWorkers;		/* Candidates run at once */
+	const CSpeed* m_pSpeed;			/* Speed of the CPU, NULL if nominal */
+	const CSwitchCost* m_pCost;		/* Cost of a context switch, NULL if free */
+	size_t m_nCheck;			/* Engine events between two bound checks */
+	std::mutex m_cLock;			/* Protects the fields below */
+	std::vector<unsigned long long> m_cRound;	/* Candidates of the round */
+	size_t m_nNext;				/* Next candidate of the round to run */
+	unsigned long long m_nBest;		/* Objective of the best candidate, ULLONG_MAX if none */
+	unsigned long long m_nBestQuantum;	/* Best candidate */
+	std::map<unsigned long long, unsigned long long> m_cResults;	/* Objective of each candidate run, ULLONG_MAX if abandoned */
+	size_t m_nAbandoned;			/* Candidates abandoned */
+	std::exception_ptr m_pFailure;		/* First error of a candidate */
+};
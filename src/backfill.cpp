@@ -0,0 +1,703 @@
+/**
+ * Header files
+ */
+#include <algorithm>
+
+#include "support.h"
+#include "log.h"
+#include "backfill.h"
+#include "stats.h"
+
+/**
+ * Constructor
+ *
+ * All CPUs are free from time 0 on
+ */
+CProfile::CProfile(unsigned int nCpus)
+{
+	m_cNodes.resize(1);			/* empty tree, neutral for min and max */
+	m_cNodes[0].nTime = 0;
+	m_cNodes[0].nFree = 0;
+	m_cNodes[0].nMin = INT_MAX;
+	m_cNodes[0].nMax = INT_MIN;
+	m_cNodes[0].nAdd = 0;
+	m_cNodes[0].nPriority = 0;
+	m_cNodes[0].nLeft = 0;
+	m_cNodes[0].nRight = 0;
+	m_nRoot = Create(0, nCpus);
+}
+
+/**
+ * Create:
+ * nTime: Time the value starts
+ * nFree: Free CPUs from then on
+ *
+ * Returns the new breakpoint, not in the tree yet
+ */
+unsigned int CProfile::Create(unsigned long long nTime, int nFree)
+{
+	unsigned int nNode;
+	if (m_cSpare.empty()) {
+		nNode = m_cNodes.size();
+		m_cNodes.resize(nNode + 1);
+	}
+	else {
+		nNode = m_cSpare.back();
+		m_cSpare.pop_back();
+	}
+	CNode& cNode = m_cNodes[nNode];
+	cNode.nTime = nTime;
+	cNode.nFree = nFree;
+	cNode.nMin = nFree;
+	cNode.nMax = nFree;
+	cNode.nAdd = 0;
+	cNode.nPriority = (uint32_t) m_cRandom.Next();
+	cNode.nLeft = 0;
+	cNode.nRight = 0;
+	return nNode;
+}
+
+/**
+ * Release:
+ * nNode: Subtree no longer needed
+ */
+void CProfile::Release(unsigned int nNode)
+{
+	if (nNode == 0)
+		return;
+	Release(m_cNodes[nNode].nLeft);
+	Release(m_cNodes[nNode].nRight);
+	m_cSpare.push_back(nNode);
+}
+
+/**
+ * Apply:
+ * nNode: Subtree
+ * nAdd: CPUs to add to each of its values
+ */
+void CProfile::Apply(unsigned int nNode, int nAdd)
+{
+	if (nNode == 0)
+		return;
+	CNode& cNode = m_cNodes[nNode];
+	cNode.nFree += nAdd;
+	cNode.nMin += nAdd;
+	cNode.nMax += nAdd;
+	cNode.nAdd += nAdd;
+}
+
+/**
+ * Push:
+ * nNode: Node about to be visited or changed
+ */
+void CProfile::Push(unsigned int nNode)
+{
+	CNode& cNode = m_cNodes[nNode];
+	if (cNode.nAdd) {
+		Apply(cNode.nLeft, cNode.nAdd);
+		Apply(cNode.nRight, cNode.nAdd);
+		cNode.nAdd = 0;
+	}
+}
+
+/**
+ * Pull:
+ * nNode: Node whose children changed
+ */
+void CProfile::Pull(unsigned int nNode)
+{
+	CNode& cNode = m_cNodes[nNode];
+	const CNode& cLeft = m_cNodes[cNode.nLeft];
+	const CNode& cRight = m_cNodes[cNode.nRight];
+	cNode.nMin = std::min(cNode.nFree, std::min(cLeft.nMin, cRight.nMin));
+	cNode.nMax = std::max(cNode.nFree, std::max(cLeft.nMax, cRight.nMax));
+}
+
+/**
+ * Split:
+ * nNode: Tree
+ * nTime: Split time
+ * nLeft: Breakpoints before the time
+ * nRight: Breakpoints from the time on
+ */
+void CProfile::Split(unsigned int nNode, unsigned long long nTime, unsigned int& nLeft, unsigned int& nRight)
+{
+	if (nNode == 0) {
+		nLeft = nRight = 0;
+		return;
+	}
+	Push(nNode);
+	unsigned int nFirst, nSecond;
+	if (m_cNodes[nNode].nTime < nTime) {
+		Split(m_cNodes[nNode].nRight, nTime, nFirst, nSecond);
+		m_cNodes[nNode].nRight = nFirst;
+		nLeft = nNode;
+		nRight = nSecond;
+	}
+	else {
+		Split(m_cNodes[nNode].nLeft, nTime, nFirst, nSecond);
+		m_cNodes[nNode].nLeft = nSecond;
+		nLeft = nFirst;
+		nRight = nNode;
+	}
+	Pull(nNode);
+}
+
+/**
+ * Merge:
+ * nLeft: Earlier tree
+ * nRight: Later tree
+ *
+ * Returns the joined tree
+ */
+unsigned int CProfile::Merge(unsigned int nLeft, unsigned int nRight)
+{
+	if (nLeft == 0)
+		return nRight;
+	if (nRight == 0)
+		return nLeft;
+	if (m_cNodes[nLeft].nPriority > m_cNodes[nRight].nPriority) {
+		Push(nLeft);
+		m_cNodes[nLeft].nRight = Merge(m_cNodes[nLeft].nRight, nRight);
+		Pull(nLeft);
+		return nLeft;
+	}
+	Push(nRight);
+	m_cNodes[nRight].nLeft = Merge(nLeft, m_cNodes[nRight].nLeft);
+	Pull(nRight);
+	return nRight;
+}
+
+/**
+ * Segment:
+ * nTime: Time
+ *
+ * Returns the last breakpoint at or before the time, 0 if none
+ */
+unsigned int CProfile::Segment(unsigned long long nTime)
+{
+	unsigned int nFound = 0;
+	unsigned int nNode = m_nRoot;
+	while (nNode) {
+		Push(nNode);
+		if (m_cNodes[nNode].nTime <= nTime) {
+			nFound = nNode;
+			nNode = m_cNodes[nNode].nRight;
+		}
+		else
+			nNode = m_cNodes[nNode].nLeft;
+	}
+	return nFound;
+}
+
+/**
+ * Free:
+ * nTime: Time
+ *
+ * Returns free CPUs at this time
+ */
+int CProfile::Free(unsigned long long nTime)
+{
+	return m_cNodes[Segment(nTime)].nFree;
+}
+
+/**
+ * Ensure:
+ * nTime: Time
+ *
+ * Split the segment holding this time, so a breakpoint starts at it
+ */
+void CProfile::Ensure(unsigned long long nTime)
+{
+	unsigned int nSegment = Segment(nTime);
+	if (nSegment && m_cNodes[nSegment].nTime == nTime)
+		return;
+	int nFree = m_cNodes[nSegment].nFree;
+	unsigned int nLeft, nRight;
+	Split(m_nRoot, nTime, nLeft, nRight);
+	m_nRoot = Merge(Merge(nLeft, Create(nTime, nFree)), nRight);
+}
+
+/**
+ * Add:
+ * nStart: First time
+ * nEnd: End time, not included
+ * nCpus: CPUs to add, negative to take them
+ */
+void CProfile::Add(unsigned long long nStart, unsigned long long nEnd, int nCpus)
+{
+	if (nStart >= nEnd)
+		return;
+	Ensure(nStart);
+	Ensure(nEnd);
+	unsigned int nLeft, nMiddle, nRight;
+	Split(m_nRoot, nStart, nLeft, nRight);
+	Split(nRight, nEnd, nMiddle, nRight);
+	Apply(nMiddle, nCpus);
+	m_nRoot = Merge(Merge(nLeft, nMiddle), nRight);
+}
+
+/**
+ * Trim:
+ * nTime: Current time
+ *
+ * Breakpoints before the current time are never read again
+ */
+void CProfile::Trim(unsigned long long nTime)
+{
+	Ensure(nTime);
+	unsigned int nLeft, nRight;
+	Split(m_nRoot, nTime, nLeft, nRight);
+	Release(nLeft);
+	m_nRoot = nRight;
+}
+
+/**
+ * Below:
+ * nNode: Subtree
+ * nFrom: Earliest time
+ * nCpus: CPUs needed
+ *
+ * Returns the first breakpoint from this time with fewer CPUs free, 0 if none
+ * Subtrees with enough CPUs everywhere are skipped
+ */
+unsigned int CProfile::Below(unsigned int nNode, unsigned long long nFrom, int nCpus)
+{
+	if (nNode == 0 || m_cNodes[nNode].nMin >= nCpus)
+		return 0;
+	Push(nNode);
+	if (m_cNodes[nNode].nTime >= nFrom) {
+		unsigned int nFound = Below(m_cNodes[nNode].nLeft, nFrom, nCpus);
+		if (nFound)
+			return nFound;
+		if (m_cNodes[nNode].nFree < nCpus)
+			return nNode;
+	}
+	return Below(m_cNodes[nNode].nRight, nFrom, nCpus);
+}
+
+/**
+ * AtLeast:
+ * nNode: Subtree
+ * nAfter: Time
+ * nCpus: CPUs needed
+ *
+ * Returns the first breakpoint after this time with enough CPUs free, 0 if none
+ */
+unsigned int CProfile::AtLeast(unsigned int nNode, unsigned long long nAfter, int nCpus)
+{
+	if (nNode == 0 || m_cNodes[nNode].nMax < nCpus)
+		return 0;
+	Push(nNode);
+	if (m_cNodes[nNode].nTime > nAfter) {
+		unsigned int nFound = AtLeast(m_cNodes[nNode].nLeft, nAfter, nCpus);
+		if (nFound)
+			return nFound;
+		if (m_cNodes[nNode].nFree >= nCpus)
+			return nNode;
+	}
+	return AtLeast(m_cNodes[nNode].nRight, nAfter, nCpus);
+}
+
+/**
+ * Fits:
+ * nTime: Start time
+ * nLength: Runtime
+ * nCpus: CPUs needed
+ *
+ * Are there nCpus free CPUs from nTime, for nLength?
+ */
+bool CProfile::Fits(unsigned long long nTime, unsigned long long nLength, unsigned int nCpus)
+{
+	if (nLength == 0)
+		return true;
+	unsigned int nBlock = Below(m_nRoot, m_cNodes[Segment(nTime)].nTime, nCpus);
+	return nBlock == 0 || m_cNodes[nBlock].nTime >= nTime + nLength;
+}
+
+/**
+ * Fit:
+ * nTime: Earliest start time
+ * nLength: Runtime
+ * nCpus: CPUs needed
+ *
+ * Returns the earliest start time from nTime, ULLONG_MAX if the job never fits
+ */
+unsigned long long CProfile::Fit(unsigned long long nTime, unsigned long long nLength, unsigned int nCpus)
+{
+	while (!Fits(nTime, nLength, nCpus)) {
+		unsigned int nBlock = Below(m_nRoot, m_cNodes[Segment(nTime)].nTime, nCpus);
+		unsigned int nNext = AtLeast(m_nRoot, m_cNodes[nBlock].nTime, nCpus);
+		if (nNext == 0)
+			return ULLONG_MAX;
+		nTime = m_cNodes[nNext].nTime;	/* next time enough CPUs are free */
+	}
+	return nTime;
+}
+
+/**
+ * Constructor
+ * nSize: Number of ranks
+ */
+CWaitIndex::CWaitIndex(size_t nSize)
+{
+	for (m_nLeaves = 1; m_nLeaves < nSize; m_nLeaves <<= 1)
+		;
+	m_cTree.assign(2 * m_nLeaves, UINT_MAX);
+}
+
+/**
+ * Set:
+ * nRank: Arrival rank of the job
+ * nCpus: CPUs the job needs
+ */
+void CWaitIndex::Set(size_t nRank, unsigned int nCpus)
+{
+	size_t nNode = m_nLeaves + nRank;
+	m_cTree[nNode] = nCpus;
+	for (nNode >>= 1; nNode; nNode >>= 1)
+		m_cTree[nNode] = std::min(m_cTree[2 * nNode], m_cTree[2 * nNode + 1]);
+}
+
+/**
+ * Clear:
+ * nRank: Arrival rank of the job
+ */
+void CWaitIndex::Clear(size_t nRank)
+{
+	Set(nRank, UINT_MAX);
+}
+
+/**
+ * Find:
+ * nNode: Tree node, holding ranks [nLow, nHigh)
+ * nFrom: First rank
+ * nCpus: Most CPUs
+ *
+ * Returns the first queued rank from nFrom in this node needing at most nCpus, NO_JOB if none
+ */
+size_t CWaitIndex::Find(size_t nNode, size_t nLow, size_t nHigh, size_t nFrom, unsigned int nCpus) const
+{
+	if (nHigh <= nFrom || m_cTree[nNode] > nCpus)
+		return NO_JOB;
+	if (nNode >= m_nLeaves)
+		return nLow;
+	size_t nMiddle = (nLow + nHigh) / 2;
+	size_t nFound = Find(2 * nNode, nLow, nMiddle, nFrom, nCpus);
+	if (nFound != NO_JOB)
+		return nFound;
+	return Find(2 * nNode + 1, nMiddle, nHigh, nFrom, nCpus);
+}
+
+/**
+ * First:
+ * nFrom: First rank
+ * nCpus: Most CPUs
+ *
+ * Returns the first queued rank from nFrom needing at most nCpus, NO_JOB if none
+ */
+size_t CWaitIndex::First(size_t nFrom, unsigned int nCpus) const
+{
+	return Find(1, 0, m_nLeaves, nFrom, nCpus);
+}
+
+/**
+ * Constructor
+ */
+CBackfill::CBackfill(std::vector<CJob>& cJobs, unsigned int nCpus, bool bConservative, CEventLog& cLog)
+	: m_cJobs(cJobs), m_cLog(cLog), m_cProfile(nCpus), m_cWaiting(cJobs.size()),
+	m_cOrder(cJobs.size()), m_cRank(cJobs.size()), m_cStart(cJobs.size(), 0), m_cHeld(cJobs.size()),
+	m_cDone(cJobs.size(), false)
+{
+	m_nCpus = nCpus;
+	m_bConservative = bConservative;
+	m_nNext = 0;
+	m_nTime = 0;
+	m_bEarly = false;
+	m_nDone = 0;
+	for (unsigned int nCpu = nCpus; nCpu > 0; -- nCpu)
+		m_cIdle.push_back(nCpu - 1);	/* CPU 0 on top */
+	for (size_t nIndex = 0; nIndex < m_cOrder.size(); ++ nIndex)
+		m_cOrder[nIndex] = nIndex;
+	std::stable_sort(m_cOrder.begin(), m_cOrder.end(), CArrivalOrder(m_cJobs));
+	for (size_t nRank = 0; nRank < m_cOrder.size(); ++ nRank)
+		m_cRank[m_cOrder[nRank]] = nRank;
+}
+
+/**
+ * NextEvent:
+ *
+ * Returns time of the next arrival, termination or reservation, ULLONG_MAX if none
+ */
+unsigned long long CBackfill::NextEvent()
+{
+	unsigned long long nEvent = ULLONG_MAX;
+	if (m_nNext < m_cOrder.size())
+		nEvent = m_cJobs[m_cOrder[m_nNext]].GetArrival();
+	if (!m_cRunning.empty() && m_cRunning.top().first < nEvent)
+		nEvent = m_cRunning.top().first;
+	while (!m_cReserved.empty() &&
+		(!m_cWaiting.Queued(m_cRank[m_cReserved.top().second]) ||
+		m_cStart[m_cReserved.top().second] != m_cReserved.top().first))
+		m_cReserved.pop();		/* started, or moved by a compression */
+	if (!m_cReserved.empty() && m_cReserved.top().first < nEvent)
+		nEvent = m_cReserved.top().first;
+	return nEvent;
+}
+
+/**
+ * Arrive:
+ * nIndex: Job index
+ */
+void CBackfill::Arrive(size_t nIndex)
+{
+	const CJob& cJob = m_cJobs[nIndex];
+	if (m_cLog.Enabled())
+		m_cLog.Event(m_nTime, cJob.GetJob(), 0, EV_READY);
+	m_cWaiting.Set(m_cRank[nIndex], Runtime(nIndex) ? cJob.GetCpus() : 0);	/* a job without work fits anywhere */
+	g_cStats.Count(STAT_PUSH);
+	if (m_bConservative)
+		Reserve(nIndex);
+}
+
+/**
+ * Reserve:
+ * nIndex: Queued job
+ *
+ * Earliest time the job fits in the profile, its CPUs are taken from then on
+ */
+void CBackfill::Reserve(size_t nIndex)
+{
+	const CJob& cJob = m_cJobs[nIndex];
+	unsigned long long nStart = m_cProfile.Fit(m_nTime, cJob.GetEstimate(), cJob.GetCpus());
+	m_cProfile.Add(nStart, TimeAfter(nStart, cJob.GetEstimate()), - (int) cJob.GetCpus());
+	m_cStart[nIndex] = nStart;
+	m_cReserved.push(CEvent(nStart, nIndex));
+}
+
+/**
+ * Compress:
+ *
+ * A job terminated before its estimate, give each queued job,
+ * in arrival order, the earliest reservation it can have now
+ */
+void CBackfill::Compress()
+{
+	for (size_t nRank = m_cWaiting.First(0, m_nCpus); nRank != NO_JOB; nRank = m_cWaiting.First(nRank + 1, m_nCpus)) {
+		size_t nIndex = m_cOrder[nRank];
+		const CJob& cJob = m_cJobs[nIndex];
+		unsigned long long nStart = m_cStart[nIndex];
+		m_cProfile.Add(nStart, nStart + cJob.GetEstimate(), cJob.GetCpus());
+		Reserve(nIndex);
+	}
+}
+
+/**
+ * Start:
+ * nIndex: Queued job which fits now
+ */
+void CBackfill::Start(size_t nIndex)
+{
+	CJob& cJob = m_cJobs[nIndex];
+	if (!m_bConservative)		/* conservative jobs start in their reservation */
+		m_cProfile.Add(m_nTime, TimeAfter(m_nTime, cJob.GetEstimate()), - (int) cJob.GetCpus());
+	m_cWaiting.Clear(m_cRank[nIndex]);
+	g_cStats.Count(STAT_POP);
+	m_cStart[nIndex] = m_nTime;
+
+	std::vector<unsigned int>& cHeld = m_cHeld[nIndex];
+	if (Runtime(nIndex)) {		/* a job without work takes no CPU */
+		cHeld.assign(m_cIdle.end() - cJob.GetCpus(), m_cIdle.end());
+		m_cIdle.resize(m_cIdle.size() - cJob.GetCpus());
+	}
+	if (m_cLog.Enabled())
+		m_cLog.Event(m_nTime, cJob.GetJob(), cHeld.empty() ? 0 : cHeld.back(), EV_RUNNING);
+	m_cRunning.push(CEvent(TimeAfter(m_nTime, Runtime(nIndex)), nIndex));
+}
+
+/**
+ * Finish:
+ * nIndex: Running job, at its termination
+ */
+void CBackfill::Finish(size_t nIndex)
+{
+	CJob& cJob = m_cJobs[nIndex];
+	cJob.SetRunning(Runtime(nIndex));
+	cJob.SetTime(m_nTime);
+	m_cDone[nIndex] = true;
+	++ m_nDone;
+	std::vector<unsigned int>& cHeld = m_cHeld[nIndex];
+	if (m_cLog.Enabled())
+		m_cLog.Event(m_nTime, cJob.GetJob(), cHeld.empty() ? 0 : cHeld.back(), EV_TERMINATED);
+	m_cIdle.insert(m_cIdle.end(), cHeld.begin(), cHeld.end());
+	std::vector<unsigned int>().swap(cHeld);
+
+	unsigned long long nPlanned = m_cStart[nIndex] + cJob.GetEstimate();
+	if (m_nTime < nPlanned) {
+		m_cProfile.Add(m_nTime, nPlanned, cJob.GetCpus());	/* CPUs free before the plan */
+		m_bEarly = true;
+	}
+}
+
+/**
+ * Backfill:
+ *
+ * Start queued jobs in arrival order while they fit, then reserve
+ * CPUs for the first one which doesn't, and start any later job which
+ * fits now next to this reservation
+ */
+void CBackfill::Backfill()
+{
+	size_t nHead = m_cWaiting.First(0, m_nCpus);
+	while (nHead != NO_JOB) {
+		const CJob& cJob = m_cJobs[m_cOrder[nHead]];
+		if (!m_cProfile.Fits(m_nTime, cJob.GetEstimate(), cJob.GetCpus()))
+			break;
+		Start(m_cOrder[nHead]);
+		nHead = m_cWaiting.First(nHead + 1, m_nCpus);
+	}
+	if (nHead == NO_JOB)
+		return;
+
+	const CJob& cHead = m_cJobs[m_cOrder[nHead]];
+	unsigned long long nShadow = m_cProfile.Fit(m_nTime, cHead.GetEstimate(), cHead.GetCpus());
+	m_cProfile.Add(nShadow, nShadow + cHead.GetEstimate(), - (int) cHead.GetCpus());
+	int nFree = m_cProfile.Free(m_nTime);
+	size_t nRank = nHead;
+	while ((nRank = m_cWaiting.First(nRank + 1, nFree)) != NO_JOB) {
+		size_t nIndex = m_cOrder[nRank];
+		const CJob& cJob = m_cJobs[nIndex];
+		if (m_cProfile.Fits(m_nTime, cJob.GetEstimate(), cJob.GetCpus())) {
+			Start(nIndex);
+			nFree -= m_cHeld[nIndex].size();
+		}
+	}
+	m_cProfile.Add(nShadow, nShadow + cHead.GetEstimate(), cHead.GetCpus());
+}
+
+/**
+ * Run:
+ *
+ * Jump from event to event, terminations first, then arrivals, then starts
+ * Jobs arriving at same time keep the order of the list
+ * A signal may ask for the progress, or stop the run between two events
+ */
+void CBackfill::Run()
+{
+	debug_log("Entering %s ...", __FUNCTION__);	/* trace log */
+	CProgressWatch cWatch(m_cJobs.size(), g_cStats.Get(STAT_EVENT));
+	unsigned long long nEvent;
+	while ((nEvent = NextEvent()) != ULLONG_MAX) {
+		if (g_cProgress.Pending() &&
+			g_cProgress.Poll(m_nTime, m_nDone, g_cStats.Get(STAT_EVENT)))
+			break;		/* stopped by a signal, keep the jobs done */
+		g_cStats.Count(STAT_EVENT);
+		g_cStats.Count(STAT_TICK, nEvent - m_nTime);
+		m_nTime = nEvent;
+		m_cProfile.Trim(m_nTime);
+
+		while (!m_cRunning.empty() && m_cRunning.top().first <= m_nTime) {
+			size_t nIndex = m_cRunning.top().second;
+			m_cRunning.pop();
+			Finish(nIndex);
+		}
+		if (m_bConservative && m_bEarly)
+			Compress();
+		m_bEarly = false;
+		while (m_nNext < m_cOrder.size() && m_cJobs[m_cOrder[m_nNext]].GetArrival() <= m_nTime)
+			Arrive(m_cOrder[m_nNext ++]);
+
+		if (!m_bConservative)
+			Backfill();
+		else {
+			while (!m_cReserved.empty() && m_cReserved.top().first <= m_nTime) {
+				size_t nIndex = m_cReserved.top().second;
+				m_cReserved.pop();
+				if (m_cWaiting.Queued(m_cRank[nIndex]) && m_cStart[nIndex] == m_nTime)
+					Start(nIndex);
+			}
+		}
+	}
+	debug_log("Exiting %s at time %llu...", __FUNCTION__, m_nTime);	/* trace log */
+}
+
+/**
+ * Report:
+ *
+ * CPU utilization from the first arrival to the last termination,
+ * mean wait, and bounded slowdown: (wait + runtime) / max(runtime, BSLD_THRESHOLD),
+ * at least 1, so short jobs don't dominate the mean
+ */
+void CBackfill::Report() const
+{
+	if (m_cJobs.empty())
+		return;
+	unsigned long long nFirst = ULLONG_MAX;
+	unsigned long long nLast = 0;
+	unsigned long long nWork = 0;
+	double dWait = 0.0;
+	double dSlowdown = 0.0;
+	double dMaxSlowdown = 0.0;
+	for (size_t nIndex = 0; nIndex < m_cJobs.size(); ++ nIndex) {
+		const CJob& cJob = m_cJobs[nIndex];
+		unsigned long long nRuntime = Runtime(nIndex);
+		unsigned long long nWait = m_cStart[nIndex] - cJob.GetArrival();
+		nFirst = std::min(nFirst, cJob.GetArrival());
+		nLast = std::max(nLast, cJob.GetTime());
+		nWork += (unsigned long long) cJob.GetCpus() * nRuntime;
+		dWait += nWait;
+		double dBounded = std::max(1.0, (double) (nWait + nRuntime) / std::max(nRuntime, (unsigned long long) BSLD_THRESHOLD));
+		dSlowdown += dBounded;
+		dMaxSlowdown = std::max(dMaxSlowdown, dBounded);
+	}
+	double dUtil = nLast > nFirst ? 100.0 * nWork / ((double) m_nCpus * (nLast - nFirst)) : 0.0;
+	log_message("CPU utilization: %.2f%%", dUtil);
+	log_message("Mean wait: %.2f", dWait / m_cJobs.size());
+	log_message("Bounded slowdown: mean %.2f, max %.2f", dSlowdown / m_cJobs.size(), dMaxSlowdown);
+}
+
+/**
+ * ExecuteBackfill:
+ *
+ * Execute FCFS with EASY or conservative backfilling on a machine of m_nCpus CPUs
+ */
+int CSchedular::ExecuteBackfill()
+{
+	debug_log("Entering %s ...", __FUNCTION__);	/* trace log */
+	int nRes = 0;
+	try {
+		log_message("sched -%c %u for %s", IsConservative() ? 'K' : 'E', m_nCpus,
+			m_pFileName ? m_pFileName : "random jobs");	/* print the command to console */
+		if (!IsPlain()) {
+			err_printf("Backfilling can't run I/O bursts");
+			return -1;
+		}
+		for (std::vector<CJob>::const_iterator cIter = m_cList.begin();
+			cIter != m_cList.end();
+			++ cIter) {
+			if ((*cIter).GetCpus() > m_nCpus) {
+				err_printf("Job %d needs %u CPUs, the machine has %u", (*cIter).GetJob(), (*cIter).GetCpus(), m_nCpus);
+				return -1;
+			}
+		}
+
+		CBackfill cBackfill(m_cList, m_nCpus, IsConservative(), m_cLog);
+		cBackfill.Run();
+		SetTime(cBackfill.GetTime());
+
+		if (!m_bVerbose)
+			nRes = DisplayResult(&cBackfill.GetDone());
+		if (!g_cProgress.Stopped())	/* partial results, no utilization */
+			cBackfill.Report();
+	}
+	catch (std::exception& e) {
+		perr_printf(e.what());
+		nRes = -1;
+	}
+	catch (...) {
+		err_printf("Unknown Exception...");
+		nRes = -1;
+	}
+	debug_log("Exiting %s with code %d (0x%x)...", __FUNCTION__, nRes, nRes);	/* trace log */
+	return nRes;
+}
@@ -0,0 +1,344 @@
+/**
+ * Header files
+ */
+#include <algorithm>
+#include <vector>
+
+#include "support.h"
+#include "log.h"
+#include "cache.h"
+
+#ifdef HAVE_SYS_FILE_H
+#include <sys/file.h>
+#endif
+#ifdef HAVE_FCNTL_H
+#include <fcntl.h>
+#endif
+#ifdef HAVE_DIRENT_H
+#include <dirent.h>
+#endif
+#ifdef HAVE_SYS_STAT_H
+#include <sys/stat.h>
+#endif
+
+#define CACHE_BUFFER (1 << 16)		/* Read buffer for hashing and copying */
+#define CACHE_TEMP "tmp."		/* Prefix of the temporary entries */
+#define HASH_PRIME 0x100000001b3ULL	/* FNV-1a 64 bit prime */
+#define HASH_BASIS 0xcbf29ce484222325ULL	/* FNV-1a 64 bit offset basis */
+
+/**
+ * Hash:
+ * nHash: Hash so far
+ * pData, nSize: Data to add
+ *
+ * FNV-1a on 8 byte words, then on the remaining bytes
+ * Callers pass whole buffers, so only the end of the data has remaining bytes
+ */
+static uint64_t Hash(uint64_t nHash, const void* pData, size_t nSize)
+{
+	const unsigned char* pByte = (const unsigned char*) pData;
+	for (; nSize >= sizeof(uint64_t); nSize -= sizeof(uint64_t), pByte += sizeof(uint64_t)) {
+		uint64_t nWord;
+		memcpy(&nWord, pByte, sizeof(nWord));
+		nHash = (nHash ^ nWord) * HASH_PRIME;
+		nHash ^= nHash >> 29;
+	}
+	for (; nSize > 0; -- nSize, ++ pByte)
+		nHash = (nHash ^ *pByte) * HASH_PRIME;
+	return nHash;
+}
+
+/**
+ * Constructor
+ * pDirectory: Cache directory, created if needed, NULL for no cache
+ * nLimit: Size limit of the entries in bytes, 0 for CACHE_LIMIT
+ */
+CResultCache::CResultCache(const char* pDirectory, unsigned long long nLimit)
+	: m_csDirectory(pDirectory ? pDirectory : "")
+{
+	m_nLimit = nLimit ? nLimit : CACHE_LIMIT;
+	m_nKey = 0;
+	m_bKey = false;
+	m_nOutput = -1;
+	m_nCapture = -1;
+}
+
+/**
+ * Destructor
+ */
+CResultCache::~CResultCache()
+{
+	if (m_nCapture >= 0)
+		Commit(false);		/* give the standard output back */
+}
+
+/**
+ * Key:
+ * pFileName: Job file, NULL for random jobs, its name is in the output too
+ * nJobs: Number of random jobs
+ * nType, nQuantum, nAging: Policy parameters
+ * nSeed: Seed, 0 if the jobs and the policy don't draw random numbers
+ * nNodes, nBalance, nWorkers: Fleet size, load balancing and threads, 0 for a single CPU
+ * nCpus: CPUs of the machine for backfilling, 0 for other policies
+ * pSpeeds, pLevels: CPU speeds and frequency levels, NULL for nominal CPUs
+ * pSwitch: Cost of a context switch, NULL for free switches
+ *
+ * Returns 0 if the run has a key, -1 otherwise
+ */
+int CResultCache::Key(const char* pFileName, unsigned int nJobs, unsigned int nType, unsigned long long nQuantum, unsigned int nSeed, unsigned int nAging,
+	unsigned int nNodes, unsigned int nBalance, unsigned int nWorkers, unsigned int nCpus,
+	const char* pSpeeds, const char* pLevels, const char* pSwitch)
+{
+	m_bKey = false;
+	if (m_csDirectory.empty())
+		return -1;
+	uint64_t nHash = HASH_BASIS;
+	if (pFileName) {
+		FILE* pFile = fopen(pFileName, "rb");
+		if (pFile == NULL)
+			return -1;	/* reading the jobs reports the error */
+		std::vector<char> cBuffer(CACHE_BUFFER);
+		size_t nRead;
+		while ((nRead = fread(&cBuffer[0], 1, cBuffer.size(), pFile)) > 0)
+			nHash = Hash(nHash, &cBuffer[0], nRead);
+		fclose(pFile);
+		std::string csName = std::string("file=") + pFileName;	/* same jobs, other header */
+		nHash = Hash(nHash, csName.data(), csName.size());
+	}
+	uint64_t nParameter[] = { CACHE_VERSION, pFileName ? 0 : nJobs, nType, nQuantum, nSeed, nAging, nNodes, nBalance, nWorkers, nCpus };
+	nHash = Hash(nHash, nParameter, sizeof(nParameter));
+	if (pSpeeds || pLevels) {
+		std::string csSpeed = std::string("speed=") + (pSpeeds ? pSpeeds : "") + ";dvfs=" + (pLevels ? pLevels : "");
+		nHash = Hash(nHash, csSpeed.data(), csSpeed.size());
+	}
+	if (pSwitch) {
+		std::string csSwitch = std::string("switch=") + pSwitch;
+		nHash = Hash(nHash, csSwitch.data(), csSwitch.size());
+	}
+	nHash = (nHash ^ (nHash >> 33)) * 0xff51afd7ed558ccdULL;	/* spread the last words over the whole key */
+	m_nKey = nHash ^ (nHash >> 33);
+	m_bKey = true;
+	debug_log("Cache key %016llx", (unsigned long long) m_nKey);
+	return 0;
+}
+
+/**
+ * Entry:
+ *
+ * Returns file of the key in the cache directory
+ */
+std::string CResultCache::Entry() const
+{
+	char pName[32];
+	snprintf(pName, sizeof(pName), "/%016llx.res", (unsigned long long) m_nKey);
+	return m_csDirectory + pName;
+}
+
+/**
+ * Lock:
+ * nOperation: LOCK_SH or LOCK_EX
+ *
+ * Returns lock file descriptor, or -1 if the cache directory can't be used
+ */
+int CResultCache::Lock(int nOperation)
+{
+	if (mkdir(m_csDirectory.c_str(), 0755) < 0 && errno != EEXIST) {
+		perr_printf("Failed to create %s", m_csDirectory.c_str());
+		return -1;
+	}
+	std::string csLock = m_csDirectory + "/lock";
+	int nLock = open(csLock.c_str(), O_RDWR | O_CREAT, 0644);
+	if (nLock < 0) {
+		perr_printf("Failed to open %s", csLock.c_str());
+		return -1;
+	}
+	while (flock(nLock, nOperation) < 0) {
+		if (errno != EINTR) {
+			perr_printf("Failed to lock %s", csLock.c_str());
+			close(nLock);
+			return -1;
+		}
+	}
+	return nLock;
+}
+
+/**
+ * Unlock:
+ * nLock: Lock file descriptor
+ */
+void CResultCache::Unlock(int nLock)
+{
+	flock(nLock, LOCK_UN);
+	close(nLock);
+}
+
+/**
+ * Fetch:
+ *
+ * Write the stored output of the key to the standard output,
+ * and make it the most recently used entry
+ * Returns true on a hit
+ */
+bool CResultCache::Fetch()
+{
+	if (!m_bKey)
+		return false;
+	int nLock = Lock(LOCK_SH);
+	if (nLock < 0)
+		return false;
+	std::string csEntry = Entry();
+	int nFile = open(csEntry.c_str(), O_RDONLY);
+	bool bHit = nFile >= 0;
+	if (bHit) {
+		std::vector<char> cBuffer(CACHE_BUFFER);
+		ssize_t nRead;
+		while ((nRead = read(nFile, &cBuffer[0], cBuffer.size())) > 0)
+			fwrite(&cBuffer[0], 1, nRead, stdout);
+		fflush(stdout);
+		close(nFile);
+		utimensat(AT_FDCWD, csEntry.c_str(), NULL, 0);	/* LRU order is the modification time */
+	}
+	Unlock(nLock);
+	debug_log("Cache %s for %016llx", bHit ? "hit" : "miss", (unsigned long long) m_nKey);
+	return bHit;
+}
+
+/**
+ * Begin:
+ *
+ * Send the standard output to a temporary entry, until Commit
+ * Returns 0 on success, -1 if the output can't be captured
+ */
+int CResultCache::Begin()
+{
+	if (!m_bKey || m_nCapture >= 0)
+		return -1;
+	int nLock = Lock(LOCK_SH);		/* Evict doesn't see it before it is locked */
+	if (nLock < 0)
+		return -1;
+	std::vector<char> cName(m_csDirectory.begin(), m_csDirectory.end());
+	const char* pTemplate = "/" CACHE_TEMP "XXXXXX";
+	cName.insert(cName.end(), pTemplate, pTemplate + strlen(pTemplate) + 1);
+	m_nCapture = mkstemp(&cName[0]);
+	if (m_nCapture < 0) {
+		perr_printf("Failed to create %s", &cName[0]);
+		Unlock(nLock);
+		return -1;
+	}
+	m_csCapture = &cName[0];
+	flock(m_nCapture, LOCK_EX);		/* held until Commit, or until the process dies */
+	Unlock(nLock);
+	fchmod(m_nCapture, 0644);		/* entries are shared, like the directory */
+	fflush(stdout);
+	m_nOutput = dup(STDOUT_FILENO);
+	if (m_nOutput < 0 || dup2(m_nCapture, STDOUT_FILENO) < 0) {
+		perr_printf("Failed to capture the output");
+		if (m_nOutput >= 0)
+			close(m_nOutput);
+		m_nOutput = -1;
+		close(m_nCapture);
+		m_nCapture = -1;
+		unlink(m_csCapture.c_str());
+		return -1;
+	}
+	return 0;
+}
+
+/**
+ * Commit:
+ * bStore: Keep the output as the entry of the key
+ *
+ * Give the standard output back, and write the captured output to it
+ */
+int CResultCache::Commit(bool bStore)
+{
+	if (m_nCapture < 0)
+		return -1;
+	fflush(stdout);
+	dup2(m_nOutput, STDOUT_FILENO);
+	close(m_nOutput);
+	m_nOutput = -1;
+
+	std::vector<char> cBuffer(CACHE_BUFFER);
+	ssize_t nRead;
+	lseek(m_nCapture, 0, SEEK_SET);
+	while ((nRead = read(m_nCapture, &cBuffer[0], cBuffer.size())) > 0)
+		fwrite(&cBuffer[0], 1, nRead, stdout);
+	fflush(stdout);
+
+	/**
+	 * The temporary entry is closed last, its lock tells Evict
+	 * that it isn't left over by a run which was killed
+	 */
+	int nRes = 0;
+	int nLock = bStore ? Lock(LOCK_EX) : -1;
+	if (nLock >= 0) {
+		nRes = rename(m_csCapture.c_str(), Entry().c_str());
+		if (nRes < 0)
+			perr_printf("Failed to store %s", Entry().c_str());
+	}
+	else if (bStore)
+		nRes = -1;
+	if (nLock < 0 || nRes < 0)
+		unlink(m_csCapture.c_str());
+	close(m_nCapture);
+	m_nCapture = -1;
+	if (nLock >= 0) {
+		if (nRes == 0)
+			Evict();
+		Unlock(nLock);
+	}
+	return nRes;
+}
+
+/**
+ * Evict:
+ *
+ * Remove the temporary entries of killed runs, which nobody has locked,
+ * then the least recently used entries, until the entries fit in the limit
+ * Caller holds the exclusive lock
+ */
+void CResultCache::Evict()
+{
+	typedef std::pair<unsigned long long, std::string> CUsed;	/* modification time in nanoseconds, entry */
+	DIR* pDir = opendir(m_csDirectory.c_str());
+	if (pDir == NULL)
+		return;
+	std::vector<CUsed> cEntries;
+	unsigned long long nTotal = 0;
+	struct dirent* pEntry;
+	while ((pEntry = readdir(pDir)) != NULL) {
+		size_t nLength = strlen(pEntry->d_name);
+		if (strncmp(pEntry->d_name, CACHE_TEMP, strlen(CACHE_TEMP)) == 0) {
+			std::string csPath = m_csDirectory + "/" + pEntry->d_name;
+			int nFile = open(csPath.c_str(), O_RDONLY);
+			if (nFile >= 0 && flock(nFile, LOCK_EX | LOCK_NB) == 0) {
+				unlink(csPath.c_str());
+				debug_log("Cache removed %s", csPath.c_str());
+			}
+			if (nFile >= 0)
+				close(nFile);
+			continue;
+		}
+		if (nLength < 4 || strcmp(pEntry->d_name + nLength - 4, ".res") != 0)
+			continue;
+		std::string csPath = m_csDirectory + "/" + pEntry->d_name;
+		struct stat cStat;
+		if (stat(csPath.c_str(), &cStat) < 0)
+			continue;
+		cEntries.push_back(CUsed(cStat.st_mtim.tv_sec * 1000000000ULL + cStat.st_mtim.tv_nsec, csPath));
+		nTotal += cStat.st_size;
+	}
+	closedir(pDir);
+	if (nTotal <= m_nLimit)
+		return;
+
+	std::sort(cEntries.begin(), cEntries.end());
+	for (size_t nIndex = 0; nIndex < cEntries.size() && nTotal > m_nLimit; ++ nIndex) {
+		struct stat cStat;
+		if (stat(cEntries[nIndex].second.c_str(), &cStat) < 0 || unlink(cEntries[nIndex].second.c_str()) < 0)
+			continue;
+		nTotal -= cStat.st_size;
+		debug_log("Cache evicted %s", cEntries[nIndex].second.c_str());
+	}
+}
@@ -0,0 +1,711 @@
+/**
+ * Header files
+ */
+#include <algorithm>
+#include <limits.h>
+
+#include "support.h"
+#include "log.h"
+#include "cluster.h"
+#include "stats.h"
+
+/**
+ * Names of the balance policies, for -B
+ */
+static const char* g_pBalanceName[BALANCE_MAX] = {
+	"rr",
+	"random",
+	"jsq",
+	"p2c",
+	"lwl",
+	"fast",
+};
+
+/**
+ * Tail of the turnaround, in the report
+ */
+#define CLUSTER_TAILS 4
+static const double g_dTail[CLUSTER_TAILS] = { 0.5, 0.9, 0.99, 0.999 };
+
+/**
+ * Due nodes a window advances on the calling thread, a barrier
+ * costs more than advancing this many nodes by a few events each
+ */
+#define CLUSTER_SERIAL 32
+
+/**
+ * Constructor
+ */
+CCluster::CCluster(std::vector<CJob>& cJobs, unsigned int nNodes, int nBalance, unsigned int nSeed, unsigned int nThreads)
+	: m_cJobs(cJobs), m_cNodes(nNodes ? nNodes : 1), m_cRandom(nSeed)
+{
+	m_nBalance = nBalance;
+	m_nNext = 0;
+	m_cParts.resize(std::max(1U, std::min(nThreads, (unsigned int) m_cNodes.size())));
+	m_bTrack = m_nBalance == BALANCE_JSQ || (m_nBalance == BALANCE_P2C && m_cParts.size() > 1);
+	m_bHorizon = m_nBalance == BALANCE_JSQ && m_cParts.size() > 1;
+	m_nBatch = m_nBalance == BALANCE_JSQ ? 1 : m_cNodes.size();
+	m_nRound = 0;
+	m_nBusy = 0;
+	m_nCommand = PART_ADVANCE;
+	m_nTarget = 0;
+	m_bExit = false;
+	m_nDone.store(0);
+	for (size_t nNode = 0; nNode < m_cNodes.size(); ++ nNode) {
+		m_cNodes[nNode].pQueue = NULL;
+		m_cNodes[nNode].pEngine = NULL;
+		m_cNodes[nNode].cRandom.Seed(((uint64_t) nSeed << 32) | nNode);
+		m_cNodes[nNode].nQueued = ULLONG_MAX;
+		m_cNodes[nNode].nHorizon = ULLONG_MAX;
+		m_cNodes[nNode].nSpeed = SPEED_ONE;
+		if (m_nBalance == BALANCE_JSQ)
+			m_cLength.insert(CLength(0, nNode));
+	}
+}
+
+/**
+ * Destructor
+ */
+CCluster::~CCluster()
+{
+	for (size_t nNode = 0; nNode < m_cNodes.size(); ++ nNode) {
+		delete m_cNodes[nNode].pEngine;
+		delete m_cNodes[nNode].pQueue;
+	}
+}
+
+/**
+ * Balance:
+ * pName: Name of the policy, e.g. "jsq"
+ *
+ * Returns the balance policy, -1 if unknown
+ */
+int CCluster::Balance(const char* pName)
+{
+	for (int nBalance = 0; nBalance < BALANCE_MAX; ++ nBalance) {
+		if (strcmp(pName, g_pBalanceName[nBalance]) == 0)
+			return nBalance;
+	}
+	return -1;
+}
+
+/**
+ * BalanceName:
+ * nBalance: Balance policy
+ *
+ * Returns name of the policy
+ */
+const char* CCluster::BalanceName(int nBalance)
+{
+	return nBalance >= 0 && nBalance < BALANCE_MAX ? g_pBalanceName[nBalance] : "unknown";
+}
+
+/**
+ * Attach:
+ * nNode: Node number
+ * pQueue: Ready queue of the local policy, the cluster deletes it
+ * nQuantum: Time quantum of the local policy
+ * pSpeed: Speed of the node, NULL for nominal, it must outlive the cluster
+ * pCost: Cost of a context switch, NULL for free switches, it must outlive the cluster
+ */
+void CCluster::Attach(size_t nNode, CReadyQueue* pQueue, unsigned long long nQuantum, const CSpeed* pSpeed, const CSwitchCost* pCost)
+{
+	CNode& cNode = m_cNodes[nNode];
+	cNode.pQueue = pQueue;
+	cNode.pEngine = new CEngine(cNode.cJobs, *pQueue, nQuantum, m_cLog);
+	cNode.pEngine->SetSpeed(pSpeed);
+	cNode.pEngine->SetCost(pCost);
+	cNode.nSpeed = pSpeed ? pSpeed->GetBase() : SPEED_ONE;
+}
+
+/**
+ * Tiers:
+ *
+ * lwl has one tier of every node. fast has one tier per node speed, fastest first,
+ * and splits the job sizes: going through the jobs from the shortest, each tier
+ * takes jobs while its share of the total work is not over, a share being the
+ * tier's part of the fleet capacity. Jobs of one size stay in one tier.
+ */
+void CCluster::Tiers()
+{
+	std::vector<unsigned int> cSpeeds;
+	for (size_t nNode = 0; nNode < m_cNodes.size(); ++ nNode)
+		cSpeeds.push_back(m_nBalance == BALANCE_FAST ? m_cNodes[nNode].nSpeed : SPEED_ONE);
+	std::sort(cSpeeds.begin(), cSpeeds.end(), std::greater<unsigned int>());
+	cSpeeds.erase(std::unique(cSpeeds.begin(), cSpeeds.end()), cSpeeds.end());
+
+	m_cDrain.assign(cSpeeds.size(), CDueHeap());
+	std::vector<double> cCapacity(cSpeeds.size(), 0.0);
+	double dCapacity = 0.0;
+	for (size_t nNode = 0; nNode < m_cNodes.size(); ++ nNode) {
+		size_t nTier = 0;
+		if (m_nBalance == BALANCE_FAST)
+			nTier = std::lower_bound(cSpeeds.begin(), cSpeeds.end(), m_cNodes[nNode].nSpeed, std::greater<unsigned int>()) - cSpeeds.begin();
+		m_cDrain[nTier].push(CDue(0, nNode));	/* every node is drained at start */
+		cCapacity[nTier] += m_cNodes[nNode].nSpeed;
+		dCapacity += m_cNodes[nNode].nSpeed;
+	}
+
+	m_cCutoff.assign(cSpeeds.size(), ULLONG_MAX);
+	std::vector<unsigned long long> cBursts;
+	double dTotal = 0.0;
+	for (size_t nIndex = 0; nIndex < m_cJobs.size(); ++ nIndex) {
+		cBursts.push_back(m_cJobs[nIndex].GetBurst());
+		dTotal += m_cJobs[nIndex].GetBurst();
+	}
+	std::sort(cBursts.begin(), cBursts.end());
+	size_t nJob = 0;
+	double dWork = 0.0;
+	double dShare = 0.0;
+	for (size_t nTier = 0; nTier + 1 < cSpeeds.size(); ++ nTier) {
+		dShare += dTotal * cCapacity[nTier] / dCapacity;
+		while (nJob < cBursts.size() && dWork + cBursts[nJob] <= dShare)
+			dWork += cBursts[nJob ++];
+		m_cCutoff[nTier] = nJob ? cBursts[nJob - 1] : 0;
+		while (nJob < cBursts.size() && cBursts[nJob] <= m_cCutoff[nTier])
+			dWork += cBursts[nJob ++];	/* same size, same tier */
+	}
+}
+
+/**
+ * Length:
+ * nNode: Node number
+ *
+ * Returns jobs routed to the node and not yet terminated
+ */
+size_t CCluster::Length(size_t nNode) const
+{
+	const CNode& cNode = m_cNodes[nNode];
+	return cNode.cJobs.size() - cNode.pEngine->GetTerminated();
+}
+
+/**
+ * Terminated:
+ *
+ * Only while the threads are idle, between two windows
+ * Returns jobs terminated in every node
+ */
+unsigned long long CCluster::Terminated() const
+{
+	unsigned long long nDone = 0;
+	for (size_t nNode = 0; nNode < m_cNodes.size(); ++ nNode)
+		nDone += m_cNodes[nNode].pEngine->GetTerminated();
+	return nDone;
+}
+
+/**
+ * Sync:
+ * nNode: Node number
+ * nTime: Arrival time of the job being routed
+ *
+ * Simulate the node's events before this time, so its length is current
+ */
+void CCluster::Sync(size_t nNode, unsigned long long nTime)
+{
+	m_cNodes[nNode].pEngine->AdvanceTo(nTime);
+}
+
+/**
+ * Schedule:
+ * nNode: Node number
+ *
+ * Put the node in its part's heap at its next event, unless an earlier entry is there
+ * Later entries of a node are stale, they are skipped when they come out
+ * For jsq with threads, the node's earliest termination goes in the other heap of the part the same way
+ */
+void CCluster::Schedule(size_t nNode)
+{
+	CNode& cNode = m_cNodes[nNode];
+	CPart& cPart = m_cParts[Owner(nNode)];
+	unsigned long long nEvent = cNode.pEngine->NextEvent();
+	if (nEvent < cNode.nQueued) {
+		cNode.nQueued = nEvent;
+		cPart.cDue.push(CDue(nEvent, nNode));
+	}
+	if (m_bHorizon) {
+		unsigned long long nHorizon = cNode.pEngine->NextTermination();
+		if (nHorizon < cNode.nHorizon) {
+			cNode.nHorizon = nHorizon;
+			cPart.cHorizon.push(CDue(nHorizon, nNode));
+		}
+	}
+}
+
+/**
+ * Changes:
+ * nTime: Arrival time of the job being routed
+ *
+ * Only while the threads are idle, between two windows
+ * Returns true if a node may terminate a job before this time, so the
+ * dispatcher would see another length. Until then the arrivals need no window,
+ * the events of the nodes wait for the next one. An entry may be earlier than
+ * its node's termination, which is then found again and replaces it.
+ */
+bool CCluster::Changes(unsigned long long nTime)
+{
+	for (size_t nPart = 0; nPart < m_cParts.size(); ++ nPart) {
+		CDueHeap& cHorizon = m_cParts[nPart].cHorizon;
+		while (!cHorizon.empty() && cHorizon.top().first < nTime) {
+			CDue cDue = cHorizon.top();
+			cHorizon.pop();
+			CNode& cNode = m_cNodes[cDue.second];
+			if (cDue.first != cNode.nHorizon)
+				continue;		/* stale entry */
+			cNode.nHorizon = cNode.pEngine->NextTermination();
+			if (cNode.nHorizon != ULLONG_MAX)
+				cHorizon.push(CDue(cNode.nHorizon, cDue.second));
+			if (cNode.nHorizon < nTime)
+				return true;
+		}
+	}
+	return false;
+}
+
+/**
+ * Simulate:
+ * nPart: Part number
+ * nTime: End of the window
+ * nLimit: Most nodes to advance
+ *
+ * Advance the nodes of this part which have an event before the window end,
+ * only these nodes can have a different length since the last arrival
+ * Returns number of nodes advanced
+ */
+size_t CCluster::Simulate(size_t nPart, unsigned long long nTime, size_t nLimit)
+{
+	CPart& cPart = m_cParts[nPart];
+	size_t nDone = 0;
+	while (nDone < nLimit && !cPart.cDue.empty() && cPart.cDue.top().first < nTime) {
+		CDue cDue = cPart.cDue.top();
+		cPart.cDue.pop();
+		CNode& cNode = m_cNodes[cDue.second];
+		if (cDue.first != cNode.nQueued)
+			continue;		/* stale entry */
+		cNode.nQueued = ULLONG_MAX;
+		size_t nLength = Length(cDue.second);
+		cNode.pEngine->AdvanceTo(nTime);
+		if (m_nBalance == BALANCE_JSQ && Length(cDue.second) != nLength)
+			cPart.cChanged.push_back(CLength(nLength, cDue.second));
+		Schedule(cDue.second);
+		++ nDone;
+	}
+	return nDone;
+}
+
+/**
+ * Work:
+ * nPart: Part number
+ *
+ * Do the command of the window on the nodes of this part
+ * The nodes finish event by event, any thread may write the progress,
+ * and a signal stops every one of them
+ */
+void CCluster::Work(size_t nPart)
+{
+	if (m_nCommand == PART_ADVANCE) {
+		Simulate(nPart, m_nTarget, m_cNodes.size());
+		return;
+	}
+
+	size_t nEnd = (nPart + 1) * m_cNodes.size() / m_cParts.size();
+	for (size_t nNode = nPart * m_cNodes.size() / m_cParts.size(); nNode < nEnd; ++ nNode) {
+		CNode& cNode = m_cNodes[nNode];
+		CEngine& cEngine = *cNode.pEngine;
+		size_t nDone = cEngine.GetTerminated();
+		while (!(g_cProgress.Pending() && g_cProgress.Stopped()) && cEngine.Step()) {
+			if (cEngine.GetTerminated() != nDone) {
+				m_nDone.fetch_add(cEngine.GetTerminated() - nDone);
+				nDone = cEngine.GetTerminated();
+			}
+			if (g_cProgress.Pending() && !g_cProgress.Stopped())
+				g_cProgress.Poll(cEngine.GetTime(), m_nDone.load(), ULLONG_MAX);
+		}
+		for (size_t nJob = 0; nJob < cNode.cJobs.size(); ++ nJob)
+			m_cJobs[cNode.cIndex[nJob]] = cNode.cJobs[nJob];	/* done or not, for the results */
+	}
+}
+
+/**
+ * Worker:
+ * nPart: Part number
+ *
+ * Host thread of a part, does the command of each window until told to exit
+ */
+void CCluster::Worker(size_t nPart)
+{
+	std::unique_lock<std::mutex> cGuard(m_cLock);
+	unsigned long long nRound = 0;
+	while (true) {
+		while (m_nRound == nRound && !m_bExit)
+			m_cStart.wait(cGuard);
+		if (m_bExit)
+			break;
+		nRound = m_nRound;
+		cGuard.unlock();
+		std::exception_ptr pFailure;
+		try {
+			Work(nPart);
+		}
+		catch (...) {
+			pFailure = std::current_exception();
+		}
+		cGuard.lock();
+		if (pFailure && !m_pFailure)
+			m_pFailure = pFailure;
+		if (-- m_nBusy == 0)
+			m_cDone.notify_one();
+	}
+}
+
+/**
+ * Parallel:
+ * nCommand: Work of the window (see _part_commands)
+ * nTime: End of the window
+ *
+ * Every part does the command, the calling thread does the first part
+ * Returns once all parts are done, throws the error of a part if any
+ */
+void CCluster::Parallel(int nCommand, unsigned long long nTime)
+{
+	m_nCommand = nCommand;
+	m_nTarget = nTime;
+	if (m_cParts.size() > 1) {
+		g_cStats.Count(STAT_WINDOW);
+		std::lock_guard<std::mutex> cGuard(m_cLock);
+		m_nBusy = m_cParts.size() - 1;
+		++ m_nRound;
+		m_cStart.notify_all();
+	}
+	Work(0);
+	if (m_cParts.size() > 1) {
+		std::unique_lock<std::mutex> cGuard(m_cLock);
+		while (m_nBusy > 0)
+			m_cDone.wait(cGuard);
+		if (m_pFailure)
+			std::rethrow_exception(m_pFailure);
+	}
+}
+
+/**
+ * Advance:
+ * nTime: Arrival time of the job being routed
+ *
+ * Simulate every node which has an event before this time, then
+ * update the lengths the dispatcher sees. For jsq with threads, a window
+ * is only needed if some node may terminate a job before, so one window
+ * covers the events of every arrival time since the last one.
+ * The calling thread advances the first CLUSTER_SERIAL due nodes itself,
+ * the other parts are woken only if more are due, so a small window
+ * costs no barrier.
+ */
+void CCluster::Advance(unsigned long long nTime)
+{
+	if (m_bHorizon && !Changes(nTime))
+		return;
+	size_t nLimit = CLUSTER_SERIAL;
+	for (size_t nPart = 0; nPart < m_cParts.size() && nLimit > 0; ++ nPart)
+		nLimit -= Simulate(nPart, nTime, nLimit);
+	for (size_t nPart = 0; nPart < m_cParts.size(); ++ nPart) {
+		if (!m_cParts[nPart].cDue.empty() && m_cParts[nPart].cDue.top().first < nTime) {
+			Parallel(PART_ADVANCE, nTime);
+			break;
+		}
+	}
+
+	for (size_t nPart = 0; nPart < m_cParts.size(); ++ nPart) {
+		std::vector<CLength>& cChanged = m_cParts[nPart].cChanged;
+		for (size_t nChange = 0; nChange < cChanged.size(); ++ nChange) {
+			m_cLength.erase(cChanged[nChange]);
+			m_cLength.insert(CLength(Length(cChanged[nChange].second), cChanged[nChange].second));
+		}
+		cChanged.clear();
+	}
+}
+
+/**
+ * Route:
+ * nIndex: Job index in the fleet list
+ *
+ * Returns node of the job, as chosen by the balance policy
+ */
+size_t CCluster::Route(size_t nIndex)
+{
+	const CJob& cJob = m_cJobs[nIndex];
+	size_t nNodes = m_cNodes.size();
+	size_t nNode = 0;
+	switch (m_nBalance) {
+	case BALANCE_RR:
+		nNode = m_nNext;
+		m_nNext = (m_nNext + 1) % nNodes;
+		break;
+	case BALANCE_RANDOM:
+		nNode = m_cRandom.Range(nNodes);
+		break;
+	case BALANCE_JSQ:
+		nNode = m_cLength.begin()->second;	/* lowest length, then lowest node */
+		break;
+	case BALANCE_P2C:
+		nNode = m_cRandom.Range(nNodes);
+		if (nNodes > 1) {
+			size_t nOther = m_cRandom.Range(nNodes - 1);
+			if (nOther >= nNode)
+				++ nOther;		/* two different nodes */
+			Sync(nNode, cJob.GetArrival());
+			Sync(nOther, cJob.GetArrival());
+			if (Length(nOther) < Length(nNode))
+				nNode = nOther;
+		}
+		break;
+	case BALANCE_LWL:
+	case BALANCE_FAST: {
+		/**
+		 * Work left on a node is its drain time minus now, for a work conserving
+		 * local policy, so the node with the earliest drain time has the least.
+		 * The job takes its burst at the base speed of the node,
+		 * I/O bursts and frequency levels are not counted
+		 */
+		size_t nTier = std::lower_bound(m_cCutoff.begin(), m_cCutoff.end(), cJob.GetBurst()) - m_cCutoff.begin();
+		CDueHeap& cDrain = m_cDrain[nTier];
+		CDue cDue = cDrain.top();
+		cDrain.pop();
+		nNode = cDue.second;
+		unsigned long long nWork = (unsigned long long) cJob.GetBurst() * SPEED_ONE;
+		unsigned long long nDrain = std::max(cDue.first, cJob.GetArrival()) + (nWork + m_cNodes[nNode].nSpeed - 1) / m_cNodes[nNode].nSpeed;
+		cDrain.push(CDue(nDrain, nNode));
+		break;
+	}
+	}
+	return nNode;
+}
+
+/**
+ * Run:
+ *
+ * Route the jobs in arrival order, then finish every node
+ * Jobs arriving at same time keep the order of the list
+ * An error of any node stops the threads, then the run throws it
+ * A signal may ask for the progress, or stop the routing or the nodes,
+ * the fleet list then has the jobs as far as they went
+ */
+void CCluster::Run()
+{
+	debug_log("Entering %s ...", __FUNCTION__);	/* trace log */
+	std::vector<size_t> cOrder(m_cJobs.size());
+	for (size_t nIndex = 0; nIndex < cOrder.size(); ++ nIndex)
+		cOrder[nIndex] = nIndex;
+	std::stable_sort(cOrder.begin(), cOrder.end(), CArrivalOrder(m_cJobs));
+
+	if (m_nBalance == BALANCE_LWL || m_nBalance == BALANCE_FAST)
+		Tiers();
+
+	CProgressWatch cWatch(m_cJobs.size(), 0);
+	std::vector<std::thread> cThreads;
+	for (size_t nPart = 1; nPart < m_cParts.size(); ++ nPart)
+		cThreads.push_back(std::thread(&CCluster::Worker, this, nPart));
+
+	try {
+		bool bRouted = true;
+		size_t nWindow = 0;
+		for (size_t nNext = 0; nNext < cOrder.size(); ++ nNext) {
+			size_t nIndex = cOrder[nNext];
+			if (g_cProgress.Pending() &&
+				g_cProgress.Poll(m_cJobs[nIndex].GetArrival(), Terminated(), ULLONG_MAX)) {
+				bRouted = false;	/* stopped by a signal, the nodes keep what they have */
+				break;
+			}
+			if (m_bTrack && ++ nWindow == m_nBatch) {
+				nWindow = 0;
+				Advance(m_cJobs[nIndex].GetArrival());
+			}
+			size_t nNode = Route(nIndex);
+
+			CNode& cNode = m_cNodes[nNode];
+			if (m_bHorizon)
+				Sync(nNode, m_cJobs[nIndex].GetArrival());	/* events since its last window, none terminates */
+			size_t nLength = Length(nNode);
+			cNode.cJobs.push_back(m_cJobs[nIndex]);
+			cNode.cIndex.push_back(nIndex);
+			cNode.pEngine->Admit(cNode.cJobs.size() - 1);
+			if (m_nBalance == BALANCE_JSQ) {
+				m_cLength.erase(CLength(nLength, nNode));
+				m_cLength.insert(CLength(nLength + 1, nNode));
+			}
+			if (m_bTrack)
+				Schedule(nNode);
+		}
+		m_nDone.store(Terminated());
+		Parallel(PART_FINISH, ULLONG_MAX);
+		if (bRouted && g_cProgress.Stopped())
+			g_cProgress.Poll(GetTime(), Terminated(), ULLONG_MAX);	/* where the stop left the fleet */
+	}
+	catch (...) {
+		std::lock_guard<std::mutex> cGuard(m_cLock);
+		if (!m_pFailure)
+			m_pFailure = std::current_exception();
+	}
+
+	{
+		std::lock_guard<std::mutex> cGuard(m_cLock);
+		m_bExit = true;
+		m_cStart.notify_all();
+	}
+	for (size_t nThread = 0; nThread < cThreads.size(); ++ nThread)
+		cThreads[nThread].join();
+	if (m_pFailure)
+		std::rethrow_exception(m_pFailure);
+	debug_log("Exiting %s at time %llu...", __FUNCTION__, GetTime());	/* trace log */
+}
+
+/**
+ * GetTime:
+ *
+ * Returns time of the last termination in the fleet, or of the last event
+ * if a signal stopped the nodes
+ */
+unsigned long long CCluster::GetTime() const
+{
+	unsigned long long nTime = 0;
+	for (size_t nNode = 0; nNode < m_cNodes.size(); ++ nNode)
+		nTime = std::max(nTime, m_cNodes[nNode].pEngine->GetTime());
+	return nTime;
+}
+
+/**
+ * Percentiles:
+ * cTurnaround: Turnaround times, reordered
+ * pValue: Mean, each tail of g_dTail, then max
+ *
+ * Nearest rank percentiles, each one selects in the part above the previous one,
+ * so the whole tail costs O(jobs)
+ */
+void CCluster::Percentiles(std::vector<unsigned long long>& cTurnaround, double* pValue) const
+{
+	size_t nCount = cTurnaround.size();
+	for (int nTail = 0; nTail < CLUSTER_TAILS + 2; ++ nTail)
+		pValue[nTail] = 0.0;
+	if (nCount == 0)
+		return;
+	double dSum = 0.0;
+	for (size_t nJob = 0; nJob < nCount; ++ nJob)
+		dSum += cTurnaround[nJob];
+	pValue[0] = dSum / nCount;
+
+	std::vector<unsigned long long>::iterator cFrom = cTurnaround.begin();
+	for (int nTail = 0; nTail < CLUSTER_TAILS; ++ nTail) {
+		size_t nRank = (size_t) (g_dTail[nTail] * nCount + 0.999999);
+		if (nRank < 1)
+			nRank = 1;
+		std::vector<unsigned long long>::iterator cRank = cTurnaround.begin() + (nRank - 1);
+		std::nth_element(cFrom, cRank, cTurnaround.end());
+		pValue[1 + nTail] = *cRank;
+		cFrom = cRank;
+	}
+	pValue[1 + CLUSTER_TAILS] = *std::max_element(cFrom, cTurnaround.end());
+}
+
+/**
+ * Report:
+ *
+ * One line per node, then the fleet: jobs, CPU utilization from the first
+ * arrival to the last termination of the fleet, mean and tail turnaround
+ */
+void CCluster::Report() const
+{
+	if (m_cJobs.empty())
+		return;
+	unsigned long long nStart = ULLONG_MAX;
+	for (size_t nIndex = 0; nIndex < m_cJobs.size(); ++ nIndex)
+		nStart = std::min(nStart, m_cJobs[nIndex].GetArrival());
+	unsigned long long nEnd = GetTime();
+	double dSpan = nEnd > nStart ? (double) (nEnd - nStart) : 0.0;
+
+	double dValue[CLUSTER_TAILS + 2];
+	std::vector<unsigned long long> cTurnaround;
+	unsigned long long nFleetBusy = 0;
+	log_message("node jobs utilization mean p50 p90 p99 p99.9 max");
+	for (size_t nNode = 0; nNode < m_cNodes.size(); ++ nNode) {
+		const CNode& cNode = m_cNodes[nNode];
+		cTurnaround.resize(cNode.cJobs.size());
+		for (size_t nJob = 0; nJob < cNode.cJobs.size(); ++ nJob)
+			cTurnaround[nJob] = cNode.cJobs[nJob].GetTime() - cNode.cJobs[nJob].GetArrival();
+		Percentiles(cTurnaround, dValue);
+		unsigned long long nBusy = cNode.pEngine->GetBusy();
+		nFleetBusy += nBusy;
+		log_message("%zu %zu %.2f%% %.2f %.0f %.0f %.0f %.0f %.0f", nNode, cNode.cJobs.size(),
+			dSpan > 0.0 ? 100.0 * nBusy / dSpan : 0.0,
+			dValue[0], dValue[1], dValue[2], dValue[3], dValue[4], dValue[5]);
+	}
+
+	cTurnaround.resize(m_cJobs.size());
+	for (size_t nIndex = 0; nIndex < m_cJobs.size(); ++ nIndex)
+		cTurnaround[nIndex] = m_cJobs[nIndex].GetTime() - m_cJobs[nIndex].GetArrival();
+	Percentiles(cTurnaround, dValue);
+	log_message("fleet %zu %.2f%% %.2f %.0f %.0f %.0f %.0f %.0f", m_cJobs.size(),
+		dSpan > 0.0 ? 100.0 * nFleetBusy / (dSpan * m_cNodes.size()) : 0.0,
+		dValue[0], dValue[1], dValue[2], dValue[3], dValue[4], dValue[5]);
+}
+
+/**
+ * Switches:
+ * nSwitches: Context switches of every node
+ * nOverhead: Work units spent on them
+ */
+void CCluster::Switches(unsigned long long& nSwitches, unsigned long long& nOverhead) const
+{
+	nSwitches = 0;
+	nOverhead = 0;
+	for (size_t nNode = 0; nNode < m_cNodes.size(); ++ nNode) {
+		nSwitches += m_cNodes[nNode].pEngine->GetSwitches();
+		nOverhead += m_cNodes[nNode].pEngine->GetOverhead();
+	}
+}
+
+/**
+ * ExecuteCluster:
+ *
+ * Route the jobs to a fleet of nodes, each running the scheduling algorithm
+ */
+int CSchedular::ExecuteCluster()
+{
+	debug_log("Entering %s ...", __FUNCTION__);	/* trace log */
+	int nRes = 0;
+	try {
+		log_message("sched -M %u -B %s -j %u for %s", m_nNodes, CCluster::BalanceName(m_nBalance), m_nWorkers ? m_nWorkers : 1,
+			m_pFileName ? m_pFileName : "random jobs");	/* print the command to console */
+
+		CCluster cCluster(m_cList, m_nNodes, m_nBalance, GetSeed(), m_nWorkers);
+		for (size_t nNode = 0; nNode < cCluster.GetNodes(); ++ nNode) {
+			CReadyQueue* pQueue = CreateQueue(cCluster.GetJobs(nNode), cCluster.GetRandom(nNode));
+			if (pQueue == NULL) {
+				err_printf("Invalid scheduling type");
+				return -1;
+			}
+			cCluster.Attach(nNode, pQueue, GetTimeQuantum(), GetSpeed(nNode), GetSwitch());
+		}
+		cCluster.Run();
+		SetTime(cCluster.GetTime());
+
+		nRes = DisplayResult();		/* nodes don't report transitions */
+		if (g_cProgress.Stopped())
+			nRes = -1;		/* partial results, no utilization nor percentiles */
+		else
+			cCluster.Report();
+		if (nRes >= 0 && m_pSwitch) {
+			unsigned long long nSwitches = 0, nOverhead = 0, nBusy = 0;
+			cCluster.Switches(nSwitches, nOverhead);
+			for (size_t nIndex = 0; nIndex < m_cList.size(); ++ nIndex)
+				nBusy += m_cList[nIndex].GetBurst();
+			DisplaySwitches(nSwitches, nOverhead, nBusy);
+		}
+	}
+	catch (std::exception& e) {
+		perr_printf(e.what());
+		nRes = -1;
+	}
+	catch (...) {
+		err_printf("Unknown Exception...");
+		nRes = -1;
+	}
+	debug_log("Exiting %s with code %d (0x%x)...", __FUNCTION__, nRes, nRes);	/* trace log */
+	return nRes;
+}
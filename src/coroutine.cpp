@@ -0,0 +1,310 @@
+/**
+ * Header files
+ */
+#include <algorithm>
+#include <limits.h>
+
+#include "support.h"
+#include "log.h"
+#include "coroutine.h"
+#include "stats.h"
+
+#ifdef HAVE_COROUTINE
+
+/**
+ * await_ready:
+ *
+ * Running job wants more CPU time, it only suspends when it loses the CPU
+ */
+bool CQuantum::await_ready()
+{
+	return m_cScheduler.Grant();
+}
+
+/**
+ * await_suspend:
+ * cHandle: Coroutine of the running job
+ *
+ * CPU burst is done, tell the scheduler how long the job is BLOCKED
+ */
+void CWaitIO::await_suspend(std::coroutine_handle<> cHandle __attribute__((unused)))
+{
+	m_cScheduler.m_nIO = m_nIO;
+	m_cScheduler.m_bBlocked = true;
+}
+
+/**
+ * Constructor
+ */
+CCoroutineScheduler::CCoroutineScheduler(std::vector<CJob>& cJobs, CReadyQueue& cQueue, unsigned long long nQuantum, CEventLog& cLog)
+	: m_cJobs(cJobs), m_cQueue(cQueue), m_cRoutines(cJobs.size()), m_cLog(cLog)
+{
+	m_nNext = 0;
+	m_nQuantum = nQuantum;
+	m_nTime = 0;
+	m_nRunning = NO_JOB;
+	m_nHandoff = NO_JOB;
+	m_nSliceStart = 0;
+	m_nIO = 0;
+	m_bBlocked = false;
+	m_nDone = 0;
+}
+
+/**
+ * Destructor
+ */
+CCoroutineScheduler::~CCoroutineScheduler()
+{
+	for (size_t nIndex = 0; nIndex < m_cRoutines.size(); ++ nIndex) {
+		if (m_cRoutines[nIndex])
+			m_cRoutines[nIndex].destroy();
+	}
+}
+
+/**
+ * Routine:
+ * nIndex: Job index
+ *
+ * Whole life of a job, CPU bursts and I/O bursts in turn
+ */
+CJobRoutine CCoroutineScheduler::Routine(size_t nIndex)
+{
+	CJob& cJob = m_cJobs[nIndex];
+	while (true) {
+		while (cJob.GetRemaining() > 0)
+			co_await CQuantum(*this);
+		if (cJob.IsLastBurst())
+			co_return;
+		co_await CWaitIO(*this, cJob.NextBurst());
+	}
+}
+
+/**
+ * NextEvent:
+ *
+ * Returns time of the next arrival or I/O completion
+ */
+unsigned long long CCoroutineScheduler::NextEvent() const
+{
+	unsigned long long nEvent = ULLONG_MAX;
+	if (m_nNext < m_cPending.size())
+		nEvent = m_cJobs[m_cPending[m_nNext]].GetArrival();
+	if (!m_cBlocked.empty() && m_cBlocked.top().first < nEvent)
+		nEvent = m_cBlocked.top().first;
+	return nEvent;
+}
+
+/**
+ * Release:
+ *
+ * Jobs arrived or done with I/O up to now become READY
+ * Returns true if any job became READY
+ */
+bool CCoroutineScheduler::Release()
+{
+	bool bArrived = false;
+	m_cQueue.SetTime(m_nTime);
+	while (m_nNext < m_cPending.size() &&
+		m_cJobs[m_cPending[m_nNext]].GetArrival() <= m_nTime) {
+		size_t nIndex = m_cPending[m_nNext ++];
+		if (m_cLog.Enabled())
+			m_cLog.Event(m_nTime, m_cJobs[nIndex].GetJob(), 0, EV_READY);
+		m_cQueue.Push(nIndex);
+		g_cStats.Count(STAT_PUSH);
+		bArrived = true;
+	}
+	while (!m_cBlocked.empty() && m_cBlocked.top().first <= m_nTime) {
+		size_t nIndex = m_cBlocked.top().second;
+		m_cBlocked.pop();
+		if (m_cLog.Enabled())
+			m_cLog.Event(m_nTime, m_cJobs[nIndex].GetJob(), 0, EV_WAKEUP);
+		m_cQueue.Push(nIndex);
+		g_cStats.Count(STAT_PUSH);
+		bArrived = true;
+	}
+	return bArrived;
+}
+
+/**
+ * Grant:
+ *
+ * Run the job until its burst is done, its quantum is over, the next job
+ * arrives, or a READY job ages past it, whichever comes first
+ * Returns false if the job must give up the CPU
+ */
+bool CCoroutineScheduler::Grant()
+{
+	CJob& cJob = m_cJobs[m_nRunning];
+	unsigned long long nEnd = TimeAfter(m_nTime, cJob.GetRemaining());
+	if (m_nQuantum && m_nSliceStart + m_nQuantum < nEnd)
+		nEnd = m_nSliceStart + m_nQuantum;
+	unsigned long long nEvent = NextEvent();
+	if (nEvent < nEnd)
+		nEnd = nEvent;
+	unsigned long long nCrossing = m_cQueue.Crossing(m_nRunning);
+	if (nCrossing < nEnd)
+		nEnd = nCrossing;		/* a READY job ages past the running one */
+
+	unsigned long long nDelta = nEnd - m_nTime;
+	g_cStats.Count(STAT_EVENT);
+	g_cStats.Count(STAT_TICK, nDelta);
+	cJob.SetRunning(cJob.GetRunning() + nDelta);
+	if (nDelta)
+		m_cQueue.Charge(m_nRunning, nDelta);
+	m_nTime = nEnd;
+	bool bArrived = Release();
+
+	if (cJob.GetRemaining() == 0)
+		return true;			/* burst is done, the job terminates or blocks */
+	if (m_nQuantum && m_nTime == m_nSliceStart + m_nQuantum) {
+		/**
+		 * Time quantum is finished
+		 * Give the policy a chance to pick another job,
+		 * if it picks the same job again, it just goes on
+		 */
+		m_nSliceStart = m_nTime;
+		if (m_cQueue.Empty())
+			return true;
+		m_cQueue.Push(m_nRunning);
+		m_nHandoff = m_cQueue.Pop();
+		g_cStats.Count(STAT_PUSH);
+		g_cStats.Count(STAT_POP);
+		if (m_nHandoff != m_nRunning) {
+			g_cStats.Count(STAT_ROTATION);
+			return false;
+		}
+		m_nHandoff = NO_JOB;
+		return true;
+	}
+	if ((bArrived || m_nTime >= nCrossing) && m_cQueue.Preempts(m_nRunning)) {
+		g_cStats.Count(STAT_PREEMPTION);
+		g_cStats.Count(STAT_PUSH);
+		m_cQueue.Push(m_nRunning);
+		return false;
+	}
+	return true;
+}
+
+/**
+ * Dispatch:
+ * nIndex: Job selected by the policy
+ *
+ * Resume the job's coroutine until it suspends, then
+ * put it to TERMINATED, BLOCKED or READY (already queued)
+ */
+void CCoroutineScheduler::Dispatch(size_t nIndex)
+{
+	CJob& cJob = m_cJobs[nIndex];
+	if (m_cLog.Enabled())
+		m_cLog.Event(m_nTime, cJob.GetJob(), 0, EV_RUNNING);
+	if (!m_cRoutines[nIndex])
+		m_cRoutines[nIndex] = Routine(nIndex).Handle();
+	m_nRunning = nIndex;
+	m_nSliceStart = m_nTime;
+	m_bBlocked = false;
+	m_cRoutines[nIndex].resume();
+
+	if (m_cRoutines[nIndex].done()) {
+		if (m_cLog.Enabled())
+			m_cLog.Event(m_nTime, cJob.GetJob(), 0, EV_TERMINATED);
+		cJob.SetTime(m_nTime);
+		++ m_nDone;
+		m_cRoutines[nIndex].destroy();
+		m_cRoutines[nIndex] = std::coroutine_handle<>();
+	}
+	else if (m_bBlocked) {
+		if (m_cLog.Enabled())
+			m_cLog.Event(m_nTime, cJob.GetJob(), 0, EV_BLOCKED);
+		m_cBlocked.push(CWakeup(TimeAfter(m_nTime, m_nIO), nIndex));
+	}
+	else if (m_cLog.Enabled())
+		m_cLog.Event(m_nTime, cJob.GetJob(), 0, EV_PREEMPT);
+	m_nRunning = NO_JOB;
+}
+
+/**
+ * Run:
+ *
+ * Resume the job picked by the policy, until every job is terminated
+ * Jobs arriving at same time keep the order of the list
+ * A signal may ask for the progress, or stop the run between two dispatches,
+ * the coroutines left are destroyed with the scheduler
+ */
+void CCoroutineScheduler::Run()
+{
+	debug_log("Entering %s ...", __FUNCTION__);	/* trace log */
+	CProgressWatch cWatch(m_cJobs.size(), g_cStats.Get(STAT_EVENT));
+	m_cPending.resize(m_cJobs.size());
+	for (size_t nIndex = 0; nIndex < m_cPending.size(); ++ nIndex)
+		m_cPending[nIndex] = nIndex;
+	std::stable_sort(m_cPending.begin(), m_cPending.end(), CArrivalOrder(m_cJobs));
+
+	while (true) {
+		if (g_cProgress.Pending() &&
+			g_cProgress.Poll(m_nTime, m_nDone, g_cStats.Get(STAT_EVENT)))
+			break;		/* stopped by a signal, keep the jobs done */
+		Release();
+		size_t nIndex = m_nHandoff;
+		m_nHandoff = NO_JOB;
+		if (nIndex == NO_JOB) {
+			if (m_cQueue.Empty()) {
+				unsigned long long nEvent = NextEvent();
+				if (nEvent == ULLONG_MAX)
+					break;		/* nothing left */
+				g_cStats.Count(STAT_EVENT);
+				g_cStats.Count(STAT_TICK, nEvent - m_nTime);
+				m_nTime = nEvent;	/* CPU is idle until then */
+				continue;
+			}
+			nIndex = m_cQueue.Pop();
+			g_cStats.Count(STAT_POP);
+		}
+		Dispatch(nIndex);
+	}
+	debug_log("Exiting %s at time %d...", __FUNCTION__, m_nTime);	/* trace log */
+}
+
+#endif // HAVE_COROUTINE
+
+/**
+ * ExecuteCoroutine:
+ *
+ * Execute the scheduling algorithm with one coroutine per job
+ */
+int CSchedular::ExecuteCoroutine()
+{
+	debug_log("Entering %s ...", __FUNCTION__);	/* trace log */
+	int nRes = 0;
+#ifdef HAVE_COROUTINE
+	CReadyQueue* pQueue = NULL;
+	try {
+		log_message("sched -c for %s", m_pFileName ? m_pFileName : "random jobs");	/* print command */
+
+		pQueue = CreateQueue(m_cList, m_cRandom);
+		if (pQueue == NULL) {
+			err_printf("Invalid scheduling type");
+			return -1;
+		}
+		CCoroutineScheduler cScheduler(m_cList, *pQueue, GetTimeQuantum(), m_cLog);
+		cScheduler.Run();
+		SetTime(cScheduler.GetTime());
+
+		if (!m_bVerbose)
+			nRes = DisplayResult();
+	}
+	catch (std::exception& e) {
+		perr_printf(e.what());
+		nRes = -1;
+	}
+	catch (...) {
+		err_printf("Unknown Exception...");
+		nRes = -1;
+	}
+	delete pQueue;
+#else
+	err_printf("Coroutines need a C++20 compiler");
+	nRes = -1;
+#endif // HAVE_COROUTINE
+	debug_log("Exiting %s with code %d (0x%x)...", __FUNCTION__, nRes, nRes);	/* trace log */
+	return nRes;
+}
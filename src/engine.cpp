@@ -0,0 +1,369 @@
+/**
+ * Header files
+ */
+#include <algorithm>
+#include <limits.h>
+
+#include "support.h"
+#include "log.h"
+#include "engine.h"
+#include "stats.h"
+
+/**
+ * Constructor
+ */
+CEngine::CEngine(std::vector<CJob>& cJobs, CReadyQueue& cQueue, unsigned long long nQuantum, CEventLog& cLog)
+	: m_cJobs(cJobs), m_cQueue(cQueue), m_cLog(cLog)
+{
+	m_nNext = 0;
+	m_nQuantum = nQuantum;
+	m_nTime = 0;
+	m_nRunning = NO_JOB;
+	m_nSliceStart = 0;
+	m_nSliceEnd = 0;
+	m_nFinish = 0;
+	m_nCrossing = ULLONG_MAX;
+	m_nBusy = 0;
+	m_nTerminated = 0;
+	m_pSpeed = NULL;
+	m_pCost = NULL;
+	m_nLast = NO_JOB;
+	m_nDebt = 0;
+	m_nSwitches = 0;
+	m_nOverhead = 0;
+}
+
+/**
+ * Admit:
+ * nIndex: Job index in the list
+ *
+ * The job will become READY at its arrival time
+ * Jobs are normally admitted in arrival order, which is O(1)
+ */
+void CEngine::Admit(size_t nIndex)
+{
+	unsigned long long nArrival = m_cJobs[nIndex].GetArrival();
+	if (m_nNext == m_cPending.size() ||
+		m_cJobs[m_cPending.back()].GetArrival() <= nArrival) {
+		m_cPending.push_back(nIndex);		/* most common case, in order */
+		return;
+	}
+
+	/**
+	 * Out of order arrival, keep the pending part sorted
+	 */
+	std::vector<size_t>::iterator Iter = m_cPending.begin() + m_nNext;
+	for (; Iter != m_cPending.end(); ++ Iter) {
+		if (m_cJobs[*Iter].GetArrival() > nArrival)
+			break;
+	}
+	m_cPending.insert(Iter, nIndex);
+}
+
+/**
+ * AdmitAll:
+ *
+ * Admit every job of the list, sorted by arrival time
+ * Jobs arriving at same time keep the order of the list
+ */
+void CEngine::AdmitAll()
+{
+	std::vector<size_t> cOrder(m_cJobs.size());
+	for (size_t nIndex = 0; nIndex < cOrder.size(); ++ nIndex)
+		cOrder[nIndex] = nIndex;
+	std::stable_sort(cOrder.begin(), cOrder.end(), CArrivalOrder(m_cJobs));
+	m_cPending.insert(m_cPending.end(), cOrder.begin(), cOrder.end());
+}
+
+/**
+ * NextEvent:
+ *
+ * Returns time of the next event, arrival, I/O completion, end of running slice,
+ * or a READY job aging past the running one
+ */
+unsigned long long CEngine::NextEvent() const
+{
+	unsigned long long nEvent = ULLONG_MAX;
+	if (m_nRunning != NO_JOB)
+		nEvent = std::min(m_nSliceEnd, m_nCrossing);
+	if (m_nNext < m_cPending.size() &&
+		m_cJobs[m_cPending[m_nNext]].GetArrival() < nEvent)
+		nEvent = m_cJobs[m_cPending[m_nNext]].GetArrival();
+	if (!m_cBlocked.empty() && m_cBlocked.top().first < nEvent)
+		nEvent = m_cBlocked.top().first;
+	return nEvent;
+}
+
+/**
+ * NextTermination:
+ *
+ * Returns a time no later than the next termination, ULLONG_MAX if none is left
+ * The running job terminates once its last burst is done, at the end of its slice,
+ * or after as many slices as it needs if nothing else is READY. Any other job
+ * first takes the CPU at an event, a burst may be empty.
+ */
+unsigned long long CEngine::NextTermination() const
+{
+	if (IsIdle())
+		return ULLONG_MAX;
+	unsigned long long nOther = ULLONG_MAX;		/* earliest time another job may take the CPU */
+	if (m_nNext < m_cPending.size())
+		nOther = m_cJobs[m_cPending[m_nNext]].GetArrival();
+	if (!m_cBlocked.empty())
+		nOther = std::min(nOther, m_cBlocked.top().first);
+	if (m_nRunning == NO_JOB)
+		return nOther;			/* the ready queue is empty too */
+
+	unsigned long long nLeave = m_nFinish;	/* the running job leaves the CPU by then */
+	if (!m_cQueue.Empty()) {
+		nLeave = m_nSliceEnd;
+		nOther = std::min(nOther, m_nCrossing);
+	}
+	return std::min(nOther, nLeave);
+}
+
+/**
+ * Account:
+ *
+ * Charge the running job for the time spent since last charge
+ * The policy is charged CPU time, the job progresses by the work done
+ * once the switch is paid
+ */
+void CEngine::Account()
+{
+	unsigned long long nDelta = m_nTime - m_nSliceStart;
+	if (nDelta == 0)
+		return;
+	CJob& cJob = m_cJobs[m_nRunning];
+	if (m_pSpeed || m_pCost) {
+		unsigned long long nWork = Speed().Work(m_nSliceStart, m_nTime);
+		unsigned long long nPaid = std::min(nWork, m_nDebt);
+		m_nDebt -= nPaid;
+		m_nOverhead += nPaid;
+		cJob.Progress(nWork - nPaid);
+	}
+	else
+		cJob.SetRunning(cJob.GetRunning() + nDelta);
+	m_cQueue.Charge(m_nRunning, nDelta);
+	m_nBusy += nDelta;
+	m_nSliceStart = m_nTime;
+	if (m_pCost)
+		m_cOff[m_nRunning] = m_nTime;	/* the job is off the CPU from now, unless it goes on */
+}
+
+/**
+ * Dispatch:
+ *
+ * CPU is idle, put the next READY job to RUNNING
+ */
+void CEngine::Dispatch()
+{
+	if (m_nRunning != NO_JOB || m_cQueue.Empty())
+		return;
+	g_cStats.Count(STAT_POP);
+	Start(m_cQueue.Pop());
+}
+
+/**
+ * Start:
+ * nIndex: Job selected by the policy
+ *
+ * Put the job to RUNNING, it pays the switch if the CPU last ran another job
+ */
+void CEngine::Start(size_t nIndex)
+{
+	m_nDebt = 0;
+	if (m_pCost && nIndex != m_nLast) {
+		if (m_cOff.size() < m_cJobs.size())
+			m_cOff.resize(m_cJobs.size(), ULLONG_MAX);
+		m_nDebt = m_pCost->Cost(m_cOff[nIndex] == ULLONG_MAX ? ULLONG_MAX : m_nTime - m_cOff[nIndex]);
+		++ m_nSwitches;
+	}
+	m_nLast = nIndex;
+	m_nRunning = nIndex;
+	if (m_cLog.Enabled())
+		m_cLog.Event(m_nTime, m_cJobs[nIndex].GetJob(), 0, EV_RUNNING);
+	m_nSliceStart = m_nTime;
+	Slice();
+}
+
+/**
+ * Slice:
+ *
+ * Start a new slice for the running job, until the switch and the job's burst
+ * are done at the speed of the CPU, or one time quantum after the switch is paid
+ * The quantum doesn't count the switch, so every slice does some of the job's
+ * work even if the switch costs more than a quantum
+ */
+void CEngine::Slice()
+{
+	const CJob& cJob = m_cJobs[m_nRunning];
+	unsigned long long nSlice = cJob.GetRemaining();
+	unsigned long long nSwitch = 0;
+	if (m_pSpeed || m_pCost) {
+		nSlice = Speed().Reach(m_nTime, m_nDebt + cJob.GetWorkLeft()) - m_nTime;
+		if (m_nDebt)
+			nSwitch = Speed().Reach(m_nTime, m_nDebt) - m_nTime;
+	}
+	m_nFinish = TimeAfter(m_nTime, nSlice);
+	if (m_nQuantum && m_nQuantum < nSlice - nSwitch)
+		nSlice = nSwitch + m_nQuantum;
+	m_nSliceEnd = TimeAfter(m_nTime, nSlice);
+}
+
+/**
+ * Terminate:
+ *
+ * Running job has finished its burst
+ */
+void CEngine::Terminate()
+{
+	CJob& cJob = m_cJobs[m_nRunning];
+	if (m_cLog.Enabled())
+		m_cLog.Event(m_nTime, cJob.GetJob(), 0, EV_TERMINATED);
+	cJob.SetTime(m_nTime);
+	m_nRunning = NO_JOB;
+	++ m_nTerminated;
+}
+
+/**
+ * Block:
+ *
+ * Running job has finished its CPU burst, it waits for I/O
+ */
+void CEngine::Block()
+{
+	CJob& cJob = m_cJobs[m_nRunning];
+	if (m_cLog.Enabled())
+		m_cLog.Event(m_nTime, cJob.GetJob(), 0, EV_BLOCKED);
+	m_cBlocked.push(CWakeup(TimeAfter(m_nTime, cJob.NextBurst()), m_nRunning));
+	m_nRunning = NO_JOB;
+}
+
+/**
+ * Step:
+ *
+ * Jump to the next event and process it
+ * Arrivals at the same time are queued before the running job gives up the CPU
+ * Returns false when there is nothing left to do
+ */
+bool CEngine::Step()
+{
+	if (IsIdle())
+		return false;
+
+	unsigned long long nEvent = NextEvent();
+	g_cStats.Count(STAT_EVENT);
+	if (nEvent > m_nTime) {
+		g_cStats.Count(STAT_TICK, nEvent - m_nTime);
+		m_nTime = nEvent;
+	}
+	m_cQueue.SetTime(m_nTime);
+
+	bool bArrived = false;
+	while (m_nNext < m_cPending.size() &&
+		m_cJobs[m_cPending[m_nNext]].GetArrival() <= m_nTime) {
+
+		/**
+		 * A job is arrived, put it in Queue
+		 */
+		size_t nIndex = m_cPending[m_nNext ++];
+		if (m_cLog.Enabled())
+			m_cLog.Event(m_nTime, m_cJobs[nIndex].GetJob(), 0, EV_READY);
+		m_cQueue.Push(nIndex);
+		g_cStats.Count(STAT_PUSH);
+		bArrived = true;
+	}
+	while (!m_cBlocked.empty() && m_cBlocked.top().first <= m_nTime) {
+
+		/**
+		 * I/O is complete, job is READY again
+		 */
+		size_t nIndex = m_cBlocked.top().second;
+		m_cBlocked.pop();
+		if (m_cLog.Enabled())
+			m_cLog.Event(m_nTime, m_cJobs[nIndex].GetJob(), 0, EV_WAKEUP);
+		m_cQueue.Push(nIndex);
+		g_cStats.Count(STAT_PUSH);
+		bArrived = true;
+	}
+
+	if (m_nRunning != NO_JOB) {
+		const CJob& cJob = m_cJobs[m_nRunning];
+		if (m_nSliceEnd <= m_nTime) {
+			Account();
+			if (cJob.GetRemaining() == 0 && cJob.IsLastBurst())
+				Terminate();		/* last burst is done */
+			else if (cJob.GetRemaining() == 0)
+				Block();		/* CPU burst is done, wait for I/O */
+			else {
+				/**
+				 * Time quantum is finished
+				 * Give the policy a chance to pick another job,
+				 * if it picks the same job again, just keep it RUNNING
+				 */
+				size_t nIndex = m_nRunning;
+				size_t nNext = nIndex;
+				if (!m_cQueue.Empty()) {
+					m_cQueue.Push(nIndex);
+					nNext = m_cQueue.Pop();
+					g_cStats.Count(STAT_PUSH);
+					g_cStats.Count(STAT_POP);
+				}
+				if (nNext != nIndex) {
+					g_cStats.Count(STAT_ROTATION);
+					if (m_cLog.Enabled())
+						m_cLog.Event(m_nTime, cJob.GetJob(), 0, EV_PREEMPT);
+					Start(nNext);
+				}
+				else
+					Slice();
+			}
+		}
+		else if (bArrived || m_nCrossing <= m_nTime) {
+			/**
+			 * New or woken up job(s), or a job which waited long enough,
+			 * may preempt the running job
+			 */
+			Account();
+			if (m_cQueue.Preempts(m_nRunning)) {
+				g_cStats.Count(STAT_PREEMPTION);
+				g_cStats.Count(STAT_PUSH);
+				if (m_cLog.Enabled())
+					m_cLog.Event(m_nTime, cJob.GetJob(), 0, EV_PREEMPT);
+				m_cQueue.Push(m_nRunning);
+				m_nRunning = NO_JOB;
+			}
+		}
+	}
+
+	Dispatch();
+	m_nCrossing = m_nRunning != NO_JOB ? m_cQueue.Crossing(m_nRunning) : ULLONG_MAX;
+	return true;
+}
+
+/**
+ * AdvanceTo:
+ * nTime: Time of the next arrival
+ *
+ * Process the events before this time, events at the same time
+ * wait, so the new job is queued first like in a batch run
+ */
+void CEngine::AdvanceTo(unsigned long long nTime)
+{
+	while (!IsIdle() && NextEvent() < nTime)
+		Step();
+}
+
+/**
+ * Run:
+ *
+ * Process events until all jobs are terminated
+ */
+void CEngine::Run()
+{
+	debug_log("Entering %s ...", __FUNCTION__);	/* trace log */
+	while (Step())
+		;
+	debug_log("Exiting %s at time %llu...", __FUNCTION__, m_nTime);	/* trace log */
+}
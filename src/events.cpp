@@ -0,0 +1,781 @@
+/**
+ * Header files
+ */
+#include <algorithm>
+#include <string>
+#include <limits.h>
+#include <strings.h>
+
+#include "support.h"
+#include "log.h"
+#include "events.h"
+
+/**
+ * Name of each transition for the verbose output
+ */
+static const char* g_pEventName[EV_MAX] = {
+	"READY",
+	"READY->RUNNING",
+	"RUNNING->READY",
+	"RUNNING->BLOCKED",
+	"BLOCKED->READY",
+	"RUNNING->TERMINATED",
+};
+
+/**
+ * Name of each transition for the filter expressions
+ */
+static const char* g_pEventKey[EV_MAX] = {
+	"ready",
+	"running",
+	"preempt",
+	"blocked",
+	"wakeup",
+	"terminated",
+};
+
+/**
+ * Constructor
+ */
+CEventFilter::CEventFilter()
+{
+	m_nFrom = 0;
+	m_nTo = ULLONG_MAX;
+	m_nEvents = (1u << EV_MAX) - 1;
+	m_nSample = 1;
+	m_nSeen = 0;
+}
+
+/**
+ * ParseRange:
+ * csItem: "N", "N-M", "N-" or "-M"
+ * nFirst, nLast: Range, open ends are left unchanged
+ */
+static int ParseRange(const std::string& csItem, unsigned long long& nFirst, unsigned long long& nLast)
+{
+	size_t nDash = csItem.find('-');
+	std::string csFirst = csItem.substr(0, nDash);
+	std::string csLast = nDash == std::string::npos ? csFirst : csItem.substr(nDash + 1);
+	if (csFirst.empty() && csLast.empty())
+		return -1;
+	if (csFirst.find_first_not_of("0123456789") != std::string::npos ||
+		csLast.find_first_not_of("0123456789") != std::string::npos)
+		return -1;
+	if (!csFirst.empty())
+		nFirst = strtoull(csFirst.c_str(), NULL, 10);
+	if (!csLast.empty())
+		nLast = strtoull(csLast.c_str(), NULL, 10);
+	return nFirst <= nLast ? 0 : -1;
+}
+
+/**
+ * Parse:
+ * pExpression: Terms separated by ",", see CEventFilter
+ *
+ * Returns -1 if the expression can't be parsed
+ */
+int CEventFilter::Parse(const char* pExpression)
+{
+	std::string csExpression(pExpression);
+	size_t nStart = 0;
+	while (nStart <= csExpression.size()) {
+		size_t nEnd = csExpression.find(',', nStart);
+		if (nEnd == std::string::npos)
+			nEnd = csExpression.size();
+		std::string csTerm = csExpression.substr(nStart, nEnd - nStart);
+		nStart = nEnd + 1;
+
+		size_t nEqual = csTerm.find('=');
+		if (nEqual == std::string::npos)
+			return -1;
+		std::string csName = csTerm.substr(0, nEqual);
+		std::string csValue = csTerm.substr(nEqual + 1);
+		if (csName == "sample") {
+			unsigned long long nFirst = 0, nLast = 0;
+			if (csValue.find('-') != std::string::npos || ParseRange(csValue, nFirst, nLast) < 0 || nFirst == 0 || nFirst > UINT_MAX)
+				return -1;
+			m_nSample = nFirst;
+			continue;
+		}
+		if (csName == "time") {
+			if (ParseRange(csValue, m_nFrom, m_nTo) < 0)
+				return -1;
+			continue;
+		}
+		if (csName != "job" && csName != "event")
+			return -1;
+		if (csName == "event")
+			m_nEvents = 0;
+
+		/**
+		 * List of items separated by ":"
+		 */
+		size_t nItem = 0;
+		while (nItem <= csValue.size()) {
+			size_t nColon = csValue.find(':', nItem);
+			if (nColon == std::string::npos)
+				nColon = csValue.size();
+			std::string csItem = csValue.substr(nItem, nColon - nItem);
+			nItem = nColon + 1;
+			if (csName == "job") {
+				unsigned long long nFirst = 0, nLast = UINT_MAX;
+				if (ParseRange(csItem, nFirst, nLast) < 0 || nLast > UINT_MAX)
+					return -1;
+				m_cJobs.push_back(CRange(nFirst, nLast));
+				continue;
+			}
+			int nEvent = 0;
+			for (; nEvent < EV_MAX; ++ nEvent) {
+				if (strcasecmp(csItem.c_str(), g_pEventKey[nEvent]) == 0)
+					break;
+			}
+			if (nEvent == EV_MAX)
+				return -1;
+			m_nEvents |= 1u << nEvent;
+		}
+	}
+
+	/**
+	 * Sort and merge the job ranges, for the binary search
+	 */
+	std::sort(m_cJobs.begin(), m_cJobs.end());
+	std::vector<CRange> cMerged;
+	for (size_t nRange = 0; nRange < m_cJobs.size(); ++ nRange) {
+		if (!cMerged.empty() && m_cJobs[nRange].first <= cMerged.back().second + 1ULL) {
+			if (m_cJobs[nRange].second > cMerged.back().second)
+				cMerged.back().second = m_cJobs[nRange].second;
+		}
+		else
+			cMerged.push_back(m_cJobs[nRange]);
+	}
+	m_cJobs.swap(cMerged);
+	return 0;
+}
+
+/**
+ * Match:
+ * nJob: Job number
+ *
+ * Binary search of the last range starting at or before the job
+ */
+bool CEventFilter::Match(unsigned int nJob) const
+{
+	std::vector<CRange>::const_iterator cIter = std::upper_bound(m_cJobs.begin(), m_cJobs.end(), CRange(nJob, UINT_MAX));
+	if (cIter == m_cJobs.begin())
+		return false;
+	-- cIter;
+	return nJob <= cIter->second;
+}
+
+/**
+ * Destructor
+ */
+CEventLog::~CEventLog()
+{
+	Clear();
+}
+
+/**
+ * Add:
+ * pSink: New sink, deleted with the log
+ * bFiltered: Sink only gets the transitions passing the filter
+ */
+void CEventLog::Add(CEventSink* pSink, bool bFiltered)
+{
+	m_cSinks.push_back(pSink);
+	m_cFiltered.push_back(bFiltered);
+}
+
+/**
+ * Flush:
+ * nTime: End of the run
+ *
+ * End of the run, flush all the sinks
+ */
+void CEventLog::Flush(unsigned long long nTime)
+{
+	for (size_t nSink = 0; nSink < m_cSinks.size(); ++ nSink)
+		m_cSinks[nSink]->Flush(nTime);
+}
+
+/**
+ * Clear:
+ *
+ * Remove and delete all the sinks
+ */
+void CEventLog::Clear()
+{
+	for (size_t nSink = 0; nSink < m_cSinks.size(); ++ nSink)
+		delete m_cSinks[nSink];
+	m_cSinks.clear();
+	m_cFiltered.clear();
+}
+
+/**
+ * Event:
+ *
+ * Print the transition
+ */
+void CVerboseSink::Event(unsigned long long nTime, unsigned int nJob, unsigned int nCpu __attribute__((unused)), int nEvent)
+{
+	log_message("At time %llu, job %d %s", nTime, nJob, g_pEventName[nEvent]);
+}
+
+/**
+ * Event:
+ *
+ * Print the job and its termination time, flushed right away
+ */
+void CTerminationSink::Event(unsigned long long nTime, unsigned int nJob, unsigned int nCpu __attribute__((unused)), int nEvent)
+{
+	if (nEvent == EV_TERMINATED)
+		log_message("%d %llu", nJob, nTime);
+}
+
+/**
+ * Constructor
+ */
+CGanttSink::CGanttSink(const char* pFileName, bool bBinary)
+{
+	m_bBinary = bBinary;
+	m_bLast = false;
+	if (strcmp(pFileName, "-") == 0)
+		m_pFile = stdout;
+	else
+		m_pFile = fopen(pFileName, bBinary ? "wb" : "w");
+	if (m_pFile == NULL) {
+		perr_printf("Failed to open %s", pFileName);
+		return;
+	}
+	if (m_bBinary)
+		fwrite(GANTT_MAGIC, 1, 4, m_pFile);
+}
+
+/**
+ * Destructor
+ */
+CGanttSink::~CGanttSink()
+{
+	Flush(0);
+	if (m_pFile && m_pFile != stdout)
+		fclose(m_pFile);
+}
+
+/**
+ * Event:
+ *
+ * A slice opens when a job starts RUNNING, and closes when it leaves the CPU
+ */
+void CGanttSink::Event(unsigned long long nTime, unsigned int nJob, unsigned int nCpu, int nEvent)
+{
+	if (nCpu >= m_cOpen.size()) {
+		m_cOpen.resize(nCpu + 1);
+		m_cBusy.resize(nCpu + 1, false);
+	}
+
+	switch (nEvent) {
+	case EV_RUNNING:
+		Close(nCpu, nTime);	/* missed the previous job leaving the CPU */
+		m_cOpen[nCpu].nJob = nJob;
+		m_cOpen[nCpu].nCpu = nCpu;
+		m_cOpen[nCpu].nStart = nTime;
+		m_cBusy[nCpu] = true;
+		break;
+	case EV_PREEMPT:
+	case EV_BLOCKED:
+	case EV_TERMINATED:
+		if (m_cBusy[nCpu] && m_cOpen[nCpu].nJob == nJob)
+			Close(nCpu, nTime);
+		break;
+	default:
+		break;
+	}
+}
+
+/**
+ * Close:
+ * nCpu: CPU number
+ * nTime: End of the slice
+ */
+void CGanttSink::Close(unsigned int nCpu, unsigned long long nTime)
+{
+	if (!m_cBusy[nCpu])
+		return;
+	m_cBusy[nCpu] = false;
+	m_cOpen[nCpu].nEnd = nTime;
+	Write(m_cOpen[nCpu]);
+}
+
+/**
+ * Write:
+ * cSlice: Closed slice
+ *
+ * Slices of the same job on the same CPU back to back are merged into one record
+ */
+void CGanttSink::Write(const CSlice& cSlice)
+{
+	if (m_bLast &&
+		m_cLast.nJob == cSlice.nJob &&
+		m_cLast.nCpu == cSlice.nCpu &&
+		m_cLast.nEnd == cSlice.nStart) {
+		m_cLast.nEnd = cSlice.nEnd;
+		return;
+	}
+	if (m_bLast)
+		Emit(m_cLast);
+	m_cLast = cSlice;
+	m_bLast = true;
+}
+
+/**
+ * Emit:
+ * cSlice: Record to write to the file
+ */
+void CGanttSink::Emit(const CSlice& cSlice)
+{
+	if (m_pFile == NULL)
+		return;
+	if (m_bBinary) {
+		unsigned int nWhere[2] = { cSlice.nJob, cSlice.nCpu };
+		unsigned long long nWhen[2] = { cSlice.nStart, cSlice.nEnd };
+		fwrite(nWhere, sizeof(nWhere), 1, m_pFile);
+		fwrite(nWhen, sizeof(nWhen), 1, m_pFile);
+	}
+	else
+		fprintf(m_pFile, "%u %u %llu %llu\n", cSlice.nJob, cSlice.nCpu, cSlice.nStart, cSlice.nEnd);
+}
+
+/**
+ * Flush:
+ * nTime: End of the run
+ *
+ * End of the run, close the open slices there and write the last record
+ * A slice which starts at the end is dropped, the job didn't run
+ */
+void CGanttSink::Flush(unsigned long long nTime)
+{
+	for (unsigned int nCpu = 0; nCpu < m_cBusy.size(); ++ nCpu) {
+		if (m_cBusy[nCpu] && nTime > m_cOpen[nCpu].nStart)
+			Close(nCpu, nTime);
+		m_cBusy[nCpu] = false;
+	}
+	if (m_bLast)
+		Emit(m_cLast);
+	m_bLast = false;
+	if (m_pFile)
+		fflush(m_pFile);
+}
+
+/**
+ * Track of each kind, in the trace
+ */
+#define TRACE_CPUS 1			/* Process of the CPU tracks */
+#define TRACE_JOBS 2			/* Process of the job tracks */
+
+/**
+ * Job state opened by each transition, for the job tracks
+ */
+enum _trace_states {
+	TRACE_READY = 0,
+	TRACE_RUNNING,
+	TRACE_BLOCKED,
+	TRACE_NONE,
+};
+static const char* g_pStateName[TRACE_NONE] = {
+	"READY",
+	"RUNNING",
+	"BLOCKED",
+};
+static const int g_nEventState[EV_MAX] = {
+	TRACE_READY,		/* EV_READY */
+	TRACE_RUNNING,		/* EV_RUNNING */
+	TRACE_READY,		/* EV_PREEMPT */
+	TRACE_BLOCKED,		/* EV_BLOCKED */
+	TRACE_READY,		/* EV_WAKEUP */
+	TRACE_NONE,		/* EV_TERMINATED */
+};
+
+/**
+ * Constructor
+ */
+CTraceSink::CTraceSink(const char* pFileName)
+{
+	m_bFirst = true;
+	m_pBuffer = NULL;
+	if (strcmp(pFileName, "-") == 0)
+		m_pFile = stdout;
+	else
+		m_pFile = fopen(pFileName, "w");
+	if (m_pFile == NULL) {
+		perr_printf("Failed to open %s", pFileName);
+		return;
+	}
+	if (m_pFile != stdout) {
+		m_pBuffer = new char[TRACE_BUFFER];
+		setvbuf(m_pFile, m_pBuffer, _IOFBF, TRACE_BUFFER);
+	}
+	fprintf(m_pFile, "{\"traceEvents\":[\n");
+	fprintf(m_pFile, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%d,\"args\":{\"name\":\"CPUs\"}},\n", TRACE_CPUS);
+	fprintf(m_pFile, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%d,\"args\":{\"name\":\"Jobs\"}}", TRACE_JOBS);
+}
+
+/**
+ * Destructor
+ */
+CTraceSink::~CTraceSink()
+{
+	Flush(0);
+	if (m_pFile) {
+		fprintf(m_pFile, "\n]}\n");
+		if (m_pFile != stdout)
+			fclose(m_pFile);
+		else
+			fflush(m_pFile);
+	}
+	delete [] m_pBuffer;
+}
+
+/**
+ * Slice:
+ * nPid, nTid: Track of the slice
+ * pName: Name of the slice
+ * nStart, nEnd: Time of the slice
+ */
+void CTraceSink::Slice(unsigned int nPid, unsigned int nTid, const char* pName, unsigned long long nStart, unsigned long long nEnd)
+{
+	if (m_pFile == NULL)
+		return;
+	fprintf(m_pFile, ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":%u,\"tid\":%u,\"ts\":%llu,\"dur\":%llu}",
+		pName, nPid, nTid, nStart, nEnd - nStart);
+}
+
+/**
+ * Name:
+ * nPid, nTid: Track to name
+ * pKind: "CPU" or "job"
+ * nNumber: CPU or job number
+ */
+void CTraceSink::Name(unsigned int nPid, unsigned int nTid, const char* pKind, unsigned int nNumber)
+{
+	if (m_pFile == NULL)
+		return;
+	fprintf(m_pFile, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%u,\"tid\":%u,\"args\":{\"name\":\"%s %u\"}}",
+		nPid, nTid, pKind, nNumber);
+}
+
+/**
+ * CloseJob:
+ * cJob: Open state of the job
+ * nJob: Job number
+ * nTime: End of the state
+ */
+void CTraceSink::CloseJob(COpen& cJob, unsigned int nJob, unsigned long long nTime)
+{
+	if (!cJob.bOpen)
+		return;
+	if (nTime > cJob.nStart)		/* READY and dispatched right away, nothing to show */
+		Slice(TRACE_JOBS, nJob, g_pStateName[cJob.nValue], cJob.nStart, nTime);
+	cJob.bOpen = false;
+}
+
+/**
+ * CloseCpu:
+ * nCpu: CPU number
+ * nTime: End of the run
+ */
+void CTraceSink::CloseCpu(unsigned int nCpu, unsigned long long nTime)
+{
+	COpen& cCpu = m_cCpus[nCpu];
+	if (!cCpu.bOpen)
+		return;
+	char pName[32];
+	snprintf(pName, sizeof(pName), "job %u", cCpu.nValue);
+	Slice(TRACE_CPUS, nCpu, pName, cCpu.nStart, nTime);
+	cCpu.bOpen = false;
+}
+
+/**
+ * Event:
+ *
+ * Each transition closes the previous state of the job, and opens the next one
+ * A job leaving the CPU closes the run on that CPU
+ */
+void CTraceSink::Event(unsigned long long nTime, unsigned int nJob, unsigned int nCpu, int nEvent)
+{
+	if (nCpu >= m_cCpus.size()) {
+		COpen cIdle = { 0, 0, false };
+		for (unsigned int nNew = m_cCpus.size(); nNew <= nCpu; ++ nNew)
+			Name(TRACE_CPUS, nNew, "CPU", nNew);
+		m_cCpus.resize(nCpu + 1, cIdle);
+	}
+
+	std::unordered_map<unsigned int, COpen>::iterator cIter = m_cJobs.find(nJob);
+	if (cIter == m_cJobs.end()) {
+		COpen cNew = { nTime, TRACE_NONE, false };
+		cIter = m_cJobs.insert(std::make_pair(nJob, cNew)).first;
+		Name(TRACE_JOBS, nJob, "job", nJob);
+	}
+	COpen& cJob = cIter->second;
+	CloseJob(cJob, nJob, nTime);
+
+	if (nEvent == EV_RUNNING) {
+		CloseCpu(nCpu, nTime);		/* missed the previous job leaving the CPU */
+		m_cCpus[nCpu].nStart = nTime;
+		m_cCpus[nCpu].nValue = nJob;
+		m_cCpus[nCpu].bOpen = true;
+	}
+	else if (nEvent == EV_PREEMPT || nEvent == EV_BLOCKED || nEvent == EV_TERMINATED) {
+		if (m_cCpus[nCpu].bOpen && m_cCpus[nCpu].nValue == nJob)
+			CloseCpu(nCpu, nTime);
+	}
+
+	if (g_nEventState[nEvent] == TRACE_NONE) {
+		m_cJobs.erase(cIter);		/* job left the system */
+		return;
+	}
+	cJob.nStart = nTime;
+	cJob.nValue = g_nEventState[nEvent];
+	cJob.bOpen = true;
+}
+
+/**
+ * Flush:
+ * nTime: End of the run
+ *
+ * End of the run, the runs and job states still open (a signal stopped
+ * the run) close there, the empty ones are dropped like any other
+ */
+void CTraceSink::Flush(unsigned long long nTime)
+{
+	for (unsigned int nCpu = 0; nCpu < m_cCpus.size(); ++ nCpu) {
+		if (m_cCpus[nCpu].bOpen && nTime > m_cCpus[nCpu].nStart)
+			CloseCpu(nCpu, nTime);
+		m_cCpus[nCpu].bOpen = false;
+	}
+	for (std::unordered_map<unsigned int, COpen>::iterator cIter = m_cJobs.begin();
+		cIter != m_cJobs.end();
+		++ cIter)
+		CloseJob(cIter->second, cIter->first, std::max(nTime, cIter->second.nStart));
+	m_cJobs.clear();
+	if (m_pFile)
+		fflush(m_pFile);
+}
+
+/**
+ * Constructor
+ * pFileName: Output file, - for console
+ * nWidth: Window width, 0 to fit the whole horizon in METRICS_WINDOWS windows
+ */
+CMetricsSink::CMetricsSink(const char* pFileName, unsigned long long nWidth)
+	: m_cWindows(METRICS_WINDOWS, CWindow())
+{
+	size_t nLength = strlen(pFileName);
+	m_bJson = nLength >= 5 && strcasecmp(pFileName + nLength - 5, ".json") == 0;
+	m_bAuto = nWidth == 0;
+	m_nWidth = nWidth ? nWidth : 1;
+	m_nFirst = 0;
+	m_nEnd = 0;
+	m_nLast = 0;
+	m_nDepth = 0;
+	m_nRunning = 0;
+	m_nCpus = 1;
+	m_bFirst = true;
+	if (strcmp(pFileName, "-") == 0)
+		m_pFile = stdout;
+	else
+		m_pFile = fopen(pFileName, "w");
+	if (m_pFile == NULL) {
+		perr_printf("Failed to open %s", pFileName);
+		return;
+	}
+	if (m_bJson)
+		fprintf(m_pFile, "[");
+	else
+		fprintf(m_pFile, "start,end,completions,mean_depth,max_depth,utilization,mean_wait\n");
+}
+
+/**
+ * Destructor
+ */
+CMetricsSink::~CMetricsSink()
+{
+	Flush(0);
+	if (m_pFile) {
+		if (m_bJson)
+			fprintf(m_pFile, "\n]\n");
+		if (m_pFile != stdout)
+			fclose(m_pFile);
+		else
+			fflush(m_pFile);
+	}
+}
+
+/**
+ * Emit:
+ * nWindow: Oldest window not written
+ */
+void CMetricsSink::Emit(unsigned long long nWindow)
+{
+	CWindow& cWindow = m_cWindows[nWindow % METRICS_WINDOWS];
+	unsigned long long nStart = nWindow * m_nWidth;
+	unsigned long long nEnd = nStart + m_nWidth;
+	if (nEnd > m_nLast)
+		nEnd = m_nLast > nStart ? m_nLast : nStart;	/* last window is cut at the current time */
+	unsigned long long nLength = nEnd - nStart;
+	double dDepth = nLength ? (double) cWindow.nDepth / nLength : 0.0;
+	double dUtilization = nLength ? (double) cWindow.nBusy / (nLength * m_nCpus) : 0.0;
+	double dWait = cWindow.nDispatched ? (double) cWindow.nWait / cWindow.nDispatched : 0.0;
+	if (m_pFile) {
+		if (m_bJson)
+			fprintf(m_pFile, "%s\n{\"start\":%llu,\"end\":%llu,\"completions\":%u,\"mean_depth\":%.3f,\"max_depth\":%u,\"utilization\":%.4f,\"mean_wait\":%.3f}",
+				m_bFirst ? "" : ",", nStart, nEnd, cWindow.nCompleted, dDepth, cWindow.nMaxDepth, dUtilization, dWait);
+		else
+			fprintf(m_pFile, "%llu,%llu,%u,%.3f,%u,%.4f,%.3f\n",
+				nStart, nEnd, cWindow.nCompleted, dDepth, cWindow.nMaxDepth, dUtilization, dWait);
+	}
+	m_bFirst = false;
+	cWindow = CWindow();
+	++ m_nFirst;
+	if (m_nEnd < m_nFirst)
+		m_nEnd = m_nFirst;
+}
+
+/**
+ * Downsample:
+ *
+ * Windows 2n and 2n+1 become window n of twice the width
+ */
+void CMetricsSink::Downsample()
+{
+	size_t nCount = (m_nEnd + 1) / 2;
+	for (size_t nIndex = 0; nIndex < nCount; ++ nIndex) {
+		CWindow cMerged = m_cWindows[2 * nIndex];
+		if (2 * nIndex + 1 < m_nEnd) {
+			const CWindow& cOther = m_cWindows[2 * nIndex + 1];
+			cMerged.nDepth += cOther.nDepth;
+			cMerged.nBusy += cOther.nBusy;
+			cMerged.nWait += cOther.nWait;
+			cMerged.nMaxDepth = std::max(cMerged.nMaxDepth, cOther.nMaxDepth);
+			cMerged.nCompleted += cOther.nCompleted;
+			cMerged.nDispatched += cOther.nDispatched;
+		}
+		m_cWindows[nIndex] = cMerged;
+	}
+	for (size_t nIndex = nCount; nIndex < m_nEnd; ++ nIndex)
+		m_cWindows[nIndex] = CWindow();
+	m_nEnd = nCount;
+	m_nWidth *= 2;
+	debug_log("Metrics window is now %llu", m_nWidth);
+}
+
+/**
+ * Window:
+ * nTime: Time in the window
+ *
+ * Make room in the ring for the window of nTime, writing or merging older windows
+ * Time before the oldest window in the ring goes to the oldest window
+ */
+CMetricsSink::CWindow& CMetricsSink::Window(unsigned long long nTime)
+{
+	unsigned long long nWindow = nTime / m_nWidth;
+	while (nWindow >= m_nFirst + METRICS_WINDOWS) {
+		if (m_bAuto) {
+			Downsample();
+			nWindow = nTime / m_nWidth;
+		}
+		else
+			Emit(m_nFirst);
+	}
+	if (nWindow < m_nFirst)
+		nWindow = m_nFirst;
+	if (nWindow >= m_nEnd)
+		m_nEnd = nWindow + 1;
+	return m_cWindows[nWindow % METRICS_WINDOWS];
+}
+
+/**
+ * Advance:
+ * nTime: Time of the next transition
+ *
+ * Queue depth and running jobs didn't change since the last transition,
+ * add them to each window up to nTime
+ */
+void CMetricsSink::Advance(unsigned long long nTime)
+{
+	while (m_nLast < nTime) {
+		CWindow& cWindow = Window(m_nLast);
+		unsigned long long nEnd = (m_nLast / m_nWidth + 1) * m_nWidth;
+		if (nEnd > nTime)
+			nEnd = nTime;
+		unsigned long long nDelta = nEnd - m_nLast;
+		cWindow.nDepth += nDelta * m_nDepth;
+		cWindow.nBusy += nDelta * m_nRunning;
+		if (m_nDepth > cWindow.nMaxDepth)
+			cWindow.nMaxDepth = m_nDepth;
+		m_nLast = nEnd;
+	}
+}
+
+/**
+ * Event:
+ *
+ * Dispatches and arrivals count in the window they happen in,
+ * terminations in the window of the last time unit the job ran
+ */
+void CMetricsSink::Event(unsigned long long nTime, unsigned int nJob, unsigned int nCpu, int nEvent)
+{
+	Advance(nTime);
+	if (nCpu >= m_nCpus)
+		m_nCpus = nCpu + 1;
+	switch (nEvent) {
+	case EV_PREEMPT:
+		if (m_nRunning)
+			-- m_nRunning;
+		/* fall through */
+	case EV_READY:
+	case EV_WAKEUP: {
+		CWindow& cWindow = Window(nTime);
+		m_cReady[nJob] = nTime;
+		if (++ m_nDepth > cWindow.nMaxDepth)
+			cWindow.nMaxDepth = m_nDepth;
+		break;
+	}
+	case EV_RUNNING: {
+		CWindow& cWindow = Window(nTime);
+		std::unordered_map<unsigned int, unsigned long long>::iterator cIter = m_cReady.find(nJob);
+		if (cIter != m_cReady.end()) {
+			cWindow.nWait += nTime - cIter->second;
+			m_cReady.erase(cIter);
+		}
+		++ cWindow.nDispatched;
+		if (m_nDepth)
+			-- m_nDepth;
+		++ m_nRunning;
+		break;
+	}
+	case EV_BLOCKED:
+		if (m_nRunning)
+			-- m_nRunning;
+		break;
+	case EV_TERMINATED:
+		if (m_nRunning)
+			-- m_nRunning;
+		++ Window(nTime ? nTime - 1 : 0).nCompleted;
+		break;
+	}
+}
+
+/**
+ * Flush:
+ * nTime: End of the run
+ *
+ * Integrate up to the end, and write the windows still in the ring
+ */
+void CMetricsSink::Flush(unsigned long long nTime)
+{
+	Advance(nTime);
+	while (m_nFirst < m_nEnd)
+		Emit(m_nFirst);
+	if (m_pFile)
+		fflush(m_pFile);
+}
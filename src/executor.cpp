@@ -0,0 +1,239 @@
+/**
+ * Header files
+ */
+#include <algorithm>
+#include <thread>
+
+#include "support.h"
+#include "log.h"
+#include "executor.h"
+
+#define CALIBRATE_US 20000		/* Shortest calibration run, in microseconds */
+
+/**
+ * Constructor
+ */
+CExecutor::CExecutor(std::vector<CJob>& cJobs, CReadyQueue& cQueue, unsigned long long nQuantum, unsigned int nWorkers, unsigned int nUnit)
+	: m_cJobs(cJobs), m_cQueue(cQueue), m_cTasks(cJobs.size()), m_cFinish(cJobs.size(), 0.0)
+{
+	m_nQuantum = nQuantum;
+	m_nWorkers = nWorkers ? nWorkers : 1;
+	m_nUnit = nUnit ? nUnit : 1;
+	m_nRounds = 0;
+	m_nDone = 0;
+}
+
+/**
+ * Register:
+ * nIndex: Job index
+ * cTask: Work of the job, called once per time unit until it returns false
+ */
+void CExecutor::Register(size_t nIndex, const CTask& cTask)
+{
+	m_cTasks[nIndex] = cTask;
+}
+
+/**
+ * Spin:
+ *
+ * CPU bound loop, m_nRounds rounds take one time unit
+ */
+void CExecutor::Spin() const
+{
+	volatile uint64_t nState = 88172645463325252ULL;
+	for (unsigned long long nRound = 0; nRound < m_nRounds; ++ nRound) {
+		uint64_t nValue = nState;
+		nValue ^= nValue << 13;
+		nValue ^= nValue >> 7;
+		nValue ^= nValue << 17;
+		nState = nValue;
+	}
+}
+
+/**
+ * Calibrate:
+ *
+ * Double the spin rounds until a run is long enough to be measured,
+ * then scale them to one time unit
+ */
+void CExecutor::Calibrate()
+{
+	for (m_nRounds = 1024; ; m_nRounds <<= 1) {
+		CClock::time_point cBegin = CClock::now();
+		Spin();
+		long long nElapsed = std::chrono::duration_cast<std::chrono::microseconds>(CClock::now() - cBegin).count();
+		if (nElapsed >= CALIBRATE_US) {
+			m_nRounds = m_nRounds * m_nUnit / nElapsed;
+			break;
+		}
+	}
+	if (m_nRounds == 0)
+		m_nRounds = 1;
+	debug_log("%llu spin rounds per %u us", m_nRounds, m_nUnit);
+}
+
+/**
+ * Now:
+ *
+ * Returns wall clock time since start, in time units
+ */
+double CExecutor::Now() const
+{
+	return std::chrono::duration<double, std::micro>(CClock::now() - m_cStart).count() / m_nUnit;
+}
+
+/**
+ * Worker:
+ *
+ * Take the policy's next job, and run it one unit at a time.
+ * Between units the job gives the CPU back when its quantum is over
+ * and another job is READY, or when a READY job preempts it.
+ */
+void CExecutor::Worker()
+{
+	std::unique_lock<std::mutex> cGuard(m_cLock);
+	while (true) {
+		while (m_cQueue.Empty() && m_nDone < m_cJobs.size())
+			m_cCond.wait(cGuard);
+		if (m_nDone == m_cJobs.size())
+			break;
+
+		m_cQueue.SetTime((unsigned long long) Now());
+		size_t nIndex = m_cQueue.Pop();
+		CJob& cJob = m_cJobs[nIndex];
+		unsigned long long nSlice = 0;
+		bool bMore = true;
+		while (true) {
+			cGuard.unlock();
+			if (m_cTasks[nIndex])
+				bMore = m_cTasks[nIndex]();
+			else {
+				Spin();
+				bMore = cJob.GetRemaining() > 1;	/* only this worker changes the running time */
+			}
+			cGuard.lock();
+
+			/* yield point */
+			if (cJob.GetRemaining() > 0)
+				cJob.SetRunning(cJob.GetRunning() + 1);
+			++ nSlice;
+			m_cQueue.SetTime((unsigned long long) Now());
+			if (!bMore)
+				break;
+			if (!m_cQueue.Empty() && m_cQueue.Preempts(nIndex))
+				break;				/* better job is READY */
+			if (m_nQuantum > 0 && nSlice % m_nQuantum == 0 && !m_cQueue.Empty())
+				break;				/* quantum is over, policy picks again */
+		}
+
+		m_cQueue.Charge(nIndex, nSlice);
+		if (bMore) {
+			m_cQueue.Push(nIndex);
+			m_cCond.notify_one();
+		}
+		else {
+			m_cFinish[nIndex] = Now();
+			if (++ m_nDone == m_cJobs.size())
+				m_cCond.notify_all();
+		}
+	}
+}
+
+/**
+ * Run:
+ *
+ * Calibrate the spin, start the workers, and release each job
+ * at its arrival time
+ */
+void CExecutor::Run()
+{
+	debug_log("Entering %s ...", __FUNCTION__);	/* trace log */
+	Calibrate();
+
+	std::vector<size_t> cOrder(m_cJobs.size());
+	for (size_t nIndex = 0; nIndex < cOrder.size(); ++ nIndex)
+		cOrder[nIndex] = nIndex;
+	std::stable_sort(cOrder.begin(), cOrder.end(), CArrivalOrder(m_cJobs));
+
+	std::vector<std::thread> cThreads;
+	m_cStart = CClock::now();
+	for (unsigned int nWorker = 0; nWorker < m_nWorkers; ++ nWorker)
+		cThreads.push_back(std::thread(&CExecutor::Worker, this));
+
+	for (size_t nNext = 0; nNext < cOrder.size(); ++ nNext) {
+		size_t nIndex = cOrder[nNext];
+		std::this_thread::sleep_until(m_cStart + std::chrono::microseconds((unsigned long long) m_cJobs[nIndex].GetArrival() * m_nUnit));
+		std::lock_guard<std::mutex> cGuard(m_cLock);
+		m_cQueue.SetTime(m_cJobs[nIndex].GetArrival());
+		m_cQueue.Push(nIndex);
+		m_cCond.notify_one();
+	}
+
+	for (size_t nWorker = 0; nWorker < cThreads.size(); ++ nWorker)
+		cThreads[nWorker].join();
+	debug_log("Exiting %s ...", __FUNCTION__);	/* trace log */
+}
+
+/**
+ * ExecuteTasks:
+ *
+ * Run each job as a real CPU bound task, and compare the measured
+ * turnaround with the one predicted by the simulation
+ */
+int CSchedular::ExecuteTasks()
+{
+	debug_log("Entering %s ...", __FUNCTION__);	/* trace log */
+	int nRes = 0;
+	CReadyQueue* pQueue = NULL;
+	try {
+		unsigned int nWorkers = m_nWorkers ? m_nWorkers : 1;
+		log_message("sched -x %u -j %u for %s", m_nUnit, nWorkers, m_pFileName ? m_pFileName : "random jobs");	/* print command */
+		if (!IsPlain()) {
+			err_printf("Tasks can't run I/O bursts");
+			return -1;
+		}
+
+		/* prediction, same policy on the simulated CPU */
+		CSchedular cPredict(m_nType & ~EXECUTE, GetTimeQuantum(), NULL, 0, false);
+		cPredict.SetSeed(GetSeed());
+		cPredict.SetAging(GetAging());
+		if (cPredict.Replay(m_cList) < 0)
+			return -1;
+
+		pQueue = CreateQueue(m_cList, m_cRandom);
+		if (pQueue == NULL) {
+			err_printf("Invalid scheduling type");
+			return -1;
+		}
+		CExecutor cExecutor(m_cList, *pQueue, GetTimeQuantum(), nWorkers, m_nUnit);
+		cExecutor.Run();
+
+		double dPredicted = 0.0;
+		double dMeasured = 0.0;
+		const std::vector<CJob>& cPrediction = cPredict.GetJobs();
+		if (nWorkers > 1)	/* the simulation has one CPU */
+			log_message("predicted on one CPU, measured on %u workers", nWorkers);
+		log_message("job predicted measured");
+		for (size_t nIndex = 0; nIndex < m_cList.size(); ++ nIndex) {
+			unsigned long long nArrival = m_cList[nIndex].GetArrival();
+			unsigned long long nPredicted = cPrediction[nIndex].GetTime() - nArrival;
+			double dTurnaround = cExecutor.GetFinish(nIndex) - nArrival;
+			log_message("%d %llu %.2f", m_cList[nIndex].GetJob(), nPredicted, dTurnaround);
+			dPredicted += nPredicted;
+			dMeasured += dTurnaround;
+		}
+		if (!m_cList.empty())
+			log_message("Mean turnaround: predicted %.2f, measured %.2f", dPredicted / m_cList.size(), dMeasured / m_cList.size());
+	}
+	catch (std::exception& e) {
+		perr_printf(e.what());
+		nRes = -1;
+	}
+	catch (...) {
+		err_printf("Unknown Exception...");
+		nRes = -1;
+	}
+	delete pQueue;
+	debug_log("Exiting %s with code %d (0x%x)...", __FUNCTION__, nRes, nRes);	/* trace log */
+	return nRes;
+}
@@ -0,0 +1,211 @@
+/**
+ * Header files
+ */
+#include "support.h"
+#include "log.h"
+#include "fairshare.h"
+
+/**
+ * Constructor
+ *
+ * Place the jobs in list order, so the last weight in the file wins
+ */
+CFairShareQueue::CFairShareQueue(const std::vector<CJob>& cJobs)
+	: m_cJobs(cJobs), m_cGroupOf(cJobs.size(), NO_GROUP), m_cPass(cJobs.size(), 0)
+{
+	m_nLast = NO_GROUP;
+	m_cGroups.resize(1);			/* root */
+	m_cGroups[0].nParent = NO_GROUP;
+	m_cGroups[0].nWeight = 1;
+	m_cGroups[0].nPass = 0;
+	m_cGroups[0].nGlobalPass = 0;
+	m_cGroups[0].nReady = 0;
+	m_cGroups[0].nGeneration = 0;
+	for (size_t nIndex = 0; nIndex < cJobs.size(); ++ nIndex)
+		Place(nIndex);
+}
+
+/**
+ * Place:
+ * nIndex: Job index
+ *
+ * Returns group of the job, groups on its path are created at first use
+ * Jobs added to the list later (online mode) are placed when they are pushed
+ */
+unsigned int CFairShareQueue::Place(size_t nIndex)
+{
+	if (nIndex >= m_cGroupOf.size()) {
+		m_cGroupOf.resize(nIndex + 1, NO_GROUP);
+		m_cPass.resize(nIndex + 1, 0);
+	}
+	if (m_cGroupOf[nIndex] != NO_GROUP)
+		return m_cGroupOf[nIndex];
+
+	const std::string& csPath = m_cJobs[nIndex].GetGroup();
+	if (m_nLast != NO_GROUP && csPath == m_csLast)
+		return m_cGroupOf[nIndex] = m_nLast;	/* jobs of a group usually come together */
+
+	unsigned int nGroup = 0;
+	std::string csName;
+	size_t nPos = 0;
+	while (nPos < csPath.size()) {
+		size_t nNext = csPath.find('/', nPos);
+		if (nNext == std::string::npos)
+			nNext = csPath.size();
+		std::string csPart = csPath.substr(nPos, nNext - nPos);
+		nPos = nNext + 1;
+		if (csPart.empty())
+			continue;			/* leading or double "/" */
+		unsigned int nWeight = 0;
+		size_t nColon = csPart.find(':');
+		if (nColon != std::string::npos) {
+			nWeight = atoi(csPart.c_str() + nColon + 1);	/* checked when the job was read */
+			csPart.erase(nColon);
+		}
+		csName += "/" + csPart;
+
+		std::unordered_map<std::string, unsigned int>::iterator cIter = m_cPaths.find(csName);
+		if (cIter != m_cPaths.end())
+			nGroup = cIter->second;
+		else {
+			CGroup cGroup;
+			cGroup.nParent = nGroup;
+			cGroup.nWeight = 1;
+			cGroup.nPass = 0;
+			cGroup.nGlobalPass = 0;
+			cGroup.nReady = 0;
+			cGroup.nGeneration = 0;
+			m_cGroups.push_back(cGroup);
+			nGroup = m_cGroups.size() - 1;
+			m_cPaths[csName] = nGroup;
+			debug_log("Group %s is %u", csName.c_str(), nGroup);
+		}
+		if (nWeight)
+			m_cGroups[nGroup].nWeight = nWeight;
+	}
+	m_csLast = csPath;
+	m_nLast = nGroup;
+	return m_cGroupOf[nIndex] = nGroup;
+}
+
+/**
+ * Enter:
+ * nGroup: Group with READY jobs, not the root
+ *
+ * Older entries of the group in its parent's heap become stale
+ */
+void CFairShareQueue::Enter(unsigned int nGroup)
+{
+	CGroup& cGroup = m_cGroups[nGroup];
+	CEntry cEntry;
+	cEntry.nPass = cGroup.nPass;
+	cEntry.nChild = nGroup;
+	cEntry.nGeneration = ++ cGroup.nGeneration;
+	cEntry.bJob = false;
+	m_cGroups[cGroup.nParent].cHeap.push(cEntry);
+}
+
+/**
+ * Push:
+ * nIndex: Job becomes READY
+ *
+ * Job and groups joining their parent's heap start from the parent's
+ * global pass, like on the stride queue
+ */
+void CFairShareQueue::Push(size_t nIndex)
+{
+	unsigned int nGroup = Place(nIndex);
+	CGroup& cGroup = m_cGroups[nGroup];
+	if (m_cPass[nIndex] < cGroup.nGlobalPass)
+		m_cPass[nIndex] = cGroup.nGlobalPass;
+	CEntry cEntry;
+	cEntry.nPass = m_cPass[nIndex];
+	cEntry.nChild = nIndex;
+	cEntry.nGeneration = 0;
+	cEntry.bJob = true;
+	cGroup.cHeap.push(cEntry);
+
+	for (; nGroup != NO_GROUP; nGroup = m_cGroups[nGroup].nParent) {
+		CGroup& cPath = m_cGroups[nGroup];
+		if (cPath.nReady ++ > 0 || cPath.nParent == NO_GROUP)
+			continue;
+		uint64_t nGlobalPass = m_cGroups[cPath.nParent].nGlobalPass;
+		if (cPath.nPass < nGlobalPass)
+			cPath.nPass = nGlobalPass;
+		Enter(nGroup);
+	}
+}
+
+/**
+ * Pop:
+ *
+ * From the root, follow the child with the smallest pass down to a job,
+ * ties go to jobs, then to the smaller index
+ */
+size_t CFairShareQueue::Pop()
+{
+	unsigned int nGroup = 0;
+	size_t nIndex = NO_JOB;
+	while (nIndex == NO_JOB) {
+		CGroup& cGroup = m_cGroups[nGroup];
+		const CEntry& cEntry = cGroup.cHeap.top();
+		if (!cEntry.bJob &&
+			(m_cGroups[cEntry.nChild].nReady == 0 || m_cGroups[cEntry.nChild].nGeneration != cEntry.nGeneration)) {
+			cGroup.cHeap.pop();		/* stale entry */
+			continue;
+		}
+		cGroup.nGlobalPass = cEntry.nPass;
+		if (cEntry.bJob) {
+			nIndex = cEntry.nChild;
+			cGroup.cHeap.pop();
+		}
+		else
+			nGroup = cEntry.nChild;
+	}
+	for (; nGroup != NO_GROUP; nGroup = m_cGroups[nGroup].nParent)
+		-- m_cGroups[nGroup].nReady;	/* groups left with no READY job leave a stale entry */
+	return nIndex;
+}
+
+/**
+ * Charge:
+ * nIndex: Job which was running
+ * nTime: Time spent on CPU
+ *
+ * The job and every group on its path pay for the time, by their own weight
+ */
+void CFairShareQueue::Charge(size_t nIndex, unsigned long long nTime)
+{
+	m_cPass[nIndex] += (uint64_t) (STRIDE1 / m_cJobs[nIndex].GetTickets()) * nTime;
+	for (unsigned int nGroup = m_cGroupOf[nIndex]; m_cGroups[nGroup].nParent != NO_GROUP; nGroup = m_cGroups[nGroup].nParent) {
+		CGroup& cGroup = m_cGroups[nGroup];
+		cGroup.nPass += (uint64_t) (STRIDE1 / cGroup.nWeight) * nTime;
+		if (cGroup.nReady > 0)
+			Enter(nGroup);		/* still in the parent's heap, move it */
+	}
+}
+
+/**
+ * ExecuteFairShare:
+ *
+ * Execute the hierarchical fair share algorithm
+ */
+int CSchedular::ExecuteFairShare()
+{
+	debug_log("Entering %s ...", __FUNCTION__);	/* trace log */
+	int nRes = 0;
+	try {
+		log_message("sched -G %llu for %s", GetTimeQuantum(), m_pFileName ? m_pFileName : "random jobs");	/* print command */
+
+		CFairShareQueue cQueue(m_cList);
+		nRes = Simulate(cQueue);
+	}
+	catch (std::exception& e) {
+		perr_printf(e.what());
+	}
+	catch (...) {
+		err_printf("Unknown Exception...");
+	}
+	debug_log("Exiting %s with code %d (0x%x)...", __FUNCTION__, nRes, nRes);	/* trace log */
+	return nRes;
+}
@@ -0,0 +1,53 @@
+/**
+ * Header files
+ */
+#include "support.h"
+#include "log.h"
+#include "hrrn.h"
+
+/**
+ * Push:
+ * nIndex: Job becomes READY, it starts waiting now
+ */
+void CHrrnQueue::Push(size_t nIndex)
+{
+	m_cTournament.Insert(nIndex, m_nTime, m_cJobs[nIndex].GetRemaining(), m_nTime);
+}
+
+/**
+ * Pop:
+ *
+ * Job with the highest response ratio at current time
+ */
+size_t CHrrnQueue::Pop()
+{
+	size_t nIndex = m_cTournament.Top(m_nTime);
+	m_cTournament.Remove(nIndex, m_nTime);
+	return nIndex;
+}
+
+/**
+ * ExecuteHRRN:
+ *
+ * Execute the highest response ratio next algorithm
+ */
+int CSchedular::ExecuteHRRN()
+{
+	debug_log("Entering %s ...", __FUNCTION__);	/* trace log */
+	int nRes = 0;
+	try {
+		log_message("sched -H for %s", m_pFileName ? m_pFileName : "random jobs");	/* print command */
+
+		CHrrnQueue cQueue(m_cList);
+		SetTimeQuantum(0);		/* non-preemptive */
+		nRes = Simulate(cQueue);
+	}
+	catch (std::exception& e) {
+		perr_printf(e.what());
+	}
+	catch (...) {
+		err_printf("Unknown Exception...");
+	}
+	debug_log("Exiting %s with code %d (0x%x)...", __FUNCTION__, nRes, nRes);	/* trace log */
+	return nRes;
+}
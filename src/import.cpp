@@ -0,0 +1,448 @@
+/**
+ * Header files
+ */
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <limits.h>
+
+#include "support.h"
+#include "log.h"
+#include "import.h"
+
+#define NS_PER_SECOND 1000000000ULL	/* Trace times are seconds with up to 9 decimals */
+
+/**
+ * ArrivalBefore:
+ * lhs, rhs: Jobs to compare
+ *
+ * Returns true if the first job arrives earlier
+ */
+static bool ArrivalBefore(const CJob& lhs, const CJob& rhs)
+{
+	return lhs.GetArrival() < rhs.GetArrival();
+}
+
+/**
+ * Constructor
+ *
+ * cJobs: List the jobs are added to
+ * nType: Type of scheduling of the jobs
+ * nTick: Microseconds per time unit
+ */
+CTraceImport::CTraceImport(std::vector<CJob>& cJobs, unsigned int nType, unsigned int nTick)
+	: m_cJobs(cJobs)
+{
+	m_nType = nType;
+	m_nTick = (unsigned long long) std::max(1U, nTick) * 1000;
+	m_nStart = 0;
+	m_nLast = 0;
+	m_bStarted = false;
+	m_bOverflow = false;
+}
+
+/**
+ * Read:
+ * cInput: Text of the trace
+ *
+ * Add a job per task of the trace to the list, sorted by arrival
+ * Tasks keep their order of termination when they arrive at the same time
+ * Returns -1 if a job doesn't fit in TIME_MAX
+ */
+int CTraceImport::Read(std::istream& cInput)
+{
+	debug_log("Entering %s ...", __FUNCTION__);	/* trace log */
+	size_t nFirst = m_cJobs.size();
+	unsigned long long nEvents = 0;
+	std::string csLine;
+	while (!m_bOverflow && std::getline(cInput, csLine))
+		nEvents += Parse(csLine.c_str());
+
+	std::vector<unsigned int> cAlive;		/* tasks still alive at the end, by pid */
+	cAlive.reserve(m_cTasks.size());
+	for (std::unordered_map<unsigned int, CTask>::const_iterator cIter = m_cTasks.begin();
+		cIter != m_cTasks.end();
+		++ cIter)
+		cAlive.push_back(cIter->first);
+	std::sort(cAlive.begin(), cAlive.end());
+	for (size_t nIndex = 0; nIndex < cAlive.size() && !m_bOverflow; ++ nIndex) {
+		CTask& cTask = m_cTasks[cAlive[nIndex]];
+		if (cTask.nState == TASK_RUNNING)
+			cTask.nCpu += m_nLast - cTask.nSince;
+		Finish(cAlive[nIndex], cTask);
+	}
+	m_cTasks.clear();
+
+	std::stable_sort(m_cJobs.begin() + nFirst, m_cJobs.end(), ArrivalBefore);
+	int nRes = m_bOverflow ? -1 : 0;
+	debug_log("Exiting %s with %llu events, %zu jobs...", __FUNCTION__, nEvents, m_cJobs.size() - nFirst);	/* trace log */
+	return nRes;
+}
+
+/**
+ * Parse:
+ * pLine: One line of the trace
+ *
+ * Returns 1 if the line is a scheduler event, 0 if it is skipped
+ */
+int CTraceImport::Parse(const char* pLine)
+{
+	const char* pEvent = pLine;
+	while ((pEvent = strstr(pEvent, "sched_")) != NULL) {
+		unsigned long long nTime = 0;
+		if (strncmp(pEvent, "sched_switch: ", 14) == 0) {
+			if (!Stamp(pLine, pEvent, nTime))
+				return 0;
+			const char* pPayload = pEvent + 14;
+			const char* pArrow = strstr(pPayload, " ==> ");
+			if (pArrow == NULL)
+				return 0;
+			const char* pValue = NULL;
+			unsigned int nPrev = 0, nNext = 0;
+			char cState = 'R';
+			if (Field(pPayload, "prev_pid=", pValue)) {	/* prev_comm=a prev_pid=1 prev_prio=120 prev_state=S ==> next_comm=b next_pid=2 ... */
+				nPrev = strtoul(pValue, NULL, 10);
+				if (Field(pPayload, "prev_state=", pValue))
+					cState = *pValue;
+				if (!Field(pArrow, "next_pid=", pValue))
+					return 0;
+				nNext = strtoul(pValue, NULL, 10);
+			}
+			else if (!Compact(pPayload, pArrow, nPrev, &cState) ||	/* a:1 [120] S ==> b:2 [120] */
+				!Compact(pArrow + 5, pArrow + strlen(pArrow), nNext, NULL))
+				return 0;
+			Switch(nPrev, cState, nNext, nTime);
+			return 1;
+		}
+		bool bWakeup = strncmp(pEvent, "sched_wakeup: ", 14) == 0 || strncmp(pEvent, "sched_wakeup_new: ", 18) == 0;
+		bool bExit = strncmp(pEvent, "sched_process_exit: ", 20) == 0;
+		if (bWakeup || bExit) {
+			if (!Stamp(pLine, pEvent, nTime))
+				return 0;
+			const char* pPayload = strchr(pEvent, ' ') + 1;
+			const char* pValue = NULL;
+			unsigned int nPid = 0;
+			if (Field(pPayload, "pid=", pValue))		/* comm=a pid=1 prio=120 target_cpu=002 */
+				nPid = strtoul(pValue, NULL, 10);
+			else if (!Compact(pPayload, pPayload + strlen(pPayload), nPid, NULL))	/* a:1 [120] CPU:002 */
+				return 0;
+			if (bWakeup)
+				Wakeup(nPid, nTime);
+			else
+				Exit(nPid, nTime);
+			return 1;
+		}
+		pEvent += 6;			/* "sched_" in a task name */
+	}
+	return 0;
+}
+
+/**
+ * Stamp:
+ * pLine: One line of the trace
+ * pEvent: Name of the event in the line
+ * nTime: Time of the event, in ns
+ *
+ * The time is the "seconds.fraction:" before the event name, which perf
+ * prefixes with "sched:", e.g. "bash 1234 [001] 1234.567890: sched:sched_switch:"
+ * Returns false if there is no time
+ */
+bool CTraceImport::Stamp(const char* pLine, const char* pEvent, unsigned long long& nTime)
+{
+	const char* pEnd = pEvent;
+	if (pEnd - pLine >= 6 && strncmp(pEnd - 6, "sched:", 6) == 0)
+		pEnd -= 6;
+	while (pEnd > pLine && pEnd[-1] == ' ')
+		-- pEnd;
+	if (pEnd == pLine || pEnd[-1] != ':')
+		return false;
+	-- pEnd;
+	const char* pBegin = pEnd;
+	while (pBegin > pLine && ((pBegin[-1] >= '0' && pBegin[-1] <= '9') || pBegin[-1] == '.'))
+		-- pBegin;
+	if (pBegin == pEnd)
+		return false;
+
+	unsigned long long nSeconds = 0, nFraction = 0;
+	int nDigits = -1;			/* decimals read, -1 before the dot */
+	for (const char* pDigit = pBegin; pDigit < pEnd; ++ pDigit) {
+		if (*pDigit == '.') {
+			if (nDigits >= 0)
+				return false;
+			nDigits = 0;
+		}
+		else if (nDigits < 0)
+			nSeconds = nSeconds * 10 + (*pDigit - '0');
+		else if (nDigits < 9) {
+			nFraction = nFraction * 10 + (*pDigit - '0');
+			++ nDigits;
+		}
+	}
+	for (; nDigits < 9; ++ nDigits)
+		nFraction *= 10;
+	nTime = nSeconds * NS_PER_SECOND + nFraction;
+	return true;
+}
+
+/**
+ * Field:
+ * pPayload: Payload of the event, "name=value ..."
+ * pName: Name of the field, with its "="
+ * pValue: Value of the field
+ *
+ * Returns false if the payload doesn't have the field
+ */
+bool CTraceImport::Field(const char* pPayload, const char* pName, const char*& pValue)
+{
+	for (const char* pField = pPayload; (pField = strstr(pField, pName)) != NULL; ++ pField) {
+		if (pField == pPayload || pField[-1] == ' ') {
+			pValue = pField + strlen(pName);
+			return true;
+		}
+	}
+	return false;
+}
+
+/**
+ * Compact:
+ * pBegin, pEnd: Task in the compact format, "comm:pid [prio]" then the state, if any
+ * nPid: Pid of the task
+ * pState: First letter of the state, NULL if there is none
+ *
+ * The task name may have spaces and colons, the pid is before the last " ["
+ * Returns false if the text isn't a task
+ */
+bool CTraceImport::Compact(const char* pBegin, const char* pEnd, unsigned int& nPid, char* pState)
+{
+	const char* pBracket = pEnd;
+	while (pBracket - pBegin >= 2 && !(pBracket[-2] == ' ' && pBracket[-1] == '['))
+		-- pBracket;
+	if (pBracket - pBegin < 2)
+		return false;
+	const char* pColon = pBracket - 2;
+	while (pColon > pBegin && *pColon != ':')
+		-- pColon;
+	if (*pColon != ':')
+		return false;
+	nPid = strtoul(pColon + 1, NULL, 10);
+	if (pState) {
+		const char* pClose = strchr(pBracket, ']');
+		if (pClose == NULL || pClose >= pEnd)
+			return false;
+		for (++ pClose; pClose < pEnd && *pClose == ' '; ++ pClose)
+			;
+		*pState = pClose < pEnd ? *pClose : 'R';
+	}
+	return true;
+}
+
+/**
+ * Find:
+ * nPid: Pid of the task
+ * nTime: Time of the event
+ *
+ * Returns the task, a task seen for the first time is runnable from now
+ */
+CTraceImport::CTask& CTraceImport::Find(unsigned int nPid, unsigned long long nTime)
+{
+	std::unordered_map<unsigned int, CTask>::iterator cIter = m_cTasks.find(nPid);
+	if (cIter != m_cTasks.end())
+		return cIter->second;
+	CTask& cTask = m_cTasks[nPid];
+	cTask.nArrival = nTime;
+	cTask.nState = TASK_RUNNABLE;
+	cTask.nSince = nTime;
+	cTask.nCpu = 0;
+	return cTask;
+}
+
+/**
+ * Wakeup:
+ * nPid: Pid of the task
+ * nTime: Time of the event
+ *
+ * A sleeping task ends its I/O burst, a new task arrives
+ */
+void CTraceImport::Wakeup(unsigned int nPid, unsigned long long nTime)
+{
+	if (!m_bStarted) {
+		m_nStart = nTime;
+		m_bStarted = true;
+	}
+	m_nLast = std::max(m_nLast, nTime);
+	if (nPid == 0)
+		return;				/* idle task */
+	CTask& cTask = Find(nPid, nTime);
+	if (cTask.nState == TASK_SLEEPING) {
+		cTask.cBursts.push_back(nTime > cTask.nSince ? nTime - cTask.nSince : 0);
+		cTask.nState = TASK_RUNNABLE;
+		cTask.nSince = nTime;
+	}
+}
+
+/**
+ * Switch:
+ * nPrev: Pid of the task leaving the CPU
+ * cState: State it leaves in, R if preempted, X or Z if dead, else asleep
+ * nNext: Pid of the task taking the CPU
+ * nTime: Time of the event
+ *
+ * A task which leaves asleep ends its CPU burst, a task which was never
+ * seen running isn't a job until it wakes up
+ */
+void CTraceImport::Switch(unsigned int nPrev, char cState, unsigned int nNext, unsigned long long nTime)
+{
+	if (!m_bStarted) {
+		m_nStart = nTime;
+		m_bStarted = true;
+	}
+	m_nLast = std::max(m_nLast, nTime);
+	if (nPrev != 0) {
+		std::unordered_map<unsigned int, CTask>::iterator cIter = m_cTasks.find(nPrev);
+		if (cIter != m_cTasks.end()) {
+			CTask& cTask = cIter->second;
+			if (cTask.nState == TASK_RUNNING && nTime > cTask.nSince)
+				cTask.nCpu += nTime - cTask.nSince;
+			cTask.nSince = nTime;
+			if (cState == 'R')
+				cTask.nState = TASK_RUNNABLE;
+			else if (cState == 'X' || cState == 'Z') {
+				Finish(nPrev, cTask);
+				m_cTasks.erase(cIter);
+			}
+			else if (cTask.nCpu == 0 && cTask.cBursts.empty())
+				m_cTasks.erase(cIter);	/* it only ran before the trace */
+			else {
+				cTask.cBursts.push_back(cTask.nCpu);
+				cTask.nCpu = 0;
+				cTask.nState = TASK_SLEEPING;
+			}
+		}
+		else if (cState == 'R')
+			Find(nPrev, nTime);
+	}
+	if (nNext != 0) {
+		CTask& cTask = Find(nNext, nTime);
+		if (cTask.nState == TASK_SLEEPING)	/* the wakeup is missing */
+			cTask.cBursts.push_back(nTime > cTask.nSince ? nTime - cTask.nSince : 0);
+		cTask.nState = TASK_RUNNING;
+		cTask.nSince = nTime;
+	}
+}
+
+/**
+ * Exit:
+ * nPid: Pid of the task
+ * nTime: Time of the event
+ *
+ * The task becomes a job, its last switch is ignored
+ */
+void CTraceImport::Exit(unsigned int nPid, unsigned long long nTime)
+{
+	m_nLast = std::max(m_nLast, nTime);
+	std::unordered_map<unsigned int, CTask>::iterator cIter = m_cTasks.find(nPid);
+	if (cIter == m_cTasks.end())
+		return;
+	CTask& cTask = cIter->second;
+	if (cTask.nState == TASK_RUNNING && nTime > cTask.nSince)
+		cTask.nCpu += nTime - cTask.nSince;
+	Finish(nPid, cTask);
+	m_cTasks.erase(cIter);
+}
+
+/**
+ * Finish:
+ * nPid: Pid of the task
+ * cTask: Task which is done, or alive at the end of the trace
+ *
+ * Add the job of the task, without a last I/O burst, nor a task which never ran
+ * Every CPU burst is at least one time unit
+ * Returns -1 if the job doesn't fit in TIME_MAX
+ */
+int CTraceImport::Finish(unsigned int nPid, CTask& cTask)
+{
+	if (cTask.nCpu) {
+		if (cTask.cBursts.size() % 2)	/* the job didn't sleep since its last CPU burst */
+			cTask.cBursts.back() += cTask.nCpu;
+		else
+			cTask.cBursts.push_back(cTask.nCpu);
+		cTask.nCpu = 0;
+	}
+	if (cTask.cBursts.size() % 2 == 0 && !cTask.cBursts.empty())
+		cTask.cBursts.pop_back();
+	if (cTask.cBursts.empty())
+		return 0;
+
+	unsigned long long nArrival = Units(cTask.nArrival - m_nStart);
+	unsigned long long nSpan = 0;
+	std::vector<unsigned long long> cBursts(cTask.cBursts.size());
+	for (size_t nIndex = 0; nIndex < cBursts.size(); ++ nIndex) {
+		unsigned long long nBurst = Units(cTask.cBursts[nIndex]);
+		if (nIndex % 2 == 0 && nBurst == 0)
+			nBurst = 1;			/* the task did run */
+		nSpan += nBurst;
+		cBursts[nIndex] = nBurst;
+	}
+	if (nArrival > TIME_MAX || nSpan > TIME_MAX || nPid > JOB_MAX) {
+		err_printf("Task %u runs past time %llu, use a larger --tick", nPid, TIME_MAX);
+		m_bOverflow = true;
+		return -1;
+	}
+	CJob cJob(m_nType, nPid, nArrival, cBursts[0]);
+	if (cBursts.size() > 1)
+		cJob.SetBursts(cBursts);
+	m_cJobs.push_back(cJob);
+	return 0;
+}
+
+/**
+ * Units:
+ * nTime: Time in ns
+ *
+ * Returns the time in time units, rounded to the nearest
+ */
+unsigned long long CTraceImport::Units(unsigned long long nTime) const
+{
+	return (nTime + m_nTick / 2) / m_nTick;
+}
+
+/**
+ * Import:
+ *
+ * Read jobs from a Linux scheduler trace, - for standard input
+ * A job which doesn't fit drops the whole list, rather than run part of it
+ */
+int CSchedular::Import()
+{
+	debug_log("Entering %s ...", __FUNCTION__);	/* trace log */
+	int nRes = 0;
+	if (m_pFileName == NULL) {
+		err_printf("Invalid parameter, filename not found");
+		return -1;
+	}
+	try {
+		CTraceImport cImport(m_cList, m_nType, m_nTick);
+		if (strcmp(m_pFileName, "-") == 0)
+			nRes = cImport.Read(std::cin);
+		else {
+			std::ifstream inputFile(m_pFileName);	/* open the trace for reading */
+			if (!inputFile) {
+				perr_printf("Failed to open %s", m_pFileName);
+				return -1;
+			}
+			nRes = cImport.Read(inputFile);
+		}
+		if (nRes < 0)
+			m_cList.clear();
+	}
+	catch (std::exception& e) {
+		perr_printf(e.what());
+		nRes = -1;
+	}
+	catch (...) {
+		err_printf("Unknown Exception...");
+		nRes = -1;
+	}
+	debug_log("Exiting %s with code %d (0x%x)...", __FUNCTION__, nRes, nRes);	/* trace log */
+	return nRes;
+}
@@ -0,0 +1,219 @@
+/**
+ * Header files
+ */
+#include "support.h"
+#include "log.h"
+#include "kinetic.h"
+
+#define NO_LEAF ((size_t) -1)		/* Empty leaf/subtree */
+#define NEVER UINT64_MAX		/* Certificate never fails */
+
+/**
+ * FloorDiv:
+ * nNum: numerator
+ * nDen: denominator, positive
+ *
+ * Division rounding towards minus infinity
+ */
+static __int128 FloorDiv(__int128 nNum, __int128 nDen)
+{
+	__int128 nRes = nNum / nDen;
+	if ((nNum % nDen) != 0 && nNum < 0)
+		-- nRes;
+	return nRes;
+}
+
+/**
+ * Constructor
+ */
+CKineticTournament::CKineticTournament(size_t nSize)
+{
+	m_nLeaves = 1;
+	while (m_nLeaves < nSize)
+		m_nLeaves <<= 1;
+	CNode cEmpty = { NO_LEAF, NEVER, NEVER };
+	m_cNode.assign(2 * m_nLeaves, cEmpty);
+	m_cOffset.assign(m_nLeaves, 0);
+	m_cBurst.assign(m_nLeaves, 1);
+	m_nCount = 0;
+	m_nNow = 0;
+}
+
+/**
+ * Better:
+ * nLeft, nRight: Leaves to compare
+ * nTime: Time of comparison
+ *
+ * Higher response ratio wins, ties go to the smaller index
+ * (t + offset_l) / burst_l > (t + offset_r) / burst_r, without division
+ */
+bool CKineticTournament::Better(size_t nLeft, size_t nRight, uint64_t nTime) const
+{
+	if (nLeft == NO_LEAF)
+		return false;
+	if (nRight == NO_LEAF)
+		return true;
+	__int128 nLhs = ((__int128) nTime + m_cOffset[nLeft]) * m_cBurst[nRight];
+	__int128 nRhs = ((__int128) nTime + m_cOffset[nRight]) * m_cBurst[nLeft];
+	return nLhs > nRhs || (nLhs == nRhs && nLeft < nRight);
+}
+
+/**
+ * FailTime:
+ * nWinner: Leaf winning at nTime
+ * nLoser: Leaf losing at nTime
+ * nTime: Time certificate is computed
+ *
+ * Returns first time after nTime at which the loser beats the winner
+ * Loser only catches up if its line is steeper, i.e. its burst is shorter
+ */
+uint64_t CKineticTournament::FailTime(size_t nWinner, size_t nLoser, uint64_t nTime) const
+{
+	if (m_cBurst[nWinner] <= m_cBurst[nLoser])
+		return NEVER;
+
+	/**
+	 * loser - winner = t * nSlope - nBias (scaled by both bursts)
+	 * loser wins once t > nBias / nSlope, or t == nBias / nSlope on a tie it wins
+	 */
+	__int128 nSlope = (__int128) m_cBurst[nWinner] - m_cBurst[nLoser];
+	__int128 nBias = (__int128) m_cOffset[nWinner] * m_cBurst[nLoser] - (__int128) m_cOffset[nLoser] * m_cBurst[nWinner];
+	__int128 nFail = nLoser < nWinner ? -FloorDiv(-nBias, nSlope) : FloorDiv(nBias, nSlope) + 1;
+	if (nFail <= (__int128) nTime)
+		nFail = nTime + 1;
+	if (nFail >= (__int128) NEVER)
+		return NEVER;
+	return (uint64_t) nFail;
+}
+
+/**
+ * Compute:
+ * nNode: Internal node
+ * nTime: Time the node is computed
+ *
+ * Play the match between the two children winners, and set the certificate
+ */
+void CKineticTournament::Compute(size_t nNode, uint64_t nTime)
+{
+	CNode& cNode = m_cNode[nNode];
+	const CNode& cLeft = m_cNode[2 * nNode];
+	const CNode& cRight = m_cNode[2 * nNode + 1];
+
+	if (Better(cLeft.nWinner, cRight.nWinner, nTime)) {
+		cNode.nWinner = cLeft.nWinner;
+		cNode.nFail = cRight.nWinner == NO_LEAF ? NEVER : FailTime(cLeft.nWinner, cRight.nWinner, nTime);
+	}
+	else {
+		cNode.nWinner = cRight.nWinner;
+		cNode.nFail = cLeft.nWinner == NO_LEAF ? NEVER : FailTime(cRight.nWinner, cLeft.nWinner, nTime);
+	}
+	cNode.nMinFail = cNode.nFail;
+	if (cLeft.nMinFail < cNode.nMinFail)
+		cNode.nMinFail = cLeft.nMinFail;
+	if (cRight.nMinFail < cNode.nMinFail)
+		cNode.nMinFail = cRight.nMinFail;
+}
+
+/**
+ * Update:
+ * nNode: Node which was changed
+ * nTime: Current time
+ *
+ * Recompute all ancestors of the node
+ */
+void CKineticTournament::Update(size_t nNode, uint64_t nTime)
+{
+	for (nNode >>= 1; nNode > 0; nNode >>= 1)
+		Compute(nNode, nTime);
+}
+
+/**
+ * Advance:
+ * nTime: New time
+ *
+ * Process failed certificates in time order, up to nTime
+ */
+void CKineticTournament::Advance(uint64_t nTime)
+{
+	while (m_cNode[1].nMinFail <= nTime) {
+		size_t nNode = 1;
+		while (m_cNode[nNode].nFail != m_cNode[nNode].nMinFail)	/* find the failed certificate */
+			nNode = m_cNode[2 * nNode].nMinFail == m_cNode[nNode].nMinFail ? 2 * nNode : 2 * nNode + 1;
+		uint64_t nFail = m_cNode[nNode].nFail;
+		Compute(nNode, nFail);
+		Update(nNode, nFail);
+	}
+	if (nTime > m_nNow)
+		m_nNow = nTime;
+}
+
+/**
+ * Grow:
+ * nIndex: Leaf to be inserted
+ *
+ * Double the number of leaves until this leaf fits, and rebuild the tree
+ */
+void CKineticTournament::Grow(size_t nIndex)
+{
+	if (nIndex < m_nLeaves)
+		return;
+	size_t nLeaves = m_nLeaves;
+	while (nLeaves <= nIndex)
+		nLeaves <<= 1;
+
+	CNode cEmpty = { NO_LEAF, NEVER, NEVER };
+	std::vector<CNode> cNode(2 * nLeaves, cEmpty);
+	for (size_t nLeaf = 0; nLeaf < m_nLeaves; ++ nLeaf)
+		cNode[nLeaves + nLeaf] = m_cNode[m_nLeaves + nLeaf];
+	m_cNode.swap(cNode);
+	m_cOffset.resize(nLeaves, 0);
+	m_cBurst.resize(nLeaves, 1);
+	m_nLeaves = nLeaves;
+	for (size_t nNode = m_nLeaves - 1; nNode > 0; -- nNode)
+		Compute(nNode, m_nNow);
+}
+
+/**
+ * Insert:
+ * nIndex: Leaf index
+ * nReady: Time the job became READY
+ * nBurst: Burst time of the job
+ * nTime: Current time
+ */
+void CKineticTournament::Insert(size_t nIndex, uint64_t nReady, uint64_t nBurst, uint64_t nTime)
+{
+	Advance(nTime);
+	Grow(nIndex);
+	if (nBurst == 0)
+		nBurst = 1;		/* zero burst, ratio would be infinite */
+	m_cBurst[nIndex] = nBurst;
+	m_cOffset[nIndex] = (int64_t) nBurst - (int64_t) nReady;
+	m_cNode[m_nLeaves + nIndex].nWinner = nIndex;
+	Update(m_nLeaves + nIndex, nTime);
+	++ m_nCount;
+}
+
+/**
+ * Remove:
+ * nIndex: Leaf index
+ * nTime: Current time
+ */
+void CKineticTournament::Remove(size_t nIndex, uint64_t nTime)
+{
+	Advance(nTime);
+	m_cNode[m_nLeaves + nIndex].nWinner = NO_LEAF;
+	Update(m_nLeaves + nIndex, nTime);
+	-- m_nCount;
+}
+
+/**
+ * Top:
+ * nTime: Current time
+ *
+ * Returns leaf with the highest response ratio
+ */
+size_t CKineticTournament::Top(uint64_t nTime)
+{
+	Advance(nTime);
+	return m_cNode[1].nWinner;
+}
@@ -0,0 +1,142 @@
+/**
+ * Header files
+ */
+#include "support.h"
+#include "log.h"
+#include "lottery.h"
+
+/**
+ * Constructor
+ */
+CLotteryQueue::CLotteryQueue(const std::vector<CJob>& cJobs, CRandom& cRandom)
+	: m_cJobs(cJobs), m_cRandom(cRandom), m_cTickets(cJobs.size())
+{
+	m_nSize = 0;
+}
+
+/**
+ * Push:
+ * nIndex: Job becomes READY, its tickets take part in the next draw
+ */
+void CLotteryQueue::Push(size_t nIndex)
+{
+	if (nIndex >= m_cTickets.Size()) {
+		/* more jobs were added to the list (online mode), grow the tree */
+		size_t nSize = m_cTickets.Size() * 2;
+		m_cTickets.Resize(nSize > nIndex ? nSize : nIndex + 1);
+	}
+	m_cTickets.Set(nIndex, m_cJobs[nIndex].GetTickets());
+	++ m_nSize;
+}
+
+/**
+ * Pop:
+ *
+ * Draw the winning ticket, and remove the winner from the queue
+ */
+size_t CLotteryQueue::Pop()
+{
+	uint64_t nTicket = m_cRandom.Range(m_cTickets.Total());
+	size_t nIndex = m_cTickets.Find(nTicket);
+	m_cTickets.Set(nIndex, 0);
+	-- m_nSize;
+	return nIndex;
+}
+
+/**
+ * Constructor
+ */
+CStrideQueue::CStrideQueue(const std::vector<CJob>& cJobs)
+	: m_cJobs(cJobs), m_cPass(cJobs.size(), 0)
+{
+	m_nGlobalPass = 0;
+}
+
+/**
+ * Push:
+ * nIndex: Job becomes READY
+ *
+ * A job joining the queue starts from the current global pass,
+ * otherwise a new job would monopolize the CPU to catch up
+ */
+void CStrideQueue::Push(size_t nIndex)
+{
+	if (nIndex >= m_cPass.size())
+		m_cPass.resize(nIndex + 1, 0);
+	if (m_cPass[nIndex] < m_nGlobalPass)
+		m_cPass[nIndex] = m_nGlobalPass;
+	m_cHeap.push(CPass(m_cPass[nIndex], nIndex));
+}
+
+/**
+ * Pop:
+ *
+ * Job with smallest pass value, ties go to the smaller job index
+ */
+size_t CStrideQueue::Pop()
+{
+	CPass cPass = m_cHeap.top();
+	m_cHeap.pop();
+	m_nGlobalPass = cPass.first;
+	return cPass.second;
+}
+
+/**
+ * Charge:
+ * nIndex: Job which was running
+ * nTime: Time spent on CPU
+ */
+void CStrideQueue::Charge(size_t nIndex, unsigned long long nTime)
+{
+	m_cPass[nIndex] += (uint64_t) (STRIDE1 / m_cJobs[nIndex].GetTickets()) * nTime;
+}
+
+/**
+ * ExecuteLottery:
+ *
+ * Execute the lottery scheduling algorithm
+ */
+int CSchedular::ExecuteLottery()
+{
+	debug_log("Entering %s ...", __FUNCTION__);	/* trace log */
+	int nRes = 0;
+	try {
+		log_message("sched -L %llu -s %u for %s", GetTimeQuantum(), GetSeed(), m_pFileName ? m_pFileName : "random jobs");	/* print command */
+
+		CLotteryQueue cQueue(m_cList, m_cRandom);
+		nRes = Simulate(cQueue);
+	}
+	catch (std::exception& e) {
+		perr_printf(e.what());
+	}
+	catch (...) {
+		err_printf("Unknown Exception...");
+	}
+	debug_log("Exiting %s with code %d (0x%x)...", __FUNCTION__, nRes, nRes);	/* trace log */
+	return nRes;
+}
+
+/**
+ * ExecuteStride:
+ *
+ * Execute the stride scheduling algorithm
+ */
+int CSchedular::ExecuteStride()
+{
+	debug_log("Entering %s ...", __FUNCTION__);	/* trace log */
+	int nRes = 0;
+	try {
+		log_message("sched -T %llu for %s", GetTimeQuantum(), m_pFileName ? m_pFileName : "random jobs");	/* print command */
+
+		CStrideQueue cQueue(m_cList);
+		nRes = Simulate(cQueue);
+	}
+	catch (std::exception& e) {
+		perr_printf(e.what());
+	}
+	catch (...) {
+		err_printf("Unknown Exception...");
+	}
+	debug_log("Exiting %s with code %d (0x%x)...", __FUNCTION__, nRes, nRes);	/* trace log */
+	return nRes;
+}
@@ -4,6 +4,9 @@
 #include "support.h"
 #include "log.h"
 #include "schedular.h"
+#include "cluster.h"
+#include "server.h"
+#include "stats.h"
 
 /**
  * options structure
@@ -17,21 +20,44 @@ struct _opts {
 	int debug;		/* Debug */
 	int verbose;		/* Verbose output */
 	unsigned int type;	/* type of scheduling */
-	unsigned int time;	/* time quantum for round robin */
+	unsigned long long time;	/* time quantum for round robin */
 	unsigned int jobs;	/* number of random jobs to create */
+	unsigned int seed;	/* seed for random jobs and lottery draws */
+	unsigned int aging;	/* waiting time to lift a job by one priority level */
 	char* filename;		/* file name of source file */
+	char* gantt;		/* file name for the run slices */
+	int binary;		/* binary run slices */
+	char* trace;		/* file name for the Chrome trace */
+	char* filter;		/* filter for the verbose output */
+	char* metrics;		/* file name for the windowed metrics */
+	unsigned long long window;	/* width of the metrics windows */
+	char* cache;		/* directory for the results cache */
+	unsigned long long cachesize;	/* size limit of the results cache in MB */
+	int online;		/* jobs from standard input */
+	char* daemon;		/* socket path for the daemon */
+	unsigned int workers;	/* number of daemon/task worker threads */
+	unsigned int execute;	/* microseconds per time unit for real tasks */
+	int coroutine;		/* one coroutine per job */
+	int stats;		/* timers and counters, 1 for text, 2 for json */
+	unsigned int nodes;	/* number of nodes in the fleet, 0 for a single CPU */
+	int balance;		/* load balancing policy of the dispatcher */
+	unsigned int cpus;	/* CPUs of the machine for backfilling */
+	char* speed;		/* speed of each CPU or node */
+	char* dvfs;		/* frequency levels of every CPU */
+	char* cost;		/* cost of a context switch */
+	char* import;		/* file name of the scheduler trace */
+	unsigned int tick;	/* microseconds of the trace per time unit */
+	char* tune;		/* objective of the quantum search */
 } opts;
 
 /**
- * Signal handler in case of Ctrl+C or Segmentation fault
- * Not doing anything for the moment
+ * Signal handler in case of Ctrl+C, SIGTERM or SIGUSR1
+ * SIGUSR1 writes the progress of the simulation, SIGINT and SIGTERM stop it
+ * at the next event, and the results so far are written
  */
-void signal_handler(int arg __attribute__((unused)))
+void signal_handler(int arg)
 {
-	/**
-	 * TODO:
-	 * Please write some code here
-	 */
+	CProgress::Signal(arg);
 }
 
 /**
@@ -44,14 +70,53 @@ void Usage()
 	printf("Usage: sched [options]\n"
 		"\n"
 		"    Schedualing policy\n"
-		"    sched [-v] -[R <k>|S|F] [-f <filename> |-r n]\n"
+		"    sched [-v [-e filter]] -[R <k>|S|F|L <k>|T <k>|G <k>|P|N|H] [-f <filename> |-r n |-o] [-s seed] [-a n] [-g <filename> [-b]] [-t <filename>] [-m <filename> [-w n]] [-c] [-C <dir>]\n"
+		"    sched -[E <n>|K <n>] [-f <filename> |-r n]\n"
+		"    sched -[R <k>|S|F|...] [-f <filename> |-r n] -M n [-B rr|random|jsq|p2c|lwl|fast] [-s seed] [-j n]\n"
+		"    sched -[R <k>|S|F|...] [-f <filename> |-r n |-o] [-M n] [--speed list] [--dvfs levels] [--switch cost]\n"
+		"    sched -[R <k>|S|F|...] -i <filename> [--tick us]\n"
+		"    sched -R <k> --tune mean|p99|response[:max] [-f <filename> |-r n |-i <filename>] [--switch cost] [-j n]\n"
+		"    sched -[R <k>|S|F|...] [-f <filename> |-r n] -x us [-j n]\n"
+		"    sched -D <socket> [-j n]\n"
 		"\n"
 		"    -v, --verbose           More output\n"
+		"    -e, --filter EXPRESSION Only show some transitions, e.g. job=1:5-9,time=10-50,event=preempt,sample=10\n"
 		"    -R, --roundrobin NUMBER Set policy as round robin with time quntam\n"
 		"    -S, --shortest          Set policy as shortest remaining job first\n"
 		"    -F, --firstcome         Set policy as first come first serve\n"
+		"    -L, --lottery NUMBER    Set policy as lottery with time quantum\n"
+		"    -T, --stride NUMBER     Set policy as stride with time quantum\n"
+		"    -G, --fairshare NUMBER  Set policy as hierarchical fair share with time quantum\n"
+		"    -P, --priority          Set policy as preemptive priority\n"
+		"    -N, --nonpreemptive     Set policy as non-preemptive priority\n"
+		"    -H, --hrrn              Set policy as highest response ratio next\n"
+		"    -E, --easy NUMBER       Set policy as FCFS with EASY backfilling on NUMBER CPUs\n"
+		"    -K, --conservative NUMBER Set policy as FCFS with conservative backfilling on NUMBER CPUs\n"
+		"    -a, --aging NUMBER      Lift waiting jobs one priority level every NUMBER time\n"
 		"    -f, --filename FILENAME Use file for input processes\n"
 		"    -r, --random NUMBER     Use random number of jobs\n"
+		"    -o, --online            Read jobs from standard input as they arrive\n"
+		"    -i, --import FILENAME   Use a perf sched script or ftrace scheduler trace for input processes, - for standard input\n"
+		"        --tick NUMBER       Microseconds of the trace per time unit, default 1\n"
+		"        --tune OBJECTIVE[:MAX] Search the round robin quantum up to MAX minimizing mean or p99 turnaround, or mean response\n"
+		"    -s, --seed NUMBER       Seed for random jobs and lottery draws\n"
+		"    -g, --gantt FILENAME    Write one \"job cpu start end\" record per run slice, - for console\n"
+		"    -b, --binary            Write the run slices in binary\n"
+		"    -t, --trace FILENAME    Write a Chrome trace, one track per CPU and per job\n"
+		"    -m, --metrics FILENAME  Write metrics per time window, CSV or JSON if FILENAME ends with .json\n"
+		"    -w, --window NUMBER     Width of the metrics windows, default fits the run in 1024 windows\n"
+		"    -D, --daemon SOCKET     Serve simulations on a UNIX domain socket\n"
+		"    -c, --coroutine         Run each job as a coroutine\n"
+		"    -x, --execute NUMBER    Run jobs as real tasks, NUMBER microseconds per time unit\n"
+		"    -j, --workers NUMBER    Number of daemon, task or fleet worker threads\n"
+		"    -M, --nodes NUMBER      Route the jobs to a fleet of NUMBER nodes, each running the policy\n"
+		"    -B, --balance POLICY    Routing of the fleet: rr, random, jsq, p2c, lwl or fast (default rr)\n"
+		"        --speed LIST        Speed of each CPU or node, e.g. 2*4,0.5 for 4 fast nodes, the last speed for the others\n"
+		"        --dvfs LEVELS       Frequency of every CPU over time, e.g. 0:1,100:0.5@200 repeats every 200 time\n"
+		"        --switch COST[,REFILL[,DECAY]] Context switch time, plus a cache refill cooling down by 1/e every DECAY time off the CPU\n"
+		"    -C, --cache DIRECTORY   Reuse the output of identical previous runs\n"
+		"        --cache-size NUMBER Size limit of the cache in MB, default 64\n"
+		"        --stats[=json]      Write phase timers and loop counters to standard error\n"
 #ifdef DEBUG
 		"    -d, --debug             Show debugging information\n"
 #endif // DEBUG
@@ -70,17 +135,49 @@ int parse_options(int argc, char **argv)
 {
 	debug_log("Entering %s ...", __FUNCTION__);	/* tracing code for debugging */
 
-	const char *pOpt = "-vR:SFf:r:"; /* Format of application */
+	const char *pOpt = "-ve:R:SFL:T:G:PNHa:f:r:oi:s:g:bt:m:w:D:j:x:cC:M:B:E:K:"; /* Format of application */
 	const struct option cOpt[] = {
 #ifdef DEBUG
 		{ "debug",	no_argument,		NULL, 'd' },	/* debug */
 #endif
 		{ "verbose",	no_argument,		NULL, 'v' },	/* verbose */
+		{ "filter",	required_argument,	NULL, 'e' },	/* filter, requires another argument for the expression */
 		{ "roundrobin",	required_argument,	NULL, 'R' },	/* round roubin, requires another argument for time quantum */
 		{ "shortest",	no_argument,		NULL, 'S' },	/* SRJF */
 		{ "firstcome",	no_argument,		NULL, 'F' },	/* FCFS */
+		{ "lottery",	required_argument,	NULL, 'L' },	/* lottery, requires another argument for time quantum */
+		{ "stride",	required_argument,	NULL, 'T' },	/* stride, requires another argument for time quantum */
+		{ "fairshare",	required_argument,	NULL, 'G' },	/* fair share, requires another argument for time quantum */
+		{ "priority",	no_argument,		NULL, 'P' },	/* preemptive priority */
+		{ "nonpreemptive", no_argument,		NULL, 'N' },	/* non-preemptive priority */
+		{ "hrrn",	no_argument,		NULL, 'H' },	/* HRRN */
+		{ "easy",	required_argument,	NULL, 'E' },	/* EASY backfilling, requires another argument for CPUs */
+		{ "conservative", required_argument,	NULL, 'K' },	/* conservative backfilling, requires another argument for CPUs */
+		{ "aging",	required_argument,	NULL, 'a' },	/* aging, requires another argument for aging time */
 		{ "filename",	required_argument,	NULL, 'f' },	/* filename, requires another argument for name */
 		{ "random",	required_argument,	NULL, 'r' },	/* random, requires another argument for number of jobs */
+		{ "online",	no_argument,		NULL, 'o' },	/* online, jobs from standard input */
+		{ "seed",	required_argument,	NULL, 's' },	/* seed, requires another argument for the seed */
+		{ "gantt",	required_argument,	NULL, 'g' },	/* gantt, requires another argument for file name */
+		{ "binary",	no_argument,		NULL, 'b' },	/* binary gantt */
+		{ "trace",	required_argument,	NULL, 't' },	/* trace, requires another argument for file name */
+		{ "metrics",	required_argument,	NULL, 'm' },	/* metrics, requires another argument for file name */
+		{ "window",	required_argument,	NULL, 'w' },	/* window, requires another argument for the width */
+		{ "daemon",	required_argument,	NULL, 'D' },	/* daemon, requires another argument for socket path */
+		{ "workers",	required_argument,	NULL, 'j' },	/* workers, requires another argument for number of threads */
+		{ "coroutine",	no_argument,		NULL, 'c' },	/* coroutine, one per job */
+		{ "execute",	required_argument,	NULL, 'x' },	/* execute, requires another argument for microseconds per time unit */
+		{ "stats",	optional_argument,	NULL, 'I' },	/* stats, optional format text or json */
+		{ "cache",	required_argument,	NULL, 'C' },	/* cache, requires another argument for the directory */
+		{ "cache-size",	required_argument,	NULL, 'Z' },	/* cache size, requires another argument for MB */
+		{ "nodes",	required_argument,	NULL, 'M' },	/* nodes, requires another argument for number of nodes */
+		{ "balance",	required_argument,	NULL, 'B' },	/* balance, requires another argument for the policy */
+		{ "speed",	required_argument,	NULL, 'V' },	/* speed, requires another argument for the speed list */
+		{ "dvfs",	required_argument,	NULL, 'Y' },	/* dvfs, requires another argument for the frequency levels */
+		{ "switch",	required_argument,	NULL, 'X' },	/* switch, requires another argument for the switch cost */
+		{ "import",	required_argument,	NULL, 'i' },	/* import, requires another argument for the trace file name */
+		{ "tick",	required_argument,	NULL, 'W' },	/* tick, requires another argument for microseconds per time unit */
+		{ "tune",	required_argument,	NULL, 'U' },	/* tune, requires another argument for the objective */
 		{ NULL, 0, NULL, 0 }
 	};
 
@@ -90,6 +187,7 @@ int parse_options(int argc, char **argv)
 	bool bIsType = false;
 	bool bIsSource = false;
 	memset(&opts, 0, sizeof(opts));
+	opts.seed = time(NULL);		/* different run, different seed, unless provided */
 
 	/* Parse the options */
 	while ((c = getopt_long(argc, argv, pOpt, cOpt, NULL)) != -1 && err == 0) {
@@ -102,6 +200,9 @@ int parse_options(int argc, char **argv)
 		case 'v':
 			opts.verbose = 1;	/* verbose mode output */
 			break;
+		case 'e':
+			opts.filter = argv[optind-1];	/* get the filter expression */
+			break;
 		case 'R':
 			if (bIsType)		/* we already have type, this shouldn't happen */
 				err = 1;
@@ -127,6 +228,65 @@ int parse_options(int argc, char **argv)
 				bIsType = true;
 			}
 			break;
+		case 'L':
+			if (bIsType)		/* we already have type, this shouldn't happen */
+				err = 1;
+			else {
+				bIsType = true;
+				opts.type = LOTTERY;			/* set type of job as lottery */
+				opts.time = atoll(argv[optind-1]);	/* get lottery time quantum */
+			}
+			break;
+		case 'T':
+			if (bIsType)		/* we already have type, this shouldn't happen */
+				err = 1;
+			else {
+				bIsType = true;
+				opts.type = STRIDE;			/* set type of job as stride */
+				opts.time = atoll(argv[optind-1]);	/* get stride time quantum */
+			}
+			break;
+		case 'G':
+			if (bIsType)		/* we already have type, this shouldn't happen */
+				err = 1;
+			else {
+				bIsType = true;
+				opts.type = FAIRSHARE;			/* set type of job as fair share */
+				opts.time = atoll(argv[optind-1]);	/* get fair share time quantum */
+			}
+			break;
+		case 'P':
+		case 'N':
+			if (bIsType)		/* we already have type, this shouldn't happen */
+				err = 1;
+			else {
+				bIsType = true;
+				opts.type = c == 'P' ? PRIORITY : NPRIORITY;	/* set type of job as priority */
+			}
+			break;
+		case 'H':
+			if (bIsType)		/* we already have type, this shouldn't happen */
+				err = 1;
+			else {
+				bIsType = true;
+				opts.type = HRRN;	/* set type of job as HRRN */
+			}
+			break;
+		case 'E':
+		case 'K':
+			if (bIsType)		/* we already have type, this shouldn't happen */
+				err = 1;
+			else {
+				bIsType = true;
+				opts.type = c == 'E' ? EASY : CONSERVATIVE;	/* set type of job as backfilling */
+				opts.cpus = atoll(argv[optind-1]);		/* get number of CPUs */
+				if (opts.cpus == 0)
+					err = 1;
+			}
+			break;
+		case 'a':
+			opts.aging = atoll(argv[optind-1]);	/* get the aging time */
+			break;
 		case 'f':
 			if (bIsSource)
 				err = 1;	/* we already have source, this shouldn't happen */
@@ -144,6 +304,94 @@ int parse_options(int argc, char **argv)
 				opts.jobs = atoll(argv[optind-1]);	/* get number of jobs to create randomly */
 			}
 			break;
+		case 'o':
+			if (bIsSource)
+				err = 1;		/* We already have source, this shouldn't happen */
+			else {
+				bIsSource = true;
+				opts.online = 1;	/* jobs from standard input */
+			}
+			break;
+		case 'i':
+			if (bIsSource)
+				err = 1;		/* We already have source, this shouldn't happen */
+			else {
+				bIsSource = true;
+				opts.import = optarg;	/* get the trace file name */
+			}
+			break;
+		case 's':
+			opts.seed = atoll(argv[optind-1]);	/* get the seed */
+			break;
+		case 'g':
+			opts.gantt = argv[optind-1];		/* get the gantt file name */
+			break;
+		case 'b':
+			opts.binary = 1;			/* binary gantt */
+			break;
+		case 't':
+			opts.trace = argv[optind-1];		/* get the trace file name */
+			break;
+		case 'm':
+			opts.metrics = argv[optind-1];		/* get the metrics file name */
+			break;
+		case 'w':
+			opts.window = atoll(argv[optind-1]);	/* get the metrics window width */
+			break;
+		case 'D':
+			opts.daemon = argv[optind-1];		/* get the socket path */
+			break;
+		case 'j':
+			opts.workers = atoll(argv[optind-1]);	/* get number of worker threads */
+			break;
+		case 'c':
+			opts.coroutine = 1;			/* one coroutine per job */
+			break;
+		case 'I':
+			if (optarg == NULL || strcmp(optarg, "text") == 0)
+				opts.stats = 1;			/* timers and counters as text */
+			else if (strcmp(optarg, "json") == 0)
+				opts.stats = 2;			/* timers and counters as json */
+			else
+				err = 1;
+			break;
+		case 'C':
+			opts.cache = argv[optind-1];		/* get the cache directory */
+			break;
+		case 'Z':
+			opts.cachesize = atoll(optarg);		/* get the cache size limit */
+			break;
+		case 'M':
+			opts.nodes = atoll(argv[optind-1]);	/* get number of nodes */
+			break;
+		case 'B':
+			opts.balance = CCluster::Balance(argv[optind-1]);	/* get the load balancing policy */
+			if (opts.balance < 0)
+				err = 1;
+			break;
+		case 'V':
+			opts.speed = optarg;			/* get the CPU speeds */
+			break;
+		case 'Y':
+			opts.dvfs = optarg;			/* get the frequency levels */
+			break;
+		case 'X':
+			opts.cost = optarg;			/* get the context switch cost */
+			break;
+		case 'W':
+			if (CSchedular::ParseValue("Tick", optarg, UINT_MAX, opts.tick) < 0)	/* get microseconds per time unit */
+				err = 1;
+			else if (opts.tick == 0) {
+				err_printf("Tick should be at least 1 microsecond");
+				err = 1;
+			}
+			break;
+		case 'U':
+			opts.tune = optarg;			/* get the objective of the quantum search */
+			break;
+		case 'x':
+			opts.execute = atoll(argv[optind-1]);	/* get microseconds per time unit */
+			break;
 		default:
 			perr_printf("Invalid arguments");
 			err = 1;
@@ -151,7 +399,9 @@ int parse_options(int argc, char **argv)
 		}
 	}
 
-	if (!bIsType || !bIsSource)	/* Do we have any error? */
+	if (opts.daemon && !bIsType && !bIsSource)	/* daemon gets the policy with each request */
+		;
+	else if (!bIsType || !bIsSource)	/* Do we have any error? */
 		err = 1;
 
 	if (err) {
@@ -181,15 +431,56 @@ int main(int argc, char* argv[])
 		perr_printf("Failed to set SIGTERM handler");
 		return 1;
 	}
+	/* Set SIGUSR1 handler. */
+	if (signal(SIGUSR1, signal_handler) == SIG_ERR) {
+		perr_printf("Failed to set SIGUSR1 handler");
+		return 1;
+	}
 
 	/* parse the options */
 	if (parse_options(argc, argv)) {
 		return 1;
 	}
 
+	if (opts.daemon) {
+		/* Serve simulations until killed */
+		CServer server(opts.daemon, opts.workers);
+		return server.Run() < 0 ? 1 : 0;
+	}
+
+	if (opts.online)
+		opts.type |= ONLINE;	/* after parsing, the policy options overwrite the type */
+	else if (opts.execute)
+		opts.type |= EXECUTE;	/* real tasks, jobs from file or random */
+	else if (opts.nodes)
+		opts.type |= CLUSTER;	/* fleet of nodes behind a dispatcher */
+	if (opts.coroutine)
+		opts.type |= COROUTINE;	/* one coroutine per job */
+
 	/* Initialize the CSchedular class and start the process */
-	CSchedular sched(opts.type, opts.time, opts.filename, opts.jobs, opts.verbose);
+	CSchedular sched(opts.type, opts.time, opts.import ? opts.import : opts.filename, opts.jobs, opts.verbose);
+	sched.SetSeed(opts.seed);
+	sched.SetAging(opts.aging);
+	sched.SetGantt(opts.gantt, opts.binary);
+	sched.SetTrace(opts.trace);
+	sched.SetFilter(opts.filter);
+	sched.SetMetrics(opts.metrics, opts.window);
+	sched.SetCache(opts.cache, opts.cachesize << 20);
+	sched.SetExecute(opts.execute, opts.workers);
+	sched.SetCluster(opts.nodes, opts.balance);
+	sched.SetSpeed(opts.speed, opts.dvfs);
+	sched.SetSwitch(opts.cost);
+	sched.SetImport(opts.import != NULL, opts.tick);
+	sched.SetTune(opts.tune);
+	if (opts.cpus)
+		sched.SetCpus(opts.cpus);
+	if (opts.stats)
+		g_cStats.EnablePerf();		/* hardware counters, if the kernel permits */
 	sched.Start();
+	if (opts.stats)
+		g_cStats.Dump(stderr, opts.stats == 2);
 
+	if (g_cProgress.Stopped())
+		return 128 + g_cProgress.GetSignal();	/* like the shell for a killed command */
 	return 0;
 }
@@ -0,0 +1,118 @@
+/**
+ * Header files
+ */
+#include "support.h"
+#include "log.h"
+#include "engine.h"
+#include "queues.h"
+#include "lottery.h"
+#include "priority.h"
+#include "hrrn.h"
+#include "fairshare.h"
+
+/**
+ * CreateQueue:
+ * cJobs: Jobs the queue refers to by index
+ * cRandom: Generator of the lottery draws
+ *
+ * Ready queue for the scheduling type, the caller deletes it
+ * Sets the time quantum to 0 for policies which run to completion
+ */
+CReadyQueue* CSchedular::CreateQueue(const std::vector<CJob>& cJobs, CRandom& cRandom)
+{
+	CReadyQueue* pQueue = NULL;
+	if (IsFIFO()) {
+		pQueue = new CFifoQueue();
+		SetTimeQuantum(0);
+	}
+	else if (IsSRJF()) {
+		pQueue = new CShortestQueue(cJobs);
+		SetTimeQuantum(0);
+	}
+	else if (IsRoundRobin())
+		pQueue = new CFifoQueue();
+	else if (IsLottery())
+		pQueue = new CLotteryQueue(cJobs, cRandom);
+	else if (IsStride())
+		pQueue = new CStrideQueue(cJobs);
+	else if (IsFairShare())
+		pQueue = new CFairShareQueue(cJobs);
+	else if (IsPriority()) {
+		pQueue = new CPriorityQueue(cJobs, GetAging(), m_nType & PRIORITY);
+		SetTimeQuantum(0);
+	}
+	else if (IsHRRN()) {
+		pQueue = new CHrrnQueue(cJobs);
+		SetTimeQuantum(0);
+	}
+	return pQueue;
+}
+
+/**
+ * ExecuteOnline:
+ *
+ * Read "job,arrival,burst" lines from standard input as they come,
+ * simulate up to the arrival of each new job, and report each termination
+ * as soon as it happens. Each line costs the engine events it triggers,
+ * nothing walks the job list. A malformed line is reported and skipped,
+ * a late job arrives at the current simulated time.
+ */
+int CSchedular::ExecuteOnline()
+{
+	debug_log("Entering %s ...", __FUNCTION__);	/* trace log */
+	int nRes = 0;
+	char* pLine = NULL;
+	size_t nSize = 0;
+	CReadyQueue* pQueue = NULL;
+	try {
+		log_message("sched online for standard input");		/* print the command to console */
+
+		pQueue = CreateQueue(m_cList, m_cRandom);
+		if (pQueue == NULL) {
+			err_printf("Invalid scheduling type");
+			return -1;
+		}
+		CEngine cEngine(m_cList, *pQueue, GetTimeQuantum(), m_cLog);
+		cEngine.SetSpeed(GetSpeed(0));
+		cEngine.SetCost(GetSwitch());
+		while (getline(&pLine, &nSize, stdin) != -1) {	/* blocks until next line, or end of input */
+			CJob cJob;
+			int nParse = ParseLine(pLine, cJob);
+			if (nParse == -1)
+				continue;			/* empty line */
+			if (nParse < 0) {
+				std::string csLine(pLine);
+				csLine.erase(csLine.find_last_not_of("\r\n") + 1);
+				err_printf("Skipped line \"%s\"", csLine.c_str());
+				continue;			/* one bad record doesn't end the session */
+			}
+			if (cJob.GetArrival() < cEngine.GetTime())
+				cJob.SetArrival(cEngine.GetTime());	/* late, it arrives now */
+			cEngine.AdvanceTo(cJob.GetArrival());	/* report terminations before this arrival */
+			m_cList.push_back(cJob);
+			cEngine.Admit(m_cList.size() - 1);
+		}
+		cEngine.Run();		/* end of input, finish the remaining jobs */
+		SetTime(cEngine.GetTime());
+		m_cLog.Flush(GetTime());
+		DisplayUtilization(cEngine.GetBusy());
+		if (m_pSwitch) {
+			unsigned long long nBusy = 0;
+			for (size_t nIndex = 0; nIndex < m_cList.size(); ++ nIndex)
+				nBusy += m_cList[nIndex].GetBurst();
+			DisplaySwitches(cEngine.GetSwitches(), cEngine.GetOverhead(), nBusy);
+		}
+	}
+	catch (std::exception& e) {
+		perr_printf(e.what());
+		nRes = -1;
+	}
+	catch (...) {
+		err_printf("Unknown Exception...");
+		nRes = -1;
+	}
+	free(pLine);
+	delete pQueue;
+	debug_log("Exiting %s with code %d (0x%x)...", __FUNCTION__, nRes, nRes);	/* trace log */
+	return nRes;
+}
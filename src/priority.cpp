@@ -0,0 +1,160 @@
+/**
+ * Header files
+ */
+#include <algorithm>
+
+#include "support.h"
+#include "log.h"
+#include "priority.h"
+
+/**
+ * Constructor
+ */
+CPriorityQueue::CPriorityQueue(const std::vector<CJob>& cJobs, unsigned int nAging, bool bPreemptive)
+	: m_cJobs(cJobs)
+{
+	m_nMask = 0;
+	m_nAging = nAging ? nAging : TIME_MAX + 1;	/* no aging, key orders by priority, then by time */
+	m_nSize = 0;
+	m_bPreemptive = bPreemptive;
+}
+
+/**
+ * Push:
+ * nIndex: Job becomes READY at current time
+ */
+void CPriorityQueue::Push(size_t nIndex)
+{
+	unsigned int nPriority = m_cJobs[nIndex].GetPriority();
+	m_cBucket[nPriority].push_back(CStamp(nPriority * m_nAging + m_nTime, nIndex));
+	m_nMask |= 1ULL << nPriority;
+	++ m_nSize;
+}
+
+/**
+ * Best:
+ *
+ * Bucket whose head has the smallest key, -1 if all buckets are empty
+ */
+int CPriorityQueue::Best() const
+{
+	int nBest = -1;
+	for (uint64_t nMask = m_nMask; nMask; nMask &= nMask - 1) {
+		int nBucket = __builtin_ctzll(nMask);
+		if (nBest < 0 || m_cBucket[nBucket].front().first < m_cBucket[nBest].front().first)
+			nBest = nBucket;
+	}
+	return nBest;
+}
+
+/**
+ * Pop:
+ *
+ * Job with the best effective priority, oldest first
+ */
+size_t CPriorityQueue::Pop()
+{
+	int nBucket = Best();
+	size_t nIndex = m_cBucket[nBucket].front().second;
+	m_cBucket[nBucket].pop_front();
+	if (m_cBucket[nBucket].empty())
+		m_nMask &= ~(1ULL << nBucket);
+	-- m_nSize;
+	return nIndex;
+}
+
+/**
+ * Effective:
+ * nKey: Key of a READY job
+ *
+ * Returns effective priority of the job at current time, never above 0
+ */
+unsigned int CPriorityQueue::Effective(uint64_t nKey) const
+{
+	if (nKey <= m_nTime)
+		return 0;
+	return (nKey - m_nTime + m_nAging - 1) / m_nAging;
+}
+
+/**
+ * Preempts:
+ * nIndex: Running job
+ *
+ * Running job is back to its own priority, it isn't waiting
+ * Preempt only when a READY job is strictly better
+ */
+bool CPriorityQueue::Preempts(size_t nIndex) const
+{
+	if (!m_bPreemptive || m_nSize == 0)
+		return false;
+	const std::deque<CStamp>& cBucket = m_cBucket[Best()];
+	return Effective(cBucket.front().first) < m_cJobs[nIndex].GetPriority();
+}
+
+/**
+ * Before:
+ * nKey: Key searched
+ * cStamp: Stamp of a READY job
+ *
+ * Returns true if the key is below the stamp's key, for the searches of a bucket
+ */
+bool CPriorityQueue::Before(uint64_t nKey, const CStamp& cStamp)
+{
+	return nKey < cStamp.first;
+}
+
+/**
+ * Crossing:
+ * nIndex: Running job
+ *
+ * A READY job of key k preempts the running job of priority p once its
+ * effective priority is below p, from time k - (p - 1) * nAging on.
+ * Jobs already past it when the running job was dispatched lost to it
+ * then, only the first one to cross later counts, the smallest key above
+ * (p - 1) * nAging + now, found by a binary search in each bucket
+ * Returns the time of the crossing, ULLONG_MAX without aging or if none
+ */
+unsigned long long CPriorityQueue::Crossing(size_t nIndex) const
+{
+	unsigned int nPriority = m_cJobs[nIndex].GetPriority();
+	if (!m_bPreemptive || m_nSize == 0 || nPriority == 0 || m_nAging == TIME_MAX + 1)
+		return ULLONG_MAX;
+	uint64_t nLift = (uint64_t) (nPriority - 1) * m_nAging;
+	uint64_t nFirst = UINT64_MAX;
+	for (uint64_t nMask = m_nMask; nMask; nMask &= nMask - 1) {
+		const std::deque<CStamp>& cBucket = m_cBucket[__builtin_ctzll(nMask)];
+		std::deque<CStamp>::const_iterator cIter = std::upper_bound(cBucket.begin(), cBucket.end(), nLift + m_nTime, Before);
+		if (cIter != cBucket.end() && cIter->first < nFirst)
+			nFirst = cIter->first;
+	}
+	if (nFirst == UINT64_MAX)
+		return ULLONG_MAX;
+	return nFirst - nLift;
+}
+
+/**
+ * ExecutePriority:
+ *
+ * Execute the priority algorithm, preemptive or not
+ */
+int CSchedular::ExecutePriority()
+{
+	debug_log("Entering %s ...", __FUNCTION__);	/* trace log */
+	int nRes = 0;
+	try {
+		bool bPreemptive = m_nType & PRIORITY;
+		log_message("sched -%c -a %d for %s", bPreemptive ? 'P' : 'N', GetAging(), m_pFileName ? m_pFileName : "random jobs");	/* print command */
+
+		CPriorityQueue cQueue(m_cList, GetAging(), bPreemptive);
+		SetTimeQuantum(0);		/* run to completion, unless preempted */
+		nRes = Simulate(cQueue);
+	}
+	catch (std::exception& e) {
+		perr_printf(e.what());
+	}
+	catch (...) {
+		err_printf("Unknown Exception...");
+	}
+	debug_log("Exiting %s with code %d (0x%x)...", __FUNCTION__, nRes, nRes);	/* trace log */
+	return nRes;
+}
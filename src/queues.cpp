@@ -0,0 +1,40 @@
+/**
+ * Header files
+ */
+#include "support.h"
+#include "log.h"
+#include "queues.h"
+
+/**
+ * Push:
+ * nIndex: Job becomes READY
+ *
+ * Remaining burst can't change while the job is READY, so it is the key
+ */
+void CShortestQueue::Push(size_t nIndex)
+{
+	m_cHeap.push(CRemaining(m_cJobs[nIndex].GetRemaining(), nIndex));
+}
+
+/**
+ * Pop:
+ *
+ * Job with the shortest remaining burst, ties go to the smaller job index
+ */
+size_t CShortestQueue::Pop()
+{
+	size_t nIndex = m_cHeap.top().second;
+	m_cHeap.pop();
+	return nIndex;
+}
+
+/**
+ * Preempts:
+ * nIndex: Running job
+ *
+ * Preempt only when a READY job is strictly shorter
+ */
+bool CShortestQueue::Preempts(size_t nIndex) const
+{
+	return !m_cHeap.empty() && m_cHeap.top().first < m_cJobs[nIndex].GetRemaining();
+}
@@ -1,16 +1,23 @@
 /**
  * Header files
  */
+#include <algorithm>
 #include <fstream>
 
 #include "support.h"
 #include "log.h"
 #include "schedular.h"
+#include "engine.h"
+#include "queues.h"
+#include "stats.h"
+#include "cache.h"
+#include "cluster.h"
+#include "tuner.h"
 
 /**
  * Constructor
  */
-CJob::CJob(unsigned int nType, unsigned int nJob, unsigned int nArrival, unsigned int nBurst)
+CJob::CJob(unsigned int nType, unsigned int nJob, unsigned long long nArrival, unsigned long long nBurst)
 {
 	m_nType = nType;
 	m_nJob = nJob;
@@ -18,19 +25,79 @@ CJob::CJob(unsigned int nType, unsigned int nJob, unsigned int nArrival, unsigne
 	m_nBurst = nBurst;
 	m_nTime = 0;
 	m_nRunning = 0;
+	m_nTickets = 1;
+	m_nPriority = 0;
+	m_nCpus = 1;
+	m_nEstimate = 0;
+	m_nPhase = 0;
+	m_nBurstEnd = nBurst;
+	m_nWork = 0;
 }
 
 /**
- * Copy constructor
+ * SetBursts:
+ * cBursts: CPU and I/O bursts, alternating, starting and ending with CPU burst
+ *
+ * Burst time of the job becomes the total CPU time
+ */
+void CJob::SetBursts(const std::vector<unsigned long long>& cBursts)
+{
+	m_cBursts = cBursts;
+	m_nPhase = 0;
+	m_nBurst = 0;
+	for (size_t nIndex = 0; nIndex < m_cBursts.size(); nIndex += 2)
+		m_nBurst += m_cBursts[nIndex];
+	m_nBurstEnd = m_cBursts.empty() ? 0 : m_cBursts[0];
+	m_nWork = 0;
+}
+
+/**
+ * NextBurst:
+ *
+ * Current CPU burst is done, move to the next one
+ * Returns the I/O time to wait before the next CPU burst
  */
-CJob::CJob(const CJob& cJob)
+unsigned long long CJob::NextBurst()
 {
-	SetType(cJob.GetType());
-	SetJob(cJob.GetJob());
-	SetBurst(cJob.GetBurst());
-	SetArrival(cJob.GetArrival());
-	SetTime(cJob.GetTime());
-	SetRunning(cJob.GetRunning());
+	unsigned long long nIO = m_cBursts[m_nPhase + 1];
+	m_nPhase += 2;
+	m_nBurstEnd += m_cBursts[m_nPhase];
+	return nIO;
+}
+
+/**
+ * GetSpan:
+ *
+ * Returns CPU and I/O time of all the bursts, the time the job
+ * takes from its first dispatch if it never waits for the CPU
+ */
+unsigned long long CJob::GetSpan() const
+{
+	if (m_cBursts.empty())
+		return m_nBurst;
+	unsigned long long nSpan = 0;
+	for (size_t nIndex = 0; nIndex < m_cBursts.size(); ++ nIndex)
+		nSpan += m_cBursts[nIndex];
+	return nSpan;
+}
+
+/**
+ * Progress:
+ * nWork: Work units done on the CPU, at its speed
+ *
+ * Whole burst units go to the running time, the rest waits for the next work
+ * Work past the end of the burst is lost, the CPU was idle for the rest of that time unit
+ */
+void CJob::Progress(unsigned long long nWork)
+{
+	if (nWork >= GetWorkLeft()) {
+		m_nRunning = m_nBurstEnd;
+		m_nWork = 0;
+		return;
+	}
+	nWork += m_nWork;
+	m_nRunning += nWork / SPEED_ONE;
+	m_nWork = nWork % SPEED_ONE;
 }
 
 /**
@@ -62,7 +129,7 @@ bool operator < (const CJob& lhs, const CJob& rhs)
 /**
  * Constructor
  */
-CSchedular::CSchedular(unsigned int nType, unsigned int nTimeQuantum, char* pFileName, unsigned int nJobs, bool bVerbose)
+CSchedular::CSchedular(unsigned int nType, unsigned long long nTimeQuantum, char* pFileName, unsigned int nJobs, bool bVerbose)
 {
 	m_nType = nType;
 	m_nTimeQuantum = nTimeQuantum;
@@ -70,6 +137,32 @@ CSchedular::CSchedular(unsigned int nType, unsigned int nTimeQuantum, char* pFil
 	m_bVerbose = bVerbose;
 	m_nTime = 0;
 	m_nJobs = nJobs;
+	m_nSeed = 0;
+	m_nAging = 0;
+	m_pGantt = NULL;
+	m_bBinary = false;
+	m_pTrace = NULL;
+	m_pFilter = NULL;
+	m_pMetrics = NULL;
+	m_nWindow = 0;
+	m_pCache = NULL;
+	m_nCacheLimit = 0;
+	m_nUnit = 0;
+	m_nWorkers = 0;
+	m_nNodes = 0;
+	m_nBalance = 0;
+	m_nCpus = 1;
+	m_pSpeeds = NULL;
+	m_pLevels = NULL;
+	m_nBusy = 0;
+	m_pSwitch = NULL;
+	m_nSwitches = 0;
+	m_nOverhead = 0;
+	m_bImport = false;
+	m_nTick = 1;
+	m_pTune = NULL;
+	m_nTuneObjective = 0;
+	m_nTuneMax = 0;
 }
 
 /**
@@ -81,17 +174,107 @@ int CSchedular::Start()
 	debug_log("Entering %s ...", __FUNCTION__);
 	int nRes = 0;
 	try {
-		if (IsRandom())		/* If we have to create random jobs */
-			Random();	/* Create random jobs */
-		else			/* Or read jobs from file */
-			ReadFile();	/* Read the jobs from file */
+		m_cRandom.Seed(GetSeed());	/* same seed, same random jobs and lottery draws */
+		if (m_pFilter) {	/* Only display some transitions */
+			CEventFilter cFilter;
+			if (cFilter.Parse(m_pFilter) < 0) {
+				err_printf("Invalid filter %s", m_pFilter);
+				return -1;
+			}
+			m_cLog.SetFilter(cFilter);
+		}
+		if (m_pSpeeds || m_pLevels) {	/* Heterogeneous or frequency scaled CPUs */
+			if (CSpeed::Build(m_pSpeeds, m_pLevels, m_cSpeeds) < 0) {
+				err_printf("Invalid CPU speeds \"%s\" or frequency levels \"%s\"", m_pSpeeds ? m_pSpeeds : "", m_pLevels ? m_pLevels : "");
+				return -1;
+			}
+			if (IsExecute() || IsCoroutine() || IsBackfill()) {
+				err_printf("CPU speeds need the event driven engine");
+				return -1;
+			}
+		}
+		if (m_pSwitch) {	/* Context switches cost CPU time */
+			if (m_cSwitch.Parse(m_pSwitch) < 0) {
+				err_printf("Invalid context switch cost \"%s\"", m_pSwitch);
+				return -1;
+			}
+			if (m_cSwitch.IsFree())
+				m_pSwitch = NULL;	/* same run as without costs */
+		}
+		if (m_pSwitch && (IsExecute() || IsCoroutine() || IsBackfill())) {
+			err_printf("Context switch costs need the event driven engine");
+			return -1;
+		}
+		if (m_pTune) {		/* Search the time quantum */
+			if (CQuantumTuner::Parse(m_pTune, m_nTuneObjective, m_nTuneMax) < 0) {
+				err_printf("Invalid quantum tuning \"%s\"", m_pTune);
+				return -1;
+			}
+			if (!IsRoundRobin()) {
+				err_printf("Quantum tuning needs round robin (-R)");
+				return -1;
+			}
+			if (IsOnline() || IsExecute() || IsCoroutine() || IsCluster()) {
+				err_printf("Quantum tuning needs the event driven engine on one CPU");
+				return -1;
+			}
+		}
+		if (m_bVerbose)		/* Display the transitions */
+			m_cLog.Add(new CVerboseSink(), true);
+		if (m_pGantt)		/* Write the run slices */
+			m_cLog.Add(new CGanttSink(m_pGantt, m_bBinary));
+		if (m_pTrace)		/* Write the trace */
+			m_cLog.Add(new CTraceSink(m_pTrace));
+		if (m_pMetrics)		/* Write the windowed metrics */
+			m_cLog.Add(new CMetricsSink(m_pMetrics, m_nWindow));
+		if (IsOnline()) {	/* Jobs come from standard input */
+			if (!m_bVerbose)	/* Display each termination right away */
+				m_cLog.Add(new CTerminationSink());
+			CPhase cPhase(PHASE_EXECUTE);
+			ExecuteOnline();
+		}
+		else {
+			/* Only the plain output can come from the cache, other outputs need the run */
+			CResultCache cCache(m_pCache, m_nCacheLimit);
+			bool bDraws = IsRandom() || IsLottery() ||
+				(IsCluster() && (m_nBalance == BALANCE_RANDOM || m_nBalance == BALANCE_P2C));	/* same seed, same run */
+			bool bCache = m_pCache && !m_cLog.Enabled() && !IsExecute() && !m_bImport && !m_pTune &&	/* a trace may be a pipe */
+				cCache.Key(IsRandom() ? NULL : m_pFileName, m_nJobs, m_nType, GetTimeQuantum(),
+					bDraws ? GetSeed() : 0, GetAging(),
+					IsCluster() ? m_nNodes : 0, IsCluster() ? m_nBalance : 0, IsCluster() ? std::max(m_nWorkers, 1U) : 0,
+					IsBackfill() ? m_nCpus : 0,
+					m_pSpeeds, m_pLevels, m_pSwitch) == 0;
+			CPhase cPhase(PHASE_OUTPUT);
+			if (!bCache || !cCache.Fetch()) {
+				bCache = bCache && cCache.Begin() == 0;
+				int nRead;
+				{
+					CPhase cRead(PHASE_READ);
+					if (IsRandom())		/* If we have to create random jobs */
+						nRead = Random();	/* Create random jobs */
+					else if (m_bImport)	/* Or rebuild jobs from a scheduler trace */
+						nRead = Import();
+					else			/* Or read jobs from file */
+						nRead = ReadFile();	/* Read the jobs from file */
+				}
 #if DEBUG
-		DisplayJobs();		/* Display the jobs */
+				DisplayJobs();		/* Display the jobs */
 #endif // DEBUG
-		Execute();		/* Execute the algorithm */
+				CPhase cExecute(PHASE_EXECUTE);
+				if (IsExecute())	/* Run the jobs as real tasks */
+					ExecuteTasks();
+				else {
+					int nExecute = Execute();	/* Execute the algorithm */
+					if (bCache)
+						cCache.Commit(nRead >= 0 && nExecute >= 0);	/* Keep the output for the next run */
+				}
+			}
+		}
+		CPhase cPhase(PHASE_OUTPUT);
+		m_cLog.Flush(GetTime());	/* Flush the outputs, a stopped run ends now */
 		Clear();		/* Clear the data structures */
 	}
-	catch (std::exception e) {
+	catch (std::exception& e) {
 		perr_printf(e.what());
 	}
 	catch (...) {
@@ -115,44 +298,307 @@ int CSchedular::ReadFile()
 		return -1;
 	}
 	std::ifstream inputFile(m_pFileName);	/* open the file for reading */
+	if (!inputFile) {
+		perr_printf("Failed to open %s", m_pFileName);
+		return -1;
+	}
+	nRes = Load(inputFile);
+	debug_log("Exiting %s with code %d (0x%x)...", __FUNCTION__, nRes, nRes);	/* trace log */
+	return nRes;
+}
+
+/**
+ * Load:
+ * cInput: Stream with one job per line
+ *
+ * Read the jobs, and add them to the list
+ * A value which doesn't fit drops the whole list, rather than run part of it
+ */
+int CSchedular::Load(std::istream& cInput)
+{
+	debug_log("Entering %s ...", __FUNCTION__);	/* trace log */
+	int nRes = 0;
 	std::string csLine;
-	std::string csItem;
-	unsigned int nJob = 0;
-	unsigned int nArrival = 0;
-	unsigned int nBurst = 0;
 	try {
-		while (std::getline(inputFile, csLine)) {	/* read one line from the file */
-			debug_log(csLine.c_str());		/* debugging log to display the line */
-			int nIndex = csLine.find(",");		/* find , as separator */
-			csItem = csLine.substr(0, nIndex);	/* separate the job numbfer */
-			debug_log("Job # %s", csItem.c_str());	/* debugging log to display the job number */
-			nJob = atoi(csItem.c_str());		/* convert to integer */
-			nIndex ++;
-			csItem = csLine.substr(nIndex, csLine.rfind(",") - nIndex);	/* get remaining line */
-			debug_log("Arrival time = %s", csItem.c_str());			/* debugging log for arrival time */
-			nArrival = atoi(csItem.c_str());				/* convert to integer */
-			nIndex = csLine.rfind(",");
-			nIndex ++;
-			csItem = csLine.substr(nIndex, csLine.length());	/* Find the burst time */
-			debug_log("Burst time = %s", csItem.c_str());		/* debugging log for burst time */
-			nBurst = atoi(csItem.c_str());				/* conver to integer */
-			
-			debug_log("Inserting %d", nJob);		/* debugging log for job number */
-			CJob cJob(m_nType, nJob, nArrival, nBurst);	/* create object of the job */
+		while (std::getline(cInput, csLine)) {		/* read one line from the file */
+			CJob cJob;
+			int nParse = ParseLine(csLine, cJob);
+			if (nParse == -1)
+				continue;				/* empty line */
+			if (nParse < 0) {
+				m_cList.clear();
+				nRes = -1;
+				break;
+			}
 			m_cList.push_back(cJob);			/* push the object to list */
 			debug_log("List size now: %d", m_cList.size());	/* display the list current size */
 		}
 	}
-	catch (std::exception e) {
+	catch (std::exception& e) {
 		perr_printf(e.what());
+		nRes = -1;
 	}
 	catch (...) {
 		err_printf("Unknown Exception...");
+		nRes = -1;
 	}
 	debug_log("Exiting %s with code %d (0x%x)...", __FUNCTION__, nRes, nRes);	/* trace log */
 	return nRes;
 }
 
+/**
+ * Replay:
+ * cJobs: Jobs which were loaded before, they aren't changed
+ *
+ * Run copies of the jobs on the event driven engine, without any output
+ * Termination times are available from GetJobs()
+ */
+int CSchedular::Replay(const std::vector<CJob>& cJobs)
+{
+	debug_log("Entering %s ...", __FUNCTION__);	/* trace log */
+	int nRes = 0;
+	CReadyQueue* pQueue = NULL;
+	try {
+		m_cList = cJobs;
+		m_cRandom.Seed(GetSeed());
+		pQueue = CreateQueue(m_cList, m_cRandom);
+		if (pQueue == NULL) {
+			err_printf("Invalid scheduling type");
+			nRes = -1;
+		}
+		else {
+			CEngine cEngine(m_cList, *pQueue, GetTimeQuantum(), m_cLog);
+			cEngine.SetSpeed(GetSpeed(0));
+			cEngine.SetCost(GetSwitch());
+			cEngine.AdmitAll();
+			cEngine.Run();
+			SetTime(cEngine.GetTime());
+		}
+	}
+	catch (std::exception& e) {
+		perr_printf(e.what());
+		nRes = -1;
+	}
+	catch (...) {
+		err_printf("Unknown Exception...");
+		nRes = -1;
+	}
+	delete pQueue;
+	debug_log("Exiting %s with code %d (0x%x)...", __FUNCTION__, nRes, nRes);	/* trace log */
+	return nRes;
+}
+
+/**
+ * ParseLine:
+ * csLine: One line of input, "job,arrival,burst[,name=value...]"
+ * cJob: Job read from the line
+ *
+ * Returns -1 for an empty line, -2 if a value is missing, malformed or out of range
+ */
+int CSchedular::ParseLine(const std::string& csLine, CJob& cJob)
+{
+	std::string csItem;
+	unsigned int nJob = 0;
+	unsigned long long nArrival = 0;
+	unsigned long long nBurst = 0;
+
+	debug_log(csLine.c_str());		/* debugging log to display the line */
+	if (csLine.find_first_not_of(" \t\r\n") == std::string::npos)
+		return -1;			/* skip empty lines */
+	size_t nIndex = csLine.find(",");	/* find , as separator */
+	csItem = csLine.substr(0, nIndex);	/* separate the job numbfer */
+	debug_log("Job # %s", csItem.c_str());	/* debugging log to display the job number */
+	if (ParseValue("Job number", csItem.c_str(), JOB_MAX, nJob) < 0)	/* convert to integer */
+		return -2;
+	if (nIndex == std::string::npos) {
+		err_printf("Job %u: arrival and burst time are missing", nJob);
+		return -2;
+	}
+	nIndex ++;
+	size_t nNext = csLine.find(",", nIndex);
+	if (nNext == std::string::npos) {
+		err_printf("Job %u: burst time is missing", nJob);
+		return -2;
+	}
+	csItem = csLine.substr(nIndex, nNext - nIndex);	/* get the arrival time */
+	debug_log("Arrival time = %s", csItem.c_str());	/* debugging log for arrival time */
+	if (ParseValue("Arrival time", csItem.c_str(), TIME_MAX, nArrival) < 0)	/* convert to integer */
+		return -2;
+	nIndex = nNext + 1;
+	nNext = csLine.find(",", nIndex);
+	csItem = csLine.substr(nIndex, nNext - nIndex);	/* Find the burst time */
+	debug_log("Burst time = %s", csItem.c_str());	/* debugging log for burst time */
+	if (csItem.find(":") == std::string::npos &&
+		ParseValue("Burst time", csItem.c_str(), TIME_MAX, nBurst) < 0)	/* conver to integer */
+		return -2;
+
+	debug_log("Inserting %d", nJob);		/* debugging log for job number */
+	cJob = CJob(m_nType, nJob, nArrival, nBurst);	/* create object of the job */
+	if (csItem.find(":") != std::string::npos) {
+		/**
+		 * Sequence of CPU and I/O bursts, e.g. "5:3:7"
+		 * CPU 5, I/O 3, then CPU 7
+		 */
+		std::vector<unsigned long long> cBursts;
+		unsigned long long nSpan = 0;
+		size_t nPos = 0;
+		do {
+			unsigned long long nValue = 0;
+			if (ParseValue("Burst time", csItem.c_str() + nPos, TIME_MAX, nValue, ":") < 0)
+				return -2;
+			cBursts.push_back(nValue);
+			nSpan += nValue;
+			nPos = csItem.find(":", nPos);
+		} while (nPos ++ != std::string::npos);
+		if (nSpan > TIME_MAX) {
+			err_printf("Job %u: bursts take %llu time, more than %llu", nJob, nSpan, TIME_MAX);
+			return -2;
+		}
+		if (cBursts.size() % 2 == 0) {
+			err_printf("Job %d: burst sequence should end with a CPU burst", nJob);
+			cBursts.pop_back();
+		}
+		cJob.SetBursts(cBursts);
+	}
+	while (nNext != std::string::npos) {
+		/**
+		 * Optional columns after the burst time
+		 * e.g. "0,0,15,tickets=3"
+		 */
+		nIndex = nNext + 1;
+		nNext = csLine.find(",", nIndex);
+		csItem = csLine.substr(nIndex, nNext - nIndex);
+		if (ParseColumn(cJob, csItem) < -1)
+			return -2;
+	}
+	return 0;
+}
+
+/**
+ * ParseValue:
+ * pName: Name of the value, for the error message
+ * pItem: Decimal number, up to the end of the field
+ * nMax: Largest value the field can hold
+ * nValue: Value read
+ * pStop: Characters which end the field besides the end of the string, e.g. ":" in a burst sequence
+ *
+ * Blanks around the number and a line end are allowed, anything else is not:
+ * an empty field, a sign, or "12abc" is an error rather than 0 or 12,
+ * and a number which doesn't fit is an error instead of wrapping around
+ * Returns -1 if the field is not a number or the number is above the largest value
+ */
+int CSchedular::ParseValue(const char* pName, const char* pItem, unsigned long long nMax, unsigned long long& nValue, const char* pStop)
+{
+	while (*pItem == ' ' || *pItem == '\t')
+		++ pItem;
+	std::string csStop = std::string(pStop) + "\r\n";
+	int nLength = (int) strcspn(pItem, csStop.c_str());	/* field, for the error message */
+	errno = 0;
+	char* pEnd = NULL;
+	unsigned long long nRead = 0;
+	if (*pItem >= '0' && *pItem <= '9') {
+		nRead = strtoull(pItem, &pEnd, 10);
+		pEnd += strspn(pEnd, " \t\r\n");
+	}
+	if (pEnd == NULL || (*pEnd != '\0' && strchr(pStop, *pEnd) == NULL)) {
+		err_printf("%s \"%.*s\" is not a number", pName, nLength, pItem);
+		return -1;
+	}
+	if (errno == ERANGE || nRead > nMax) {
+		err_printf("%s %.*s is out of range, the largest is %llu", pName, nLength, pItem, nMax);
+		return -1;
+	}
+	nValue = nRead;
+	return 0;
+}
+
+/**
+ * ParseValue:
+ * Same for a value which fits in an unsigned int, e.g. a job number or a count
+ */
+int CSchedular::ParseValue(const char* pName, const char* pItem, unsigned int nMax, unsigned int& nValue, const char* pStop)
+{
+	unsigned long long nRead = 0;
+	if (ParseValue(pName, pItem, (unsigned long long) nMax, nRead, pStop) < 0)
+		return -1;
+	nValue = (unsigned int) nRead;
+	return 0;
+}
+
+/**
+ * ParseColumn:
+ * cJob: Job being read from file
+ * csItem: Optional column, "name=value"
+ *
+ * Known columns
+ * tickets: Tickets for lottery/stride scheduling, 1 to TICKETS_MAX
+ * priority: Static priority, 0 is the highest, above PRIO_LEVELS - 1 is the lowest
+ * group: Fair share group path, "/a:2/b" for group b in group a of weight 2, weights 1 to TICKETS_MAX
+ * cpus: CPUs of a gang job, 0 is 1
+ * est: Runtime estimate, 0 to TIME_MAX
+ *
+ * Returns -1 for an unknown column, -2 if a value is out of range
+ */
+int CSchedular::ParseColumn(CJob& cJob, const std::string& csItem)
+{
+	int nRes = 0;
+	size_t nIndex = csItem.find("=");
+	std::string csName = csItem.substr(0, nIndex);
+	std::string csValue = nIndex == std::string::npos ? "" : csItem.substr(nIndex + 1);
+	debug_log("Column %s = %s", csName.c_str(), csValue.c_str());	/* debugging log for the column */
+
+	if (csName == "tickets") {
+		unsigned int nTickets = 0;
+		if (ParseValue("Tickets", csValue.c_str(), TICKETS_MAX, nTickets) < 0)
+			return -2;
+		if (nTickets == 0) {
+			err_printf("Job %d: tickets should be at least 1", cJob.GetJob());
+			return -2;
+		}
+		cJob.SetTickets(nTickets);
+	}
+	else if (csName == "priority") {
+		unsigned int nPriority = 0;
+		if (ParseValue("Priority", csValue.c_str(), UINT_MAX, nPriority) < 0)
+			return -2;
+		if (nPriority >= PRIO_LEVELS) {
+			err_printf("Job %d: priority %d is out of range, using %d", cJob.GetJob(), nPriority, PRIO_LEVELS - 1);
+			nPriority = PRIO_LEVELS - 1;
+		}
+		cJob.SetPriority(nPriority);
+	}
+	else if (csName == "group") {
+		csValue.erase(csValue.find_last_not_of(" \t\r\n") + 1);	/* line end, in online mode */
+		for (size_t nColon = csValue.find(':'); nColon != std::string::npos; nColon = csValue.find(':', nColon + 1)) {
+			unsigned int nWeight = 0;
+			if (ParseValue("Group weight", csValue.c_str() + nColon + 1, TICKETS_MAX, nWeight, "/") < 0)
+				return -2;
+			if (nWeight == 0) {
+				err_printf("Job %d: group weight should be at least 1", cJob.GetJob());
+				return -2;
+			}
+		}
+		cJob.SetGroup(csValue);
+	}
+	else if (csName == "cpus") {
+		unsigned int nCpus = 0;
+		if (ParseValue("Cpus", csValue.c_str(), UINT_MAX, nCpus) < 0)
+			return -2;
+		cJob.SetCpus(nCpus ? nCpus : 1);
+	}
+	else if (csName == "est") {
+		unsigned long long nEstimate = 0;
+		if (ParseValue("Estimate", csValue.c_str(), TIME_MAX, nEstimate) < 0)
+			return -2;
+		cJob.SetEstimate(nEstimate);
+	}
+	else {
+		err_printf("Job %d: unknown column \"%s\"", cJob.GetJob(), csItem.c_str());
+		nRes = -1;
+	}
+	return nRes;
+}
+
 /**
  * DisplayJobs:
  *
@@ -166,13 +612,13 @@ int CSchedular::DisplayJobs()
 		for (std::vector<CJob>::const_iterator cIter = m_cList.begin();	/* Iterate over the list */
 			cIter != m_cList.end();
 			++ cIter) {
-			log_message("Job: %d, Arrival: %d, Time: %d",		/* Display job, arrival time and burst time */
+			log_message("Job: %d, Arrival: %llu, Time: %llu",		/* Display job, arrival time and burst time */
 				    (*cIter).GetJob(),
 				    (*cIter).GetArrival(),
 				    (*cIter).GetBurst());
 		}
 	}
-	catch (std::exception e) {
+	catch (std::exception& e) {
 		perr_printf(e.what());
 	}
 	catch (...) {
@@ -192,9 +638,10 @@ void CSchedular::Clear()
 	debug_log("Entering %s ...", __FUNCTION__);	/* trace log */
 	try {
 		m_cList.clear();			/* clear the list */
+		m_cLog.Clear();				/* close the outputs */
 		SetTime(0);				/* reset the total time */
 	}
-	catch (std::exception e) {
+	catch (std::exception& e) {
 		perr_printf(e.what());
 	}
 	catch (...) {
@@ -213,17 +660,51 @@ int CSchedular::Execute()
 	debug_log("Entering %s ...", __FUNCTION__);	/* trace log */
 	int nRes = 0;
 	try {
-		if (IsFIFO()) {				/* Is FCFS? */
-			nRes = ExecuteFCFS();		/* Execute FCFS algorithm */
+		unsigned long long nBusy = 0;
+		for (std::vector<CJob>::const_iterator cIter = m_cList.begin();	/* CPU time of all jobs */
+			cIter != m_cList.end();
+			++ cIter)
+			nBusy += (*cIter).GetBurst();
+
+		if (m_pTune) {				/* Search the time quantum? */
+			nRes = ExecuteTune();		/* Run round robin with the best one */
+		}
+		else if (IsCluster()) {			/* Fleet of nodes? */
+			nRes = ExecuteCluster();	/* Route the jobs, each node runs the algorithm */
+		}
+		else if (IsCoroutine()) {		/* One coroutine per job? */
+			nRes = ExecuteCoroutine();	/* Execute on the coroutine scheduler */
 		}
-		else if (IsSRJF()) {			/* Is SRJF? */
-			nRes = ExecuteSRJF();		/* Execute SRJF algorithm */
+		else if (IsFIFO() || IsSRJF() || IsRoundRobin()) {	/* Is FCFS, SRJF or RoundRobin? */
+			nRes = ExecuteEvents();		/* Execute on the event driven engine */
 		}
-		else if (IsRoundRobin()) {		/* Is RoundRobin? */
-			nRes = ExecuteRR();		/* Execute the round robin algorithm */
+		else if (IsLottery()) {			/* Is Lottery? */
+			nRes = ExecuteLottery();	/* Execute the lottery algorithm */
+		}
+		else if (IsStride()) {			/* Is Stride? */
+			nRes = ExecuteStride();		/* Execute the stride algorithm */
+		}
+		else if (IsFairShare()) {		/* Is fair share? */
+			nRes = ExecuteFairShare();	/* Execute the hierarchical fair share algorithm */
+		}
+		else if (IsPriority()) {		/* Is Priority? */
+			nRes = ExecutePriority();	/* Execute the priority algorithm */
+		}
+		else if (IsHRRN()) {			/* Is HRRN? */
+			nRes = ExecuteHRRN();		/* Execute the highest response ratio next algorithm */
+		}
+		else if (IsBackfill()) {		/* Is backfilling? */
+			nRes = ExecuteBackfill();	/* Execute FCFS with backfilling of gang jobs */
+		}
+		if (g_cProgress.Stopped())		/* partial results, no utilization */
+			nRes = -1;
+		if (nRes >= 0 && !IsCluster() && !IsBackfill()) {	/* the fleet and gang jobs report their own utilization */
+			DisplayUtilization(m_cSpeeds.empty() && !m_pSwitch ? nBusy : m_nBusy);
+			if (m_pSwitch)
+				DisplaySwitches(m_nSwitches, m_nOverhead, nBusy);
 		}
 	}
-	catch (std::exception e) {
+	catch (std::exception& e) {
 		perr_printf(e.what());
 	}
 	catch (...) {
@@ -234,219 +715,54 @@ int CSchedular::Execute()
 }
 
 /**
- * ExecuteFCFS:
+ * IsPlain:
  *
- * Execute the FCFS algorithm
+ * Are the jobs single CPU bursts, on CPUs without a speed, with free switches?
+ * Backfilling and real tasks can't model the rest
  */
-int CSchedular::ExecuteFCFS()
+bool CSchedular::IsPlain() const
 {
-	debug_log("Entering %s ...", __FUNCTION__);	/* trace log */
-	int nRes = 0;
-	try {
-		log_message("sched -F for %s", m_pFileName ? m_pFileName : "random jobs");	/* print the command to console */
-
-		int nTime = 0;
-		for (std::vector<CJob>::iterator Iter = m_cList.begin();	/* For each job */
-			Iter != m_cList.end();
-			++ Iter) {
-			int nArrival = (*Iter).GetArrival();		/* Get the arrival time */
-			if (nArrival <= nTime)				/* Just to set the proper time */
-				nArrival = nTime;
-			if (!m_bVerbose)				/* If not verbose mode, display the information */
-				log_message("%d %d", (*Iter).GetJob(), nArrival + (*Iter).GetBurst());
-			(*Iter).SetRunning(nTime == 0 ? nArrival : nTime); /* Set the running time */
-			nTime = nArrival + (*Iter).GetBurst();		/* Get the total time */
-			(*Iter).SetTime(nTime);				/* update the total time for this job */
-		}
-		SetTime(nTime);		/* update the total time for all jobs */
-
-		if (m_bVerbose) {
-			for (int nTime = 0; nTime <= GetTime(); ++ nTime) {	/* loop for time, unless all jobs are completed */
-				int nJob = -1;
-				for (std::vector<CJob>::const_iterator cIter = m_cList.begin();	/* for each job */
-					cIter != m_cList.end();
-					++ cIter) {
-
-					if (nTime == (*cIter).GetArrival()) {
-						/**
-						 * A new job has arrived.
-						 * Insert this job in the Q
-						 */
-						m_cQueue.push((*cIter));
-						log_message("At time %d, job %d READY", nTime, (*cIter).GetJob());
-					}
-					if (!m_cQueue.empty() &&
-						nTime == m_cQueue.top().GetRunning() &&
-						nJob != m_cQueue.top().GetJob()) {
-
-						/**
-						 * If Q isn't empty AND
-						 * current time is the time for this job to start RUNNING AND
-						 * This message hasn't been displayed for this job
-						 * Display the verbose log message
-						 */
-						nJob = m_cQueue.top().GetJob(); /* we displayed the message for this job */
-						log_message("At time %d, job %d READY->RUNNING", nTime, m_cQueue.top().GetJob());
-					}
-					if (nTime == (*cIter).GetTime()) {
-						/**
-						 * The time has been reached for this job.
-						 * Remove this job from the Q
-						 * Log the message
-						 */
-						m_cQueue.pop();
-						log_message("At time %d, job %d RUNNING->TERMINATED", nTime, (*cIter).GetJob());
-					}
-				}
-			}
-		}
-	}
-	catch (std::exception e) {
-		perr_printf(e.what());
-	}
-	catch (...) {
-		err_printf("Unknown Exception...");
+	if (!m_cSpeeds.empty() || m_pSwitch)
+		return false;
+	for (std::vector<CJob>::const_iterator cIter = m_cList.begin();
+		cIter != m_cList.end();
+		++ cIter) {
+		if ((*cIter).HasIO())
+			return false;
 	}
-	debug_log("Exiting %s with code %d (0x%x)...", __FUNCTION__, nRes, nRes);	/* trace log */
-	return nRes;
+	return true;
 }
 
 /**
- * ExecuteSRJF:
+ * ExecuteEvents:
  *
- * Execute the SRJF algorithm
+ * Execute FCFS, SRJF or round robin on the event driven engine
  */
-int CSchedular::ExecuteSRJF()
+int CSchedular::ExecuteEvents()
 {
-	debug_log("Entering %s ...", __FUNCTION__);		/* trace log */
+	debug_log("Entering %s ...", __FUNCTION__);	/* trace log */
 	int nRes = 0;
 	try {
-		log_message("sched -S for %s", m_pFileName ? m_pFileName : "random jobs");	/* print the command to console */
-
-		int nTime = 0;
-		for (std::vector<CJob>::iterator Iter = m_cList.begin();	/* for each job */
-			Iter != m_cList.end();
-			++ Iter) {
-			int nArrival = (*Iter).GetArrival();	/* Get arrival time */
-			nTime = nArrival + (*Iter).GetBurst();	/* Update the total time */
-			(*Iter).SetTime(nTime);			/* Set the total time */
-			if (Iter == m_cList.begin())		/* Just for first job */
-				SetTime((*Iter).GetArrival());	/* Set the total time for all jobs, to be updated later */
-		}
-
-		nTime = GetTime();
-		for (; nTime <= GetTime(); ++ nTime) {		/* loop for time, till all jobs are completed */
-			int nJob = -1;
-			for (std::vector<CJob>::iterator Iter = m_cList.begin(); /* for each job */
-				Iter != m_cList.end();
-				++ Iter) {
-				if ((*Iter).GetBurst() == 0)	/* If this job's burst time is done, just leave it */
-					continue;
-				if (nTime == (*Iter).GetArrival()) {
-					/**
-					 * A job is arrived, put it in Queue
-					 */
-					if (m_bVerbose)		/* If it's verbose mode, display the message */
-						log_message("At time %d, job %d READY", nTime, (*Iter).GetJob());
-					if (!m_cQueue.empty()) {
-						/**
-						 * If Q isn't empty AND
-						 * Current job's burst time is smallar then the running job
-						 * preempt the job, and log the message
-						 */
-						if ((*Iter).GetBurst() < m_cQueue.top().GetBurst()) {
-							if (m_bVerbose)
-								log_message("At time %d, job %d RUNNING->READY", nTime, m_cQueue.top().GetJob());
-						}
-					}
-					m_cQueue.push((*Iter));	/* push the job in Q */
-				}
-				if (!m_cQueue.empty() &&
-					(*Iter).GetJob() == m_cQueue.top().GetJob()) {
-
-					/**
-					 * If Q isn't empty and we are processing the same job
-					 */
-					if (nJob != m_cQueue.top().GetJob() &&
-						nTime == m_cQueue.top().GetArrival()) {
-
-						/**
-						 * If this job has not been logged as running
-						 * just log the message in verbose mode
-						 * update the total running time for all jobs in order to update the main loop
-						 */
-						nJob = m_cQueue.top().GetJob();
-						if (m_bVerbose)
-							log_message("At time %d, job %d READY->RUNNING", nTime, m_cQueue.top().GetJob());
-						SetTime(GetTime() + m_cQueue.top().GetBurst());
-					}
-					else {
-						/**
-						 * We need to update the running time
-						 * we have to update the burst time
-						 * because the Queue is sorted based on burst time
-						 */
-						CJob cJob(m_cQueue.top());
-						m_cQueue.pop();
-						cJob.SetBurst(cJob.GetBurst() - 1);
-						cJob.SetRunning(cJob.GetRunning() + 1);
-						m_cQueue.push(cJob);
-					}
-				}
-				if (!m_cQueue.empty() &&
-					(*Iter).GetJob() == m_cQueue.top().GetJob() &&
-					m_cQueue.top().GetBurst() == 0) {
-
-					/**
-					 * If Q isn't empty
-					 * We are processing the same job
-					 * The job burst time has been finished
-					 * Log the termination message in case of verbose
-					 */
-					if (m_bVerbose)
-						log_message("At time %d, job %d RUNNING->TERMINATED", nTime, m_cQueue.top().GetJob());
-					(*Iter).SetTime(nTime);
-					(*Iter).SetBurst(m_cQueue.top().GetBurst());
-					m_cQueue.pop();		/* remove the item from Q */
-					if (!m_cQueue.empty()) {
-
-						/**
-						 * We still have more items in Q
-						 * Get the top item from Q
-						 * And put it back on Running
-						 */
-						nJob = m_cQueue.top().GetJob();
-						if (m_bVerbose)
-							log_message("At time %d, job %d READY->RUNNING", nTime, m_cQueue.top().GetJob());
-						SetTime(GetTime() - m_cQueue.top().GetRunning() + m_cQueue.top().GetBurst());
-						/**
-						 * Terminate the loop
-						 * Otherwise it will iterate for this job one
-						 * and increment it's time, even though we are at same time
-						 * So this job time should increment at next iteration
-						 */
-						break;
-					}
-				}
-			}
+		const char* pName = m_pFileName ? m_pFileName : "random jobs";
+		if (IsFIFO()) {
+			log_message("sched -F for %s", pName);	/* print the command to console */
+			CFifoQueue cQueue;
+			SetTimeQuantum(0);			/* run to completion */
+			nRes = Simulate(cQueue);
 		}
-log_message("Time : %d", GetTime());
-		if (!m_bVerbose) {
-
-			/**
-			 * Not a verbose mode
-			 * Just display the normal information
-			 * calculated from above algorithm
-			 */
-			debug_log("List size: %d", m_cList.size());
-			for (std::vector<CJob>::const_iterator cIter = m_cList.begin();
-				cIter != m_cList.end();
-				++ cIter) {
-				log_message("%d %d", (*cIter).GetJob(), (*cIter).GetTime());
-			}
+		else if (IsSRJF()) {
+			log_message("sched -S for %s", pName);	/* print the command to console */
+			CShortestQueue cQueue(m_cList);
+			SetTimeQuantum(0);			/* preempted by shorter jobs only */
+			nRes = Simulate(cQueue);
+		}
+		else if (IsRoundRobin()) {
+			log_message("sched -R %llu for %s", GetTimeQuantum(), pName);	/* print the command to console */
+			CFifoQueue cQueue;
+			nRes = Simulate(cQueue);
 		}
 	}
-	catch (std::exception e) {
+	catch (std::exception& e) {
 		perr_printf(e.what());
 	}
 	catch (...) {
@@ -457,166 +773,119 @@ log_message("Time : %d", GetTime());
 }
 
 /**
- * ExecuteRR:
- * 
- * Execute the round robin algorithm
+ * Simulate:
+ * cQueue: Ready queue of the policy
+ *
+ * Run the event driven engine over the job list
  */
-int CSchedular::ExecuteRR()
+int CSchedular::Simulate(CReadyQueue& cQueue)
 {
 	debug_log("Entering %s ...", __FUNCTION__);	/* trace log */
 	int nRes = 0;
 	try {
-		log_message("sched -R %d for %s", GetTimeQuantum(), m_pFileName ? m_pFileName : "random jobs");	/* print command */
-
-		int nTime = 0;
-		for (std::vector<CJob>::iterator Iter = m_cList.begin();	/* for each job */
-			Iter != m_cList.end();
-			++ Iter) {
-			int nArrival = (*Iter).GetArrival();			/* Get the arrival time */
-			nTime = nArrival + (*Iter).GetBurst();			/* update the total time */
-			(*Iter).SetTime(nTime);					/* Set the total time */
-			if (Iter == m_cList.begin())				/* just for the first job */
-				SetTime((*Iter).GetArrival());			/* Set total time for all jobs, we will udpate it later */
-		}
-
-		nTime = GetTime();
-		int nJob = -1;
-		for (; nTime <= GetTime(); ++ nTime) {				/* For the time till all jobs are finished */
-			for (std::vector<CJob>::iterator Iter = m_cList.begin();/* For all jobs */
-				Iter != m_cList.end();
-				++ Iter) {
-				if ((*Iter).GetBurst() == 0)			/* If job's burst is done, just skipp it */
-					continue;
-				if (!m_cRRQueue.empty() &&
-					m_cRRQueue.size() > 1 &&
-					(*Iter).GetJob() == m_cRRQueue.front().GetJob() &&
-					m_cRRQueue.front().GetRunning() != 0 &&
-					m_cRRQueue.front().GetBurst() - 1 != 0 &&
-					(m_cRRQueue.front().GetRunning() + 1) % GetTimeQuantum() == 0) {
-
-					/**
-					 * If Q isn't empty AND
-					 * We are working on same job AND
-					 * Job's running time has started AND
-					 * Job's burst time isn't complete yet AND
-					 * Time quantum has been finished for this job
-					 * 
-					 * Put it to back of Q, and display the verbose message
-					 */ 
-					if (m_bVerbose)
-						log_message("At time %d, job %d RUNNING->READY", nTime, m_cRRQueue.front().GetJob());
-					CJob cJob(m_cRRQueue.front());		/* get the top job from Q */
-					m_cRRQueue.pop();			/* pop the job from Q */
-					cJob.SetBurst(cJob.GetBurst() - 1);	/* Update the burst time */
-					cJob.SetRunning(cJob.GetRunning() + 1);	/* Update the running time */
-					m_cRRQueue.push(cJob);			/* Push the job at end of Q */
-					Iter = m_cList.begin();	/* Get back to start of jobs (we may miss earlier job for current time */
-				}
-				if (nTime == (*Iter).GetArrival()) {
-					/**
-					 * A job is arrived, put it in Queue
-					 */
-					if (m_bVerbose)
-						log_message("At time %d, job %d READY", nTime, (*Iter).GetJob());
-					m_cRRQueue.push(*Iter);
-				}
-				if (!m_cRRQueue.empty() &&
-					(*Iter).GetJob() == m_cRRQueue.front().GetJob()) {
-
-					/**
-					 * Q isn't empty
-					 * This job is in the running state
-					 */
-					if (nJob != m_cRRQueue.front().GetJob()) {
-
-						/**
-						 * We haven't displayed the ready->running message for this job
-						 * so display the verbose message
-						 * Set the total time for all jobs to keep the main loop running
-						 */
-						nJob = m_cRRQueue.front().GetJob();
-						if (m_bVerbose)
-							log_message("At time %d, job %d READY->RUNNING", nTime, nJob);
-						SetTime(GetTime() + (*Iter).GetBurst());
-					}
-					else {
-						/**
-						 * We need to update the running time
-						 * we have to update the burst time
-						 * because the Queue is sorted based on burst time
-						 */
-						m_cRRQueue.front().SetBurst(m_cRRQueue.front().GetBurst() - 1);
-						m_cRRQueue.front().SetRunning(m_cRRQueue.front().GetRunning() + 1);
-					}
-				}
-				if ((*Iter).GetJob() == m_cRRQueue.front().GetJob() &&
-					m_cRRQueue.front().GetBurst() == 0) {
-
-					/**
-					 * If current job's burst time is finished
-					 * Log message to terminate the job
-					 */
-					if (m_bVerbose)
-						log_message("At time %d, job %d RUNNING->TERMINATED", nTime, (*Iter).GetJob());
-
-					/**
-					 * Update the time for this job
-					 * Set the running and burst time accordingly
-					 */
-					(*Iter).SetTime(nTime);
-					(*Iter).SetRunning(m_cRRQueue.front().GetRunning());
-					(*Iter).SetBurst(0);
-
-					SetTime(GetTime() - (*Iter).GetRunning());	/* set the time for main loop */
-					m_cRRQueue.pop();				/* remove this job from Q */
-					if (!m_cRRQueue.empty()) {
-
-						/**
-						 * If Q isn't empty
-						 * Put the first job in Q back to running
-						 */
-						nJob = m_cRRQueue.front().GetJob();
-						if (m_bVerbose)
-							log_message("At time %d, job %d READY->RUNNING", nTime, nJob);
-						SetTime(GetTime() + m_cRRQueue.front().GetBurst());
-						/**
-						 * Terminate the loop
-						 * Otherwise it will iterate for this job one
-						 * and increment it's time, even though we are at same time
-						 * So this job time should increment at next iteration
-						 */
-						break;
-					}
-
-				}
+		CEngine cEngine(m_cList, cQueue, GetTimeQuantum(), m_cLog);
+		cEngine.SetSpeed(GetSpeed(0));
+		cEngine.SetCost(GetSwitch());
+		cEngine.AdmitAll();
+		{
+			CProgressWatch cWatch(m_cList.size(), g_cStats.Get(STAT_EVENT));
+			while (cEngine.Step()) {
+				if (g_cProgress.Pending() &&
+					g_cProgress.Poll(cEngine.GetTime(), cEngine.GetTerminated(), g_cStats.Get(STAT_EVENT)))
+					break;		/* stopped by a signal, keep the jobs done */
 			}
 		}
+		SetTime(cEngine.GetTime());
+		m_nBusy = cEngine.GetBusy();
+		m_nSwitches = cEngine.GetSwitches();
+		m_nOverhead = cEngine.GetOverhead();
 
-		if (!m_bVerbose) {
-
-			/**
-			 * Not a verbose mode
-			 * Just display the normal information
-			 * calculated from above algorithm
-			 */
-			debug_log("List size: %d", m_cList.size());
-			for (std::vector<CJob>::const_iterator cIter = m_cList.begin();
-				cIter != m_cList.end();
-				++ cIter) {
-				log_message("%d %d", (*cIter).GetJob(), (*cIter).GetTime());
-			}
-		}
+		if (!m_bVerbose)
+			nRes = DisplayResult();
 	}
-	catch (std::exception e) {
+	catch (std::exception& e) {
 		perr_printf(e.what());
+		nRes = -1;
 	}
 	catch (...) {
 		err_printf("Unknown Exception...");
+		nRes = -1;
 	}
 	debug_log("Exiting %s with code %d (0x%x)...", __FUNCTION__, nRes, nRes);	/* trace log */
 	return nRes;
 }
 
+/**
+ * DisplayResult:
+ * pDone: Has each job terminated, NULL to tell from the bursts left
+ *
+ * Not a verbose mode
+ * Just display the termination time of each job
+ * If a signal stopped the run, only of the jobs done
+ * The records of the run go first, they may share the console (-g -)
+ */
+int CSchedular::DisplayResult(const std::vector<bool>* pDone)
+{
+	CPhase cPhase(PHASE_OUTPUT);
+	m_cLog.Flush(GetTime());
+	debug_log("List size: %d", m_cList.size());
+	bool bStopped = g_cProgress.Stopped();
+	for (std::vector<CJob>::const_iterator cIter = m_cList.begin();
+		cIter != m_cList.end();
+		++ cIter) {
+		if (bStopped && (pDone ? !(*pDone)[cIter - m_cList.begin()] :
+			!((*cIter).GetRemaining() == 0 && (*cIter).IsLastBurst() && (*cIter).GetTime() >= (*cIter).GetArrival())))
+			continue;
+		log_message("%d %llu", (*cIter).GetJob(), (*cIter).GetTime());
+	}
+	return 0;
+}
+
+/**
+ * DisplayUtilization:
+ * nBusy: Total CPU time of all jobs
+ *
+ * CPU utilization from the first arrival to the last termination
+ * The records of the run go first, like for the results
+ */
+int CSchedular::DisplayUtilization(unsigned long long nBusy)
+{
+	CPhase cPhase(PHASE_OUTPUT);
+	m_cLog.Flush(GetTime());
+	if (m_cList.empty())
+		return 0;
+	unsigned long long nStart = m_cList.front().GetArrival();
+	unsigned long long nEnd = 0;
+	for (std::vector<CJob>::const_iterator cIter = m_cList.begin();
+		cIter != m_cList.end();
+		++ cIter) {
+		if ((*cIter).GetArrival() < nStart)
+			nStart = (*cIter).GetArrival();
+		if ((*cIter).GetTime() > nEnd)
+			nEnd = (*cIter).GetTime();
+	}
+	double dUtil = nEnd > nStart ? 100.0 * nBusy / (nEnd - nStart) : 0.0;
+	log_message("CPU utilization: %.2f%%", dUtil);
+	return 0;
+}
+
+/**
+ * DisplaySwitches:
+ * nSwitches: Number of context switches
+ * nOverhead: Work units spent on the switches
+ * nBusy: Total CPU time of all jobs
+ *
+ * Overhead in time units at nominal speed, and its share of all the work done
+ */
+int CSchedular::DisplaySwitches(unsigned long long nSwitches, unsigned long long nOverhead, unsigned long long nBusy)
+{
+	CPhase cPhase(PHASE_OUTPUT);
+	unsigned long long nWork = nBusy * SPEED_ONE + nOverhead;
+	double dShare = nWork ? 100.0 * nOverhead / nWork : 0.0;
+	log_message("Context switches: %llu, overhead: %.2f (%.2f%%)", nSwitches, (double) nOverhead / SPEED_ONE, dShare);
+	return 0;
+}
+
 /**
  * Random:
  *
@@ -629,27 +898,25 @@ int CSchedular::Random()
 	debug_log("Entering %s ...", __FUNCTION__);
 	int nRes = 0;
 	try {
-		unsigned int nArrival = 0;
-		unsigned int nPreArrival = 0;
-		unsigned int nBurst = 0;
+		unsigned long long nArrival = 0;
+		unsigned long long nPreArrival = 0;
+		unsigned long long nBurst = 0;
+		log_message("random seed: %u", GetSeed());		/* same seed gives same jobs */
 		for (size_t nJob = 0; nJob < m_nJobs; ++ nJob) {	/* creating jobs */
-			srand(time(NULL));			/* create random data */
-			nArrival = rand() % (6 - 1) + 1;	/* create random arrival time */
+			nArrival = m_cRandom.Range(6 - 1) + 1;	/* create random arrival time */
 			nArrival += nPreArrival;		/* increment it to previous arrival */
-			srand(time(NULL));
-			nBurst = rand() % (30 - 1) + 1;		/* create random burst time */
+			nBurst = m_cRandom.Range(30 - 1) + 1;	/* create random burst time */
 
-			log_message("creating job: %d, Arrival %d, Burst: %d",
+			log_message("creating job: %d, Arrival %llu, Burst: %llu",
 				  nJob,
 				  nArrival,
 				  nBurst);
 			CJob cJob(m_nType, nJob, nArrival, nBurst);
 			m_cList.push_back(cJob);
 			nPreArrival = nArrival;
-			sleep(1);
 		}
 	}
-	catch (std::exception e) {
+	catch (std::exception& e) {
 		perr_printf(e.what());
 	}
 	catch (...) {
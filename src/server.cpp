@@ -0,0 +1,405 @@
+/**
+ * Header files
+ */
+#include <fstream>
+#include <sstream>
+#include <ctype.h>
+#include <limits.h>
+
+#include "support.h"
+#include "log.h"
+#include "server.h"
+
+#ifdef HAVE_SYS_SOCKET_H
+#include <sys/socket.h>
+#endif
+#ifdef HAVE_SYS_UN_H
+#include <sys/un.h>
+#endif
+#ifdef HAVE_ARPA_INET_H
+#include <arpa/inet.h>
+#endif
+
+/**
+ * Constructor
+ */
+CServer::CServer(const char* pSocket, unsigned int nWorkers)
+	: m_csSocket(pSocket)
+{
+	m_nWorkers = nWorkers ? nWorkers : std::thread::hardware_concurrency();
+	if (m_nWorkers == 0)
+		m_nWorkers = 1;
+	m_nListen = -1;
+}
+
+/**
+ * Destructor
+ */
+CServer::~CServer()
+{
+	if (m_nListen >= 0) {
+		close(m_nListen);
+		unlink(m_csSocket.c_str());
+	}
+}
+
+/**
+ * Run:
+ *
+ * Listen on the socket, and hand each connection to the worker pool
+ */
+int CServer::Run()
+{
+	debug_log("Entering %s ...", __FUNCTION__);	/* trace log */
+	int nRes = 0;
+	struct sockaddr_un cAddr;
+
+	if (m_csSocket.size() >= sizeof(cAddr.sun_path)) {
+		err_printf("Socket path %s is too long", m_csSocket.c_str());
+		return -1;
+	}
+	memset(&cAddr, 0, sizeof(cAddr));
+	cAddr.sun_family = AF_UNIX;
+	strcpy(cAddr.sun_path, m_csSocket.c_str());
+
+	m_nListen = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (m_nListen < 0) {
+		perr_printf("Failed to create socket");
+		return -1;
+	}
+	unlink(m_csSocket.c_str());		/* stale socket from an earlier run */
+	if (bind(m_nListen, (struct sockaddr*) &cAddr, sizeof(cAddr)) < 0 ||
+		listen(m_nListen, SOMAXCONN) < 0) {
+		perr_printf("Failed to listen on %s", m_csSocket.c_str());
+		return -1;
+	}
+	log_message("sched daemon on %s with %u workers", m_csSocket.c_str(), m_nWorkers);
+
+	for (unsigned int nWorker = 0; nWorker < m_nWorkers; ++ nWorker)
+		m_cThreads.push_back(std::thread(&CServer::Worker, this));
+
+	while (true) {
+		int nSocket = accept(m_nListen, NULL, NULL);
+		if (nSocket < 0) {
+			if (errno == EINTR)
+				continue;
+			perr_printf("Failed to accept connection");
+			nRes = -1;
+			break;
+		}
+		std::lock_guard<std::mutex> cGuard(m_cPendingLock);
+		m_cPending.push_back(nSocket);
+		m_cPendingCond.notify_one();
+	}
+
+	{
+		/* tell the workers to stop, -1 for each worker */
+		std::lock_guard<std::mutex> cGuard(m_cPendingLock);
+		for (unsigned int nWorker = 0; nWorker < m_nWorkers; ++ nWorker)
+			m_cPending.push_back(-1);
+		m_cPendingCond.notify_all();
+	}
+	for (size_t nWorker = 0; nWorker < m_cThreads.size(); ++ nWorker)
+		m_cThreads[nWorker].join();
+	debug_log("Exiting %s with code %d (0x%x)...", __FUNCTION__, nRes, nRes);	/* trace log */
+	return nRes;
+}
+
+/**
+ * Worker:
+ *
+ * Take connections from the pool, until told to stop
+ */
+void CServer::Worker()
+{
+	while (true) {
+		int nSocket = -1;
+		{
+			std::unique_lock<std::mutex> cGuard(m_cPendingLock);
+			while (m_cPending.empty())
+				m_cPendingCond.wait(cGuard);
+			nSocket = m_cPending.front();
+			m_cPending.pop_front();
+		}
+		if (nSocket < 0)
+			break;
+		Serve(nSocket);
+		close(nSocket);
+	}
+}
+
+/**
+ * Serve:
+ * nSocket: Connection
+ *
+ * Requests are answered in order, until the client closes the connection
+ */
+void CServer::Serve(int nSocket)
+{
+	std::string csRequest;
+	std::string csResponse;
+	while (ReadFrame(nSocket, csRequest)) {
+		csResponse.clear();
+		if (Request(csRequest, csResponse) < 0)
+			csResponse = "ERR " + csResponse;
+		else
+			csResponse = "OK\n" + csResponse;
+		if (!WriteFrame(nSocket, csResponse))
+			break;
+	}
+}
+
+/**
+ * ReadFrame:
+ * nSocket: Connection
+ * csFrame: Payload of the frame
+ *
+ * Returns false on end of connection or error
+ */
+bool CServer::ReadFrame(int nSocket, std::string& csFrame)
+{
+	uint32_t nLength = 0;
+	size_t nDone = 0;
+	while (nDone < sizeof(nLength)) {
+		ssize_t nRead = read(nSocket, (char*) &nLength + nDone, sizeof(nLength) - nDone);
+		if (nRead <= 0)
+			return false;
+		nDone += nRead;
+	}
+	nLength = ntohl(nLength);
+	if (nLength > FRAME_MAX) {
+		err_printf("Frame of %u bytes is too large", nLength);
+		return false;
+	}
+	csFrame.resize(nLength);
+	for (nDone = 0; nDone < nLength; ) {
+		ssize_t nRead = read(nSocket, &csFrame[nDone], nLength - nDone);
+		if (nRead <= 0)
+			return false;
+		nDone += nRead;
+	}
+	return true;
+}
+
+/**
+ * WriteFrame:
+ * nSocket: Connection
+ * csFrame: Payload of the frame
+ */
+bool CServer::WriteFrame(int nSocket, const std::string& csFrame)
+{
+	uint32_t nLength = htonl(csFrame.size());
+	std::string csData((const char*) &nLength, sizeof(nLength));
+	csData += csFrame;
+	for (size_t nDone = 0; nDone < csData.size(); ) {
+		ssize_t nWrite = send(nSocket, csData.data() + nDone, csData.size() - nDone, MSG_NOSIGNAL);
+		if (nWrite <= 0)
+			return false;
+		nDone += nWrite;
+	}
+	return true;
+}
+
+/**
+ * Request:
+ * csRequest: Request payload
+ * csResponse: Result, or error message
+ *
+ * Returns -1 on error
+ */
+int CServer::Request(const std::string& csRequest, std::string& csResponse)
+{
+	std::string csLine = csRequest.substr(0, csRequest.find("\n"));
+	std::istringstream cLine(csLine);
+	std::string csCommand;
+	std::string csName;
+	cLine >> csCommand >> csName;
+	debug_log("Request %s %s", csCommand.c_str(), csName.c_str());
+
+	if (csCommand == "LOAD") {
+		std::string csPath;
+		cLine >> csPath;
+		std::ifstream cInput(csPath.c_str());
+		if (csName.empty() || !cInput) {
+			csResponse = "can't read " + csPath;
+			return -1;
+		}
+		return Store(csName, cInput, csResponse);
+	}
+	else if (csCommand == "PUT") {
+		size_t nIndex = csRequest.find("\n");
+		std::istringstream cInput(nIndex == std::string::npos ? "" : csRequest.substr(nIndex + 1));
+		if (csName.empty()) {
+			csResponse = "missing workload name";
+			return -1;
+		}
+		return Store(csName, cInput, csResponse);
+	}
+	else if (csCommand == "RUN") {
+		std::string csOptions;
+		std::getline(cLine, csOptions);
+		return Simulate(csName, csOptions, csResponse);
+	}
+	else if (csCommand == "DROP") {
+		std::lock_guard<std::mutex> cGuard(m_cLock);
+		if (m_cWorkloads.erase(csName) == 0) {
+			csResponse = "no workload " + csName;
+			return -1;
+		}
+		return 0;
+	}
+	else if (csCommand == "LIST") {
+		std::lock_guard<std::mutex> cGuard(m_cLock);
+		for (std::map<std::string, CWorkload>::const_iterator cIter = m_cWorkloads.begin();
+			cIter != m_cWorkloads.end();
+			++ cIter) {
+			csResponse += cIter->first + " " + std::to_string(cIter->second->size()) + "\n";
+		}
+		return 0;
+	}
+
+	csResponse = "unknown request " + csCommand;
+	return -1;
+}
+
+/**
+ * Store:
+ * csName: Workload name
+ * cInput: Jobs, one per line
+ * csResponse: Number of jobs loaded
+ *
+ * Parsing happens outside the lock, a workload replaced while a
+ * simulation uses it stays alive until that simulation is done
+ */
+int CServer::Store(const std::string& csName, std::istream& cInput, std::string& csResponse)
+{
+	CSchedular cLoader(FIFO, 0, NULL, 0, false);
+	if (cLoader.Load(cInput) < 0) {
+		csResponse = "can't parse " + csName;
+		return -1;
+	}
+	CWorkload cWorkload(new std::vector<CJob>(cLoader.GetJobs()));
+	csResponse = std::to_string(cWorkload->size()) + "\n";
+
+	std::lock_guard<std::mutex> cGuard(m_cLock);
+	m_cWorkloads[csName] = cWorkload;
+	return 0;
+}
+
+/**
+ * Number:
+ * cOptions: Options of the request, the value is the next word
+ * csOption: Option the value is for, for the error
+ * nMin: Smallest value of the option
+ * nValue: Value read
+ * csResponse: Error message
+ *
+ * Returns -1 if the value is missing, isn't a decimal number, or is out of range
+ */
+int CServer::Number(std::istream& cOptions, const std::string& csOption, unsigned int nMin, unsigned int& nValue, std::string& csResponse)
+{
+	std::string csValue;
+	if (!(cOptions >> csValue)) {
+		csResponse = "missing value for " + csOption;
+		return -1;
+	}
+	errno = 0;
+	char* pEnd = NULL;
+	unsigned long long nRead = strtoull(csValue.c_str(), &pEnd, 10);
+	if (!isdigit((unsigned char) csValue[0]) || *pEnd != '\0' || errno == ERANGE || nRead < nMin || nRead > UINT_MAX) {
+		csResponse = "invalid value " + csValue + " for " + csOption;
+		return -1;
+	}
+	nValue = (unsigned int) nRead;
+	return 0;
+}
+
+/**
+ * Simulate:
+ * csName: Workload name
+ * csOptions: Policy and parameters, as on the command line
+ * csResponse: "job time" for each job, then "time" and "utilization"
+ */
+int CServer::Simulate(const std::string& csName, const std::string& csOptions, std::string& csResponse)
+{
+	CWorkload cWorkload;
+	{
+		std::lock_guard<std::mutex> cGuard(m_cLock);
+		std::map<std::string, CWorkload>::const_iterator cIter = m_cWorkloads.find(csName);
+		if (cIter == m_cWorkloads.end()) {
+			csResponse = "no workload " + csName;
+			return -1;
+		}
+		cWorkload = cIter->second;
+	}
+
+	/**
+	 * Same policy options as the command line
+	 */
+	unsigned int nType = 0;
+	unsigned int nQuantum = 0;
+	unsigned int nSeed = 0;
+	unsigned int nAging = 0;
+	std::istringstream cOptions(csOptions);
+	std::string csOption;
+	while (cOptions >> csOption) {
+		if (csOption == "-F")
+			nType = FIFO;
+		else if (csOption == "-S")
+			nType = SRJF;
+		else if (csOption == "-P")
+			nType = PRIORITY;
+		else if (csOption == "-N")
+			nType = NPRIORITY;
+		else if (csOption == "-H")
+			nType = HRRN;
+		else if (csOption == "-R" || csOption == "-L" || csOption == "-T" || csOption == "-G") {
+			nType = csOption == "-R" ? RR : csOption == "-L" ? LOTTERY : csOption == "-T" ? STRIDE : FAIRSHARE;
+			if (Number(cOptions, csOption, 1, nQuantum, csResponse) < 0)
+				return -1;
+		}
+		else if (csOption == "-s") {
+			if (Number(cOptions, csOption, 0, nSeed, csResponse) < 0)
+				return -1;
+		}
+		else if (csOption == "-a") {
+			if (Number(cOptions, csOption, 0, nAging, csResponse) < 0)
+				return -1;
+		}
+		else {
+			csResponse = "unknown option " + csOption;
+			return -1;
+		}
+	}
+	if (nType == 0) {
+		csResponse = "missing policy";
+		return -1;
+	}
+
+	CSchedular cSched(nType, nQuantum, NULL, 0, false);
+	cSched.SetSeed(nSeed);
+	cSched.SetAging(nAging);
+	if (cSched.Replay(*cWorkload) < 0) {
+		csResponse = "simulation failed";
+		return -1;
+	}
+
+	unsigned long long nBusy = 0;
+	unsigned long long nStart = cWorkload->empty() ? 0 : cWorkload->front().GetArrival();
+	char pLine[64];
+	const std::vector<CJob>& cJobs = cSched.GetJobs();
+	for (std::vector<CJob>::const_iterator cIter = cJobs.begin();
+		cIter != cJobs.end();
+		++ cIter) {
+		snprintf(pLine, sizeof(pLine), "%u %llu\n", (*cIter).GetJob(), (*cIter).GetTime());
+		csResponse += pLine;
+		nBusy += (*cIter).GetBurst();
+		if ((*cIter).GetArrival() < nStart)
+			nStart = (*cIter).GetArrival();
+	}
+	unsigned long long nEnd = cSched.GetTime();
+	snprintf(pLine, sizeof(pLine), "time %llu\nutilization %.2f\n", nEnd,
+		 nEnd > nStart ? 100.0 * nBusy / (nEnd - nStart) : 0.0);
+	csResponse += pLine;
+	return 0;
+}
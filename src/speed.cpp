@@ -0,0 +1,309 @@
+/**
+ * Header files
+ */
+#include <algorithm>
+#include <string>
+#include <limits.h>
+#include <math.h>
+
+#include "support.h"
+#include "log.h"
+#include "speed.h"
+
+#define SPEED_MIN 1			/* Slowest factor, in work units per time unit */
+#define SPEED_MAX (32 * SPEED_ONE)	/* Fastest factor, so the work done by TIME_MAX fits in 64 bits */
+
+/**
+ * Constructor
+ *
+ * Nominal speed, a single level at nominal frequency
+ */
+CSpeed::CSpeed()
+{
+	m_nBase = SPEED_ONE;
+	m_nPeriod = 0;
+	m_nPeriodWork = 0;
+	CLevel cLevel = { 0, SPEED_ONE, SPEED_ONE, 0 };
+	m_cLevels.push_back(cLevel);
+}
+
+/**
+ * Factor:
+ * pText: Decimal factor, e.g. "0.5", "1" or "2.25"
+ * nSpeed: Factor in work units per time unit
+ *
+ * Returns -1 if the factor isn't a number, or is out of range
+ */
+int CSpeed::Factor(const char* pText, unsigned int& nSpeed)
+{
+	char* pEnd = NULL;
+	double dFactor = strtod(pText, &pEnd);
+	if (pEnd == pText || *pEnd != '\0')
+		return -1;
+	double dSpeed = dFactor * SPEED_ONE + 0.5;
+	if (dSpeed < SPEED_MIN || dSpeed > SPEED_MAX)
+		return -1;
+	nSpeed = (unsigned int) dSpeed;
+	return 0;
+}
+
+/**
+ * Build:
+ * pSpeeds: Speed of each CPU, "factor[*count],...", NULL for nominal CPUs
+ * pLevels: Frequency levels of every CPU (see SetLevels), NULL for none
+ * cSpeeds: Speed of each CPU, the last one holds for the CPUs after it
+ *
+ * Returns -1 if either list is invalid
+ */
+int CSpeed::Build(const char* pSpeeds, const char* pLevels, std::vector<CSpeed>& cSpeeds)
+{
+	cSpeeds.clear();
+	std::string csSpeeds(pSpeeds ? pSpeeds : "1");
+	size_t nStart = 0;
+	while (nStart <= csSpeeds.size()) {
+		size_t nEnd = csSpeeds.find(',', nStart);
+		if (nEnd == std::string::npos)
+			nEnd = csSpeeds.size();
+		std::string csItem = csSpeeds.substr(nStart, nEnd - nStart);
+		nStart = nEnd + 1;
+
+		unsigned long nCount = 1;
+		size_t nStar = csItem.find('*');
+		if (nStar != std::string::npos) {
+			char* pEnd = NULL;
+			nCount = strtoul(csItem.c_str() + nStar + 1, &pEnd, 10);
+			if (*pEnd != '\0' || nCount == 0 || nCount > UINT_MAX)
+				return -1;
+			csItem.erase(nStar);
+		}
+		CSpeed cSpeed;
+		unsigned int nBase = 0;
+		if (Factor(csItem.c_str(), nBase) < 0)
+			return -1;
+		cSpeed.SetBase(nBase);
+		if (pLevels && cSpeed.SetLevels(pLevels) < 0)
+			return -1;
+		cSpeeds.insert(cSpeeds.end(), nCount, cSpeed);
+	}
+	return 0;
+}
+
+/**
+ * SetBase:
+ * nBase: Speed of the core, in work units per time unit
+ */
+void CSpeed::SetBase(unsigned int nBase)
+{
+	m_nBase = nBase;
+	Prepare();
+}
+
+/**
+ * SetLevels:
+ * pLevels: "time:scale,...[@period]", e.g. "0:1,100:0.6,250:1.2@400"
+ *
+ * Each scale holds from its time to the next one, times are increasing,
+ * nominal frequency before the first one. With a period, the levels
+ * repeat every period time units, the period ends after the last level.
+ * Returns -1 if the levels are invalid
+ */
+int CSpeed::SetLevels(const char* pLevels)
+{
+	std::string csLevels(pLevels);
+	m_nPeriod = 0;
+	size_t nAt = csLevels.find('@');
+	if (nAt != std::string::npos) {
+		char* pEnd = NULL;
+		unsigned long long nPeriod = strtoull(csLevels.c_str() + nAt + 1, &pEnd, 10);
+		if (*pEnd != '\0' || nPeriod == 0 || nPeriod > TIME_MAX)
+			return -1;
+		m_nPeriod = nPeriod;
+		csLevels.erase(nAt);
+	}
+
+	m_cLevels.clear();
+	size_t nStart = 0;
+	while (nStart <= csLevels.size()) {
+		size_t nEnd = csLevels.find(',', nStart);
+		if (nEnd == std::string::npos)
+			nEnd = csLevels.size();
+		std::string csItem = csLevels.substr(nStart, nEnd - nStart);
+		nStart = nEnd + 1;
+
+		size_t nColon = csItem.find(':');
+		if (nColon == std::string::npos)
+			return -1;
+		char* pEnd = NULL;
+		unsigned long long nTime = strtoull(csItem.c_str(), &pEnd, 10);
+		if (pEnd != csItem.c_str() + nColon || nTime > TIME_MAX)
+			return -1;
+		CLevel cLevel = { nTime, SPEED_ONE, 0, 0 };
+		if (Factor(csItem.c_str() + nColon + 1, cLevel.nScale) < 0)
+			return -1;
+		if (m_cLevels.empty() && cLevel.nTime > 0) {
+			CLevel cNominal = { 0, SPEED_ONE, 0, 0 };
+			m_cLevels.push_back(cNominal);
+		}
+		if (!m_cLevels.empty() && m_cLevels.back().nTime >= cLevel.nTime)
+			return -1;
+		m_cLevels.push_back(cLevel);
+	}
+	if (m_nPeriod && m_nPeriod <= m_cLevels.back().nTime)
+		return -1;
+	Prepare();
+	return 0;
+}
+
+/**
+ * Prepare:
+ *
+ * Rate of each level from the base speed and the scale, at least one
+ * work unit per time unit so every job terminates, and the work done
+ * from the start of the period to each level
+ */
+void CSpeed::Prepare()
+{
+	unsigned long long nWork = 0;
+	for (size_t nLevel = 0; nLevel < m_cLevels.size(); ++ nLevel) {
+		CLevel& cLevel = m_cLevels[nLevel];
+		unsigned long long nRate = ((unsigned long long) m_nBase * cLevel.nScale + SPEED_ONE / 2) / SPEED_ONE;
+		cLevel.nRate = (unsigned int) std::max(1ULL, nRate);
+		if (nLevel > 0)
+			nWork += (unsigned long long) m_cLevels[nLevel - 1].nRate * (cLevel.nTime - m_cLevels[nLevel - 1].nTime);
+		cLevel.nWork = nWork;
+	}
+	m_nPeriodWork = 0;
+	if (m_nPeriod)
+		m_nPeriodWork = nWork + (unsigned long long) m_cLevels.back().nRate * (m_nPeriod - m_cLevels.back().nTime);
+}
+
+/**
+ * Done:
+ * nTime: End of the range
+ *
+ * Returns work units done from time 0 to this time
+ */
+unsigned long long CSpeed::Done(unsigned long long nTime) const
+{
+	unsigned long long nWork = 0;
+	if (m_nPeriod) {
+		nWork = nTime / m_nPeriod * m_nPeriodWork;
+		nTime %= m_nPeriod;
+	}
+	size_t nLow = 0, nHigh = m_cLevels.size();	/* last level starting at or before the time */
+	while (nHigh - nLow > 1) {
+		size_t nMiddle = (nLow + nHigh) / 2;
+		if (m_cLevels[nMiddle].nTime <= nTime)
+			nLow = nMiddle;
+		else
+			nHigh = nMiddle;
+	}
+	const CLevel& cLevel = m_cLevels[nLow];
+	return nWork + cLevel.nWork + (nTime - cLevel.nTime) * cLevel.nRate;
+}
+
+/**
+ * Need:
+ * nWork: Work units since time 0
+ *
+ * Returns the first time this work is done
+ */
+unsigned long long CSpeed::Need(unsigned long long nWork) const
+{
+	if (nWork == 0)
+		return 0;
+	unsigned long long nTime = 0;
+	if (m_nPeriod) {
+		unsigned long long nPeriods = (nWork - 1) / m_nPeriodWork;	/* whole periods before the last one */
+		nTime = nPeriods * m_nPeriod;
+		nWork -= nPeriods * m_nPeriodWork;
+	}
+	size_t nLow = 0, nHigh = m_cLevels.size();	/* last level starting before the work is done */
+	while (nHigh - nLow > 1) {
+		size_t nMiddle = (nLow + nHigh) / 2;
+		if (m_cLevels[nMiddle].nWork < nWork)
+			nLow = nMiddle;
+		else
+			nHigh = nMiddle;
+	}
+	const CLevel& cLevel = m_cLevels[nLow];
+	return nTime + cLevel.nTime + (nWork - cLevel.nWork + cLevel.nRate - 1) / cLevel.nRate;
+}
+
+/**
+ * Work:
+ * nFrom, nTo: Time range
+ *
+ * Returns work units done in [from, to)
+ */
+unsigned long long CSpeed::Work(unsigned long long nFrom, unsigned long long nTo) const
+{
+	return Done(nTo) - Done(nFrom);
+}
+
+/**
+ * Reach:
+ * nFrom: Time the work starts
+ * nWork: Work units to do
+ *
+ * Returns the first time the work is done, the last time unit may be partly idle
+ * ULLONG_MAX if it isn't done in the time range
+ */
+unsigned long long CSpeed::Reach(unsigned long long nFrom, unsigned long long nWork) const
+{
+	unsigned long long nTime = Need(Done(nFrom) + nWork);
+	return nTime <= TIME_MAX ? nTime : ULLONG_MAX;
+}
+
+/**
+ * Constructor
+ *
+ * Free context switches
+ */
+CSwitchCost::CSwitchCost()
+{
+	m_nSwitch = 0;
+	m_nRefill = 0;
+	m_dDecay = 0.0;
+}
+
+/**
+ * Parse:
+ * pCost: "switch[,refill[,decay]]", e.g. "0.05,0.2,10", times in time units at nominal speed
+ *
+ * Returns -1 if a value isn't a number, or is negative
+ */
+int CSwitchCost::Parse(const char* pCost)
+{
+	double dValue[3] = { 0.0, 0.0, 0.0 };
+	const char* pItem = pCost;
+	for (int nValue = 0; nValue < 3; ++ nValue) {
+		char* pEnd = NULL;
+		dValue[nValue] = strtod(pItem, &pEnd);
+		if (pEnd == pItem || dValue[nValue] < 0.0 || dValue[nValue] > UINT_MAX)
+			return -1;
+		if (*pEnd == '\0')
+			break;
+		if (*pEnd != ',' || nValue == 2)
+			return -1;
+		pItem = pEnd + 1;
+	}
+	m_nSwitch = (unsigned long long) (dValue[0] * SPEED_ONE + 0.5);
+	m_nRefill = (unsigned long long) (dValue[1] * SPEED_ONE + 0.5);
+	m_dDecay = dValue[2];
+	return 0;
+}
+
+/**
+ * Cost:
+ * nOff: Time the job was off the CPU, ULLONG_MAX if it never ran
+ *
+ * Returns work units of the switch, overhead and cache refill
+ */
+unsigned long long CSwitchCost::Cost(unsigned long long nOff) const
+{
+	double dCold = 1.0;
+	if (nOff != ULLONG_MAX && m_dDecay > 0.0)
+		dCold = 1.0 - exp(- (double) nOff / m_dDecay);
+	return m_nSwitch + (unsigned long long) (m_nRefill * dCold + 0.5);
+}
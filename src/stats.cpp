@@ -0,0 +1,230 @@
+/**
+ * Header files
+ */
+#include <limits.h>
+
+#include "support.h"
+#include "log.h"
+#include "stats.h"
+
+#ifdef HAVE_LINUX_PERF_EVENT_H
+#include <linux/perf_event.h>
+#endif
+#ifdef HAVE_SYS_SYSCALL_H
+#include <sys/syscall.h>
+#endif
+
+thread_local CStats g_cStats;
+CProgress g_cProgress;
+
+/**
+ * Names for the output
+ */
+static const char* g_pPhaseName[PHASE_MAX] = {
+	"read",
+	"execute",
+	"output",
+};
+static const char* g_pCounterName[STAT_MAX] = {
+	"pushes",
+	"pops",
+	"rotations",
+	"preemptions",
+	"ticks",
+	"events",
+	"windows",
+};
+static const char* g_pPerfName[PERF_MAX] = {
+	"cycles",
+	"cache_misses",
+};
+
+/**
+ * EnablePerf:
+ *
+ * Count user space cycles and cache misses of this thread
+ * Counters the kernel refuses (perf_event_paranoid, containers) stay unavailable
+ */
+void CStats::EnablePerf()
+{
+#if defined(HAVE_LINUX_PERF_EVENT_H) && defined(HAVE_SYS_SYSCALL_H) && defined(__NR_perf_event_open)
+	static const uint64_t nConfig[PERF_MAX] = { PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_CACHE_MISSES };
+	for (int nPerf = 0; nPerf < PERF_MAX; ++ nPerf) {
+		if (m_nPerf[nPerf] > 0)
+			continue;
+		struct perf_event_attr cAttr;
+		memset(&cAttr, 0, sizeof(cAttr));
+		cAttr.type = PERF_TYPE_HARDWARE;
+		cAttr.size = sizeof(cAttr);
+		cAttr.config = nConfig[nPerf];
+		cAttr.exclude_kernel = 1;
+		cAttr.exclude_hv = 1;
+		m_nPerf[nPerf] = syscall(__NR_perf_event_open, &cAttr, 0, -1, -1, 0) + 1;
+		if (m_nPerf[nPerf] <= 0)
+			debug_log("perf counter %s not available", g_pPerfName[nPerf]);
+	}
+	Sample(m_nSample);
+#endif
+}
+
+/**
+ * Sample:
+ * pSample: Monotonic clock in nanoseconds, then the hardware counters
+ */
+void CStats::Sample(uint64_t* pSample) const
+{
+	struct timespec cNow;
+	clock_gettime(CLOCK_MONOTONIC, &cNow);
+	pSample[0] = (uint64_t) cNow.tv_sec * 1000000000ULL + cNow.tv_nsec;
+	for (int nPerf = 0; nPerf < PERF_MAX; ++ nPerf) {
+		pSample[1 + nPerf] = 0;
+		if (m_nPerf[nPerf] > 0 &&
+			read(m_nPerf[nPerf] - 1, &pSample[1 + nPerf], sizeof(uint64_t)) != sizeof(uint64_t))
+			pSample[1 + nPerf] = 0;
+	}
+}
+
+/**
+ * Switch:
+ * nPhase: Phase the time goes to from now on, -1 for none
+ *
+ * Time and hardware counters since the last switch go to the current phase
+ */
+void CStats::Switch(int nPhase)
+{
+	uint64_t nSample[1 + PERF_MAX];
+	Sample(nSample);
+	if (m_nPhase >= 0) {
+		m_nPhaseTime[m_nPhase] += nSample[0] - m_nSample[0];
+		for (int nPerf = 0; nPerf < PERF_MAX; ++ nPerf)
+			m_nPhasePerf[m_nPhase][nPerf] += nSample[1 + nPerf] - m_nSample[1 + nPerf];
+	}
+	memcpy(m_nSample, nSample, sizeof(nSample));
+	m_nPhase = nPhase;
+}
+
+/**
+ * Dump:
+ * pFile: Output file
+ * bJson: One JSON object, instead of "name value" lines
+ */
+void CStats::Dump(FILE* pFile, bool bJson)
+{
+	Switch(m_nPhase);		/* account the current phase up to now */
+	if (bJson) {
+		fprintf(pFile, "{\"phases\":{");
+		for (int nPhase = 0; nPhase < PHASE_MAX; ++ nPhase) {
+			fprintf(pFile, "%s\"%s\":{\"seconds\":%.9f", nPhase ? "," : "", g_pPhaseName[nPhase], m_nPhaseTime[nPhase] / 1e9);
+			for (int nPerf = 0; nPerf < PERF_MAX; ++ nPerf) {
+				if (m_nPerf[nPerf] > 0)
+					fprintf(pFile, ",\"%s\":%llu", g_pPerfName[nPerf], (unsigned long long) m_nPhasePerf[nPhase][nPerf]);
+				else
+					fprintf(pFile, ",\"%s\":null", g_pPerfName[nPerf]);
+			}
+			fprintf(pFile, "}");
+		}
+		fprintf(pFile, "},\"counters\":{");
+		for (int nCounter = 0; nCounter < STAT_MAX; ++ nCounter)
+			fprintf(pFile, "%s\"%s\":%llu", nCounter ? "," : "", g_pCounterName[nCounter], (unsigned long long) m_nCounter[nCounter]);
+		fprintf(pFile, "}}\n");
+	}
+	else {
+		for (int nPhase = 0; nPhase < PHASE_MAX; ++ nPhase) {
+			fprintf(pFile, "%-12s %.9f s", g_pPhaseName[nPhase], m_nPhaseTime[nPhase] / 1e9);
+			for (int nPerf = 0; nPerf < PERF_MAX; ++ nPerf) {
+				if (m_nPerf[nPerf] > 0)
+					fprintf(pFile, " %s %llu", g_pPerfName[nPerf], (unsigned long long) m_nPhasePerf[nPhase][nPerf]);
+			}
+			fprintf(pFile, "\n");
+		}
+		for (int nCounter = 0; nCounter < STAT_MAX; ++ nCounter)
+			fprintf(pFile, "%-12s %llu\n", g_pCounterName[nCounter], (unsigned long long) m_nCounter[nCounter]);
+	}
+	fflush(pFile);
+}
+
+/**
+ * Signal:
+ * nSignal: SIGUSR1 for the progress, SIGINT or SIGTERM to stop
+ *
+ * Async signal safe, the atomics are lock free, and the note is a write(2)
+ */
+void CProgress::Signal(int nSignal)
+{
+	if (nSignal == SIGUSR1) {
+		if (!g_cProgress.m_bWatched.load()) {
+			static const char pNote[] = "Progress: not available, no simulation loop is watched\n";
+			ssize_t nWritten = write(STDERR_FILENO, pNote, sizeof(pNote) - 1);
+			(void) nWritten;	/* nowhere to say it otherwise */
+			return;
+		}
+		g_cProgress.m_nFlags.fetch_or(PROGRESS_REPORT);
+		return;
+	}
+	if (!g_cProgress.m_bWatched.load() || (g_cProgress.m_nFlags.load() & PROGRESS_STOP)) {
+		signal(nSignal, SIG_DFL);	/* nothing to flush, or asked twice */
+		raise(nSignal);
+		return;
+	}
+	g_cProgress.m_nSignal.store(nSignal);
+	g_cProgress.m_nFlags.fetch_or(PROGRESS_STOP);
+}
+
+/**
+ * Begin:
+ * nJobs: Jobs of the loop
+ * nEvents: Events of the thread so far
+ */
+void CProgress::Begin(unsigned long long nJobs, unsigned long long nEvents)
+{
+	struct timespec cNow;
+	clock_gettime(CLOCK_MONOTONIC, &cNow);
+	m_nStart = (uint64_t) cNow.tv_sec * 1000000000ULL + cNow.tv_nsec;
+	m_nJobs = nJobs;
+	m_nEvents = nEvents;
+	m_bWatched.store(true);
+}
+
+/**
+ * End:
+ *
+ * A stop request is kept, so the run knows its results are partial
+ */
+void CProgress::End()
+{
+	m_bWatched.store(false);
+}
+
+/**
+ * Poll:
+ * nTime: Simulated time
+ * nDone: Jobs terminated
+ * nEvents: Events of the thread so far, ULLONG_MAX if they aren't counted
+ *
+ * Write the progress to standard error if asked: simulated time, jobs done,
+ * events per second of wall time, and the time left if jobs keep terminating
+ * at the same rate
+ * Returns true if the loop has to stop
+ */
+bool CProgress::Poll(unsigned long long nTime, unsigned long long nDone, unsigned long long nEvents)
+{
+	int nFlags = m_nFlags.fetch_and(~PROGRESS_REPORT);
+	if (nFlags & PROGRESS_REPORT) {
+		struct timespec cNow;
+		clock_gettime(CLOCK_MONOTONIC, &cNow);
+		double dElapsed = ((uint64_t) cNow.tv_sec * 1000000000ULL + cNow.tv_nsec - m_nStart) / 1e9;
+		fprintf(stderr, "Progress: time %llu, %llu of %llu jobs done", nTime, nDone, m_nJobs);
+		if (nEvents != ULLONG_MAX)
+			fprintf(stderr, ", %llu events, %.0f events/s", nEvents - m_nEvents,
+				dElapsed > 0.0 ? (nEvents - m_nEvents) / dElapsed : 0.0);
+		if (nDone > 0)
+			fprintf(stderr, ", ETA %.1fs\n", dElapsed * (m_nJobs - nDone) / nDone);
+		else
+			fprintf(stderr, ", ETA unknown\n");
+	}
+	if (nFlags & PROGRESS_STOP) {
+		fprintf(stderr, "Stopped at time %llu, %llu of %llu jobs done\n", nTime, nDone, m_nJobs);
+		return true;
+	}
+	return false;
+}
@@ -0,0 +1,138 @@
+/**
+ * Header files
+ */
+#include <stdint.h>
+
+#include "support.h"
+#include "log.h"
+#include "queues.h"
+#include "executor.h"
+
+#define BLOCK_SIZE 65536		/* Bytes checksummed by one step of a job */
+
+/**
+ * CChecksum class
+ *
+ * Work of one job: checksum a block per step, nBlocks blocks in all
+ * Any callable doing one step and returning false once done can be registered
+ */
+class CChecksum
+{
+public:
+	/* Constructor/Destructor */
+	CChecksum(unsigned int nBlocks, uint64_t& nSum) : m_cBlock(BLOCK_SIZE), m_nBlocks(nBlocks), m_nSum(nSum)
+	{
+		for (size_t nByte = 0; nByte < m_cBlock.size(); ++ nByte)
+			m_cBlock[nByte] = (unsigned char) (nByte * 131 + nBlocks);
+		m_nSum = 14695981039346656037ULL;	/* FNV-1a offset basis */
+	}
+	~CChecksum() {};
+
+	/**
+	 * operator():
+	 * Returns true while there are blocks left
+	 */
+	bool operator()()
+	{
+		for (size_t nByte = 0; nByte < m_cBlock.size(); ++ nByte)
+			m_nSum = (m_nSum ^ m_cBlock[nByte]) * 1099511628211ULL;
+		return -- m_nBlocks > 0;
+	}
+
+private:
+	std::vector<unsigned char> m_cBlock;	/* Data of the job */
+	unsigned int m_nBlocks;			/* Blocks left */
+	uint64_t& m_nSum;			/* Checksum so far, read once the job is done */
+};
+
+/**
+ * Usage:
+ *
+ * Display program usage
+ */
+static void Usage()
+{
+	fprintf(stdout,
+		"Usage: schedtasks [-R quantum | -S] [-j workers] [-x us] < jobs\n"
+		"    Reads \"job,arrival,burst\" lines, then runs each job as a real task\n"
+		"    checksumming burst blocks of %d bytes, in the order of the policy\n"
+		"    (FCFS by default), arrivals in units of us microseconds (default 1000)\n",
+		BLOCK_SIZE);
+}
+
+/**
+ * main:
+ * argc: number of arguments from outside
+ * argv: actual list of arguments
+ *
+ * Smallest program using the scheduler library: the jobs are real work
+ * registered with CExecutor::Register, not a calibrated spin
+ */
+int main(int argc, char* argv[])
+{
+	debug_log("Entering %s ...", __FUNCTION__);	/* entrance trace for debugging */
+	int nRes = 0;
+	unsigned int nQuantum = 0;
+	unsigned int nWorkers = 1;
+	unsigned int nUnit = 1000;
+	bool bShortest = false;
+	int nOption;
+	while ((nOption = getopt(argc, argv, "R:Sj:x:")) != -1) {
+		switch (nOption) {
+		case 'R':
+			nQuantum = strtoul(optarg, NULL, 10);
+			break;
+		case 'S':
+			bShortest = true;
+			break;
+		case 'j':
+			nWorkers = strtoul(optarg, NULL, 10);
+			break;
+		case 'x':
+			nUnit = strtoul(optarg, NULL, 10);
+			break;
+		default:
+			Usage();
+			return 1;
+		}
+	}
+
+	CReadyQueue* pQueue = NULL;
+	try {
+		std::vector<CJob> cJobs;
+		unsigned int nJob = 0, nArrival = 0, nBurst = 0;
+		while (scanf(" %u,%u,%u", &nJob, &nArrival, &nBurst) == 3) {
+			if (nBurst == 0) {
+				err_printf("Job %u: burst should be at least 1", nJob);
+				return 1;
+			}
+			cJobs.push_back(CJob(FIFO, nJob, nArrival, nBurst));
+		}
+		if (bShortest)
+			pQueue = new CShortestQueue(cJobs);
+		else
+			pQueue = new CFifoQueue();
+
+		std::vector<uint64_t> cSums(cJobs.size(), 0);
+		CExecutor cExecutor(cJobs, *pQueue, bShortest ? 0 : nQuantum, nWorkers, nUnit);
+		for (size_t nIndex = 0; nIndex < cJobs.size(); ++ nIndex)
+			cExecutor.Register(nIndex, CChecksum(cJobs[nIndex].GetBurst(), cSums[nIndex]));
+		cExecutor.Run();
+
+		log_message("job turnaround checksum");
+		for (size_t nIndex = 0; nIndex < cJobs.size(); ++ nIndex)
+			log_message("%u %.2f %016llx", cJobs[nIndex].GetJob(), cExecutor.GetFinish(nIndex) - cJobs[nIndex].GetArrival(),
+				(unsigned long long) cSums[nIndex]);
+	}
+	catch (std::exception& e) {
+		perr_printf(e.what());
+		nRes = 1;
+	}
+	catch (...) {
+		err_printf("Unknown Exception...");
+		nRes = 1;
+	}
+	delete pQueue;
+	debug_log("Exiting %s with code %d (0x%x)...", __FUNCTION__, nRes, nRes);	/* exit trace for debugging */
+	return nRes;
+}
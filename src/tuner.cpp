@@ -0,0 +1,397 @@
+/**
+ * Header files
+ */
+#include <algorithm>
+#include <thread>
+#include <limits.h>
+#include <math.h>
+
+#include "support.h"
+#include "log.h"
+#include "tuner.h"
+#include "stats.h"
+
+/**
+ * Names of the objectives, for --tune
+ */
+static const char* g_pObjectiveName[TUNE_MAX] = {
+	"mean",
+	"p99",
+	"response",
+};
+
+#define TUNE_TAIL 0.99			/* Percentile of the p99 objective */
+
+/**
+ * Constructor
+ *
+ * cJobs: Jobs to schedule, each candidate runs on its own copy
+ * nObjective: Objective to minimize (see _tune_objectives)
+ * nWorkers: Candidates run at once, 0 for one per host CPU
+ */
+CQuantumTuner::CQuantumTuner(const std::vector<CJob>& cJobs, int nObjective, unsigned int nWorkers)
+	: m_cJobs(cJobs)
+{
+	m_nObjective = nObjective;
+	m_nWorkers = nWorkers ? nWorkers : std::max(1U, std::thread::hardware_concurrency());
+	m_pSpeed = NULL;
+	m_pCost = NULL;
+	m_nCheck = std::max(cJobs.size(), (size_t) TUNE_CHECK);
+	m_nNext = 0;
+	m_nBest = ULLONG_MAX;
+	m_nBestQuantum = ULLONG_MAX;
+	m_nAbandoned = 0;
+}
+
+/**
+ * Parse:
+ * pTune: "objective[:max]", e.g. "p99" or "mean:500"
+ * nObjective: Objective (see _tune_objectives)
+ * nMax: Largest quantum to try, 0 to find it from the jobs
+ *
+ * Returns -1 if the objective is unknown, or the largest quantum invalid
+ */
+int CQuantumTuner::Parse(const char* pTune, int& nObjective, unsigned long long& nMax)
+{
+	const char* pColon = strchr(pTune, ':');
+	size_t nLength = pColon ? (size_t) (pColon - pTune) : strlen(pTune);
+	nMax = 0;
+	if (pColon) {
+		char* pEnd = NULL;
+		unsigned long long nValue = strtoull(pColon + 1, &pEnd, 10);
+		if (pEnd == pColon + 1 || *pEnd != '\0' || nValue == 0 || nValue > TIME_MAX)
+			return -1;
+		nMax = nValue;
+	}
+	for (nObjective = 0; nObjective < TUNE_MAX; ++ nObjective) {
+		if (strlen(g_pObjectiveName[nObjective]) == nLength &&
+			strncmp(pTune, g_pObjectiveName[nObjective], nLength) == 0)
+			return 0;
+	}
+	return -1;
+}
+
+/**
+ * ObjectiveName:
+ * nObjective: Objective
+ *
+ * Returns name of the objective
+ */
+const char* CQuantumTuner::ObjectiveName(int nObjective)
+{
+	return nObjective >= 0 && nObjective < TUNE_MAX ? g_pObjectiveName[nObjective] : "unknown";
+}
+
+/**
+ * Limit:
+ *
+ * Every quantum from the CPU time of the longest job, its cold switch included,
+ * at the base speed of the CPU, runs each burst in one slice like this one
+ * Frequency levels below nominal may need a larger quantum, given with :max
+ */
+unsigned long long CQuantumTuner::Limit() const
+{
+	unsigned long long nWork = 0;
+	for (size_t nIndex = 0; nIndex < m_cJobs.size(); ++ nIndex)
+		nWork = std::max(nWork, (unsigned long long) m_cJobs[nIndex].GetBurst() * SPEED_ONE);
+	if (m_pCost)
+		nWork += m_pCost->Cost(ULLONG_MAX);
+	unsigned long long nSpeed = m_pSpeed ? m_pSpeed->GetBase() : SPEED_ONE;
+	unsigned long long nLimit = (nWork + nSpeed - 1) / nSpeed;
+	return std::max(1ULL, std::min(nLimit, TIME_MAX));
+}
+
+/**
+ * Tune:
+ * nMax: Largest quantum to try, 0 for Limit()
+ *
+ * Coarse to fine search, one line per candidate of each round
+ * A signal may ask for the progress, or stop the search after the candidates
+ * running, only those done count
+ * Returns the best quantum, the smallest one if several are as good,
+ * ULLONG_MAX if a signal stopped the search before any candidate was done
+ */
+unsigned long long CQuantumTuner::Tune(unsigned long long nMax)
+{
+	debug_log("Entering %s ...", __FUNCTION__);	/* trace log */
+	CProgressWatch cWatch(m_cJobs.size(), 0);
+	unsigned long long nHigh = nMax ? nMax : Limit();
+
+	/**
+	 * First round, a geometric grid, then between the neighbours of the best
+	 * quantum, which shrinks the range by about TUNE_POINTS / 2 each round
+	 */
+	std::vector<unsigned long long> cCandidates;
+	for (int nPoint = 0; nPoint < TUNE_POINTS; ++ nPoint) {
+		unsigned long long nQuantum = (unsigned long long) (pow((double) nHigh, nPoint / (TUNE_POINTS - 1.0)) + 0.5);
+		nQuantum = std::max(1ULL, std::min(nQuantum, nHigh));
+		if (cCandidates.empty() || cCandidates.back() < nQuantum)
+			cCandidates.push_back(nQuantum);
+	}
+	while (!cCandidates.empty()) {
+		Round(cCandidates);
+		for (size_t nIndex = 0; nIndex < cCandidates.size(); ++ nIndex) {
+			std::map<unsigned long long, unsigned long long>::const_iterator cResult = m_cResults.find(cCandidates[nIndex]);
+			if (cResult == m_cResults.end())
+				continue;		/* stopped before it was done */
+			unsigned long long nValue = cResult->second;
+			if (nValue == ULLONG_MAX)
+				log_message("quantum %llu abandoned", cCandidates[nIndex]);
+			else
+				log_message("quantum %llu %s %.2f", cCandidates[nIndex], ObjectiveName(m_nObjective), Value(nValue));
+		}
+		if (g_cProgress.Stopped())
+			break;
+
+		std::map<unsigned long long, unsigned long long>::const_iterator cBest = m_cResults.find(m_nBestQuantum);
+		unsigned long long nLow = 0, nTop = nHigh + 1;	/* exclusive range */
+		if (cBest != m_cResults.begin())
+			nLow = std::prev(cBest)->first;
+		if (std::next(cBest) != m_cResults.end())
+			nTop = std::next(cBest)->first;
+		cCandidates.clear();
+		unsigned long long nSpan = nTop - nLow;
+		for (unsigned int nPoint = 1; nPoint <= TUNE_POINTS && nPoint < nSpan; ++ nPoint) {
+			unsigned long long nQuantum = nSpan <= TUNE_POINTS + 1 ? nLow + nPoint :
+				nLow + nSpan * nPoint / (TUNE_POINTS + 1);
+			if (m_cResults.find(nQuantum) == m_cResults.end() &&
+				(cCandidates.empty() || cCandidates.back() < nQuantum))
+				cCandidates.push_back(nQuantum);
+		}
+	}
+	debug_log("Exiting %s with quantum %llu...", __FUNCTION__, m_nBestQuantum);	/* trace log */
+	return m_nBestQuantum;
+}
+
+/**
+ * Value:
+ * nValue: Total of the objective, as minimized
+ *
+ * Returns the objective, the means are totals over the jobs
+ */
+double CQuantumTuner::Value(unsigned long long nValue) const
+{
+	if (m_nObjective == TUNE_P99 || m_cJobs.empty())
+		return (double) nValue;
+	return (double) nValue / m_cJobs.size();
+}
+
+/**
+ * Round:
+ * cCandidates: Quanta to try
+ *
+ * Run the candidates on up to m_nWorkers threads, the calling thread included,
+ * largest quantum first: it has the fewest events, and its objective bounds
+ * the smaller ones sooner
+ * Returns once all are done, throws the first error of a candidate
+ */
+void CQuantumTuner::Round(const std::vector<unsigned long long>& cCandidates)
+{
+	m_cRound.assign(cCandidates.rbegin(), cCandidates.rend());
+	m_nNext = 0;
+	std::vector<std::thread> cThreads;
+	for (size_t nThread = 1; nThread < std::min((size_t) m_nWorkers, cCandidates.size()); ++ nThread)
+		cThreads.push_back(std::thread(&CQuantumTuner::Worker, this));
+	Worker();
+	for (size_t nThread = 0; nThread < cThreads.size(); ++ nThread)
+		cThreads[nThread].join();
+	if (m_pFailure)
+		std::rethrow_exception(m_pFailure);
+}
+
+/**
+ * Worker:
+ *
+ * Run the next candidate of the round until none is left, one failed,
+ * or a signal stopped the search
+ */
+void CQuantumTuner::Worker()
+{
+	while (true) {
+		unsigned long long nQuantum = 0;
+		{
+			std::lock_guard<std::mutex> cGuard(m_cLock);
+			if (m_nNext == m_cRound.size() || m_pFailure || g_cProgress.Stopped())
+				return;
+			nQuantum = m_cRound[m_nNext ++];
+		}
+		try {
+			unsigned long long nAbandon = ULLONG_MAX;
+			unsigned long long nValue = Evaluate(nQuantum, nAbandon);
+			std::lock_guard<std::mutex> cGuard(m_cLock);
+			if (g_cProgress.Stopped())
+				return;		/* cut short, neither run nor abandoned */
+			m_cResults[nQuantum] = nValue;
+			if (nAbandon != ULLONG_MAX)
+				++ m_nAbandoned;
+			else if (nValue < m_nBest || (nValue == m_nBest && nQuantum < m_nBestQuantum)) {
+				m_nBest = nValue;
+				m_nBestQuantum = nQuantum;
+			}
+		}
+		catch (...) {
+			std::lock_guard<std::mutex> cGuard(m_cLock);
+			if (!m_pFailure)
+				m_pFailure = std::current_exception();
+		}
+	}
+}
+
+/**
+ * Evaluate:
+ * nQuantum: Time quantum of the candidate
+ * nAbandon: Time the candidate was abandoned, unchanged if it ran to the end
+ *
+ * Run round robin on a copy of the jobs, checking the bound every m_nCheck events
+ * and the signals every event
+ * Returns the objective, ULLONG_MAX if the candidate was abandoned or stopped
+ */
+unsigned long long CQuantumTuner::Evaluate(unsigned long long nQuantum, unsigned long long& nAbandon)
+{
+	std::vector<CJob> cJobs(m_cJobs);
+	CFirstQueue cQueue(cJobs.size());
+	CEventLog cLog;				/* nobody listens to the candidates */
+	CEngine cEngine(cJobs, cQueue, nQuantum, cLog);
+	cEngine.SetSpeed(m_pSpeed);
+	cEngine.SetCost(m_pCost);
+	cEngine.AdmitAll();
+
+	std::vector<unsigned long long> cValues;
+	size_t nEvents = 0;
+	while (cEngine.Step()) {
+		if (g_cProgress.Pending()) {
+			if (g_cProgress.Stopped()) {
+				nAbandon = cEngine.GetTime();
+				return ULLONG_MAX;
+			}
+			if (g_cProgress.TakeReport())
+				Progress(nQuantum, cEngine.GetTime(), cEngine.GetTerminated());
+		}
+		if (++ nEvents < m_nCheck)
+			continue;
+		nEvents = 0;
+		if (!Beats(Bound(cJobs, cQueue, cEngine.GetTime(), cValues), nQuantum)) {
+			nAbandon = cEngine.GetTime();
+			return ULLONG_MAX;
+		}
+	}
+	return Bound(cJobs, cQueue, cEngine.GetTime(), cValues);
+}
+
+/**
+ * Progress:
+ * nQuantum: Time quantum of the candidate which serves the request
+ * nTime: Its simulated time
+ * nDone: Its jobs terminated
+ *
+ * Write the progress of the search to standard error
+ */
+void CQuantumTuner::Progress(unsigned long long nQuantum, unsigned long long nTime, size_t nDone)
+{
+	std::lock_guard<std::mutex> cGuard(m_cLock);
+	fprintf(stderr, "Progress: quantum %llu at time %llu, %zu of %zu jobs done, %zu of %zu candidates of the round started, ",
+		nQuantum, nTime, nDone, m_cJobs.size(), m_nNext, m_cRound.size());
+	if (m_nBestQuantum == ULLONG_MAX)
+		fprintf(stderr, "no best quantum yet\n");
+	else
+		fprintf(stderr, "best quantum %llu, %s %.2f\n", m_nBestQuantum, ObjectiveName(m_nObjective), Value(m_nBest));
+}
+
+/**
+ * Bound:
+ * cJobs: Jobs of the candidate
+ * cQueue: Ready queue of the candidate
+ * nTime: Simulated time
+ * cValues: Bound of each job, reused between calls
+ *
+ * A terminated job has its turnaround, an other one has waited since its
+ * arrival, and one never dispatched needs its whole span on a nominal CPU.
+ * The response of a job dispatched is known, an other one has waited.
+ * Every job's objective only grows, so do their total and their percentile.
+ * Returns a lower bound of the objective, exact once every job is done
+ */
+unsigned long long CQuantumTuner::Bound(const std::vector<CJob>& cJobs, const CFirstQueue& cQueue, unsigned long long nTime, std::vector<unsigned long long>& cValues) const
+{
+	cValues.resize(cJobs.size());
+	for (size_t nIndex = 0; nIndex < cJobs.size(); ++ nIndex) {
+		const CJob& cJob = cJobs[nIndex];
+		unsigned long long nArrival = cJob.GetArrival();
+		unsigned long long nFirst = cQueue.GetFirst(nIndex);
+		unsigned long long nWaited = nTime > nArrival ? nTime - nArrival : 0;
+		if (m_nObjective == TUNE_RESPONSE)
+			cValues[nIndex] = nFirst != ULLONG_MAX ? nFirst - nArrival : nWaited;
+		else if (cJob.GetRemaining() == 0 && cJob.IsLastBurst())	/* terminated, or terminates now */
+			cValues[nIndex] = cJob.GetTime() >= nArrival ? cJob.GetTime() - nArrival : nWaited;
+		else
+			cValues[nIndex] = nWaited + (nFirst == ULLONG_MAX && m_pSpeed == NULL ? cJob.GetSpan() : 0);
+	}
+	if (cValues.empty())
+		return 0;
+	if (m_nObjective == TUNE_P99) {
+		size_t nRank = std::max((size_t) 1, (size_t) (TUNE_TAIL * cValues.size() + 0.999999));
+		std::nth_element(cValues.begin(), cValues.begin() + (nRank - 1), cValues.end());
+		return cValues[nRank - 1];
+	}
+	unsigned long long nTotal = 0;
+	for (size_t nIndex = 0; nIndex < cValues.size(); ++ nIndex)
+		nTotal += cValues[nIndex];
+	return nTotal;
+}
+
+/**
+ * Beats:
+ * nValue: Lower bound of the candidate's objective
+ * nQuantum: Time quantum of the candidate
+ *
+ * Returns false if the candidate can't be better than the best one, nor as
+ * good with a smaller quantum
+ */
+bool CQuantumTuner::Beats(unsigned long long nValue, unsigned long long nQuantum)
+{
+	std::lock_guard<std::mutex> cGuard(m_cLock);
+	return nValue < m_nBest || (nValue == m_nBest && nQuantum < m_nBestQuantum);
+}
+
+/**
+ * ExecuteTune:
+ *
+ * Find the round robin time quantum which minimizes the objective,
+ * then run round robin with it
+ */
+int CSchedular::ExecuteTune()
+{
+	debug_log("Entering %s ...", __FUNCTION__);	/* trace log */
+	int nRes = 0;
+	try {
+		log_message("sched -R --tune %s for %s", m_pTune, m_pFileName ? m_pFileName : "random jobs");	/* print the command to console */
+		CQuantumTuner cTuner(m_cList, m_nTuneObjective, m_nWorkers);
+		cTuner.SetSpeed(GetSpeed(0));
+		cTuner.SetCost(GetSwitch());
+		unsigned long long nQuantum = cTuner.Tune(m_nTuneMax);
+		if (g_cProgress.Stopped()) {
+			/**
+			 * No run with the best quantum, the search is partial
+			 */
+			if (nQuantum == ULLONG_MAX)
+				log_message("Stopped, no candidate done");
+			else
+				log_message("Stopped, best quantum so far %llu, %zu candidates run, %zu abandoned", nQuantum, cTuner.GetRuns(), cTuner.GetAbandoned());
+			nRes = -1;
+		}
+		else {
+			log_message("Best quantum %llu, %zu candidates run, %zu abandoned", nQuantum, cTuner.GetRuns(), cTuner.GetAbandoned());
+			SetTimeQuantum(nQuantum);
+			nRes = ExecuteEvents();		/* the outputs of the best quantum */
+		}
+	}
+	catch (std::exception& e) {
+		perr_printf(e.what());
+		nRes = -1;
+	}
+	catch (...) {
+		err_printf("Unknown Exception...");
+		nRes = -1;
+	}
+	debug_log("Exiting %s with code %d (0x%x)...", __FUNCTION__, nRes, nRes);	/* trace log */
+	return nRes;
+}